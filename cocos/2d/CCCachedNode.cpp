@@ -0,0 +1,242 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCCachedNode.h"
+
+#include <cmath>
+
+#include "2d/CCRenderTexture.h"
+#include "2d/CCSprite.h"
+#include "renderer/CCRenderer.h"
+
+NS_CC_BEGIN
+
+CachedNode* CachedNode::create(const CSize& size, float renderScale)
+{
+    CachedNode* ret = new (std::nothrow) CachedNode();
+
+    if (ret && ret->initWithSize(size, renderScale))
+    {
+        ret->autorelease();
+    }
+    else
+    {
+        CC_SAFE_DELETE(ret);
+    }
+
+    return ret;
+}
+
+CachedNode::CachedNode()
+: _renderTexture(nullptr)
+, _renderScale(1.0f)
+, _cacheEnabled(true)
+, _cacheDirty(true)
+, _renderTextureDirty(true)
+{
+    _cachesSubtree = true;
+    s_cachingNodeCount++;
+}
+
+CachedNode::~CachedNode()
+{
+    if (_cachesSubtree)
+    {
+        s_cachingNodeCount--;
+    }
+
+    CC_SAFE_RELEASE(_renderTexture);
+}
+
+bool CachedNode::initWithSize(const CSize& size, float renderScale)
+{
+    if (!Node::init())
+    {
+        return false;
+    }
+
+    _renderScale = std::max(renderScale, 0.0f);
+    setContentSize(size);
+
+    return true;
+}
+
+void CachedNode::invalidate()
+{
+    _cacheDirty = true;
+}
+
+void CachedNode::onCachedSubtreeDirty()
+{
+    _cacheDirty = true;
+}
+
+void CachedNode::setRenderScale(float renderScale)
+{
+    renderScale = std::max(renderScale, 0.0f);
+
+    if (_renderScale != renderScale)
+    {
+        _renderScale = renderScale;
+        _renderTextureDirty = true;
+        _cacheDirty = true;
+    }
+}
+
+void CachedNode::setCacheEnabled(bool cacheEnabled)
+{
+    if (_cacheEnabled == cacheEnabled)
+    {
+        return;
+    }
+
+    _cacheEnabled = cacheEnabled;
+    _cachesSubtree = cacheEnabled;
+
+    if (cacheEnabled)
+    {
+        s_cachingNodeCount++;
+        _cacheDirty = true;
+    }
+    else
+    {
+        s_cachingNodeCount--;
+
+        // The texture is rebuilt on demand if the cache is enabled again
+        CC_SAFE_RELEASE_NULL(_renderTexture);
+        _renderTextureDirty = true;
+    }
+}
+
+void CachedNode::setContentSize(const CSize& contentSize)
+{
+    if (!contentSize.equals(_contentSize))
+    {
+        _renderTextureDirty = true;
+        _cacheDirty = true;
+    }
+
+    Node::setContentSize(contentSize);
+}
+
+void CachedNode::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (!_cacheEnabled)
+    {
+        Node::visit(renderer, parentTransform, parentFlags);
+        return;
+    }
+
+    _selfFlags |= parentFlags;
+
+    if (!_visible || (_displayedOpacity == 0 && _cascadeOpacityEnabled))
+    {
+        return;
+    }
+
+    if (_selfFlags & FLAGS_DIRTY_MASK)
+    {
+        _modelViewTransform = parentTransform * getNodeToParentTransform();
+    }
+
+    if (_renderTextureDirty)
+    {
+        updateRenderTexture();
+    }
+
+    if (_renderTexture == nullptr)
+    {
+        _selfFlags = 0;
+        return;
+    }
+
+    if (_cacheDirty)
+    {
+        renderChildren(renderer);
+    }
+
+    _renderTexture->getSprite()->visit(renderer, _modelViewTransform, _selfFlags);
+
+    _selfFlags = 0;
+}
+
+void CachedNode::updateRenderTexture()
+{
+    _renderTextureDirty = false;
+    _cacheDirty = true;
+
+    int width = (int)std::ceil(_contentSize.width * _renderScale);
+    int height = (int)std::ceil(_contentSize.height * _renderScale);
+
+    CC_SAFE_RELEASE_NULL(_renderTexture);
+
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // A stencil buffer keeps ClippingNodes working inside of the cached subtree
+    _renderTexture = RenderTexture::create(width, height, Texture2D::PixelFormat::RGBA8888, GL_DEPTH24_STENCIL8);
+
+    if (_renderTexture == nullptr)
+    {
+        CCLOG("CachedNode: failed to create a %dx%d render texture", width, height);
+        return;
+    }
+
+    _renderTexture->retain();
+
+    // Draw the texture over [0, contentSize] of this node, whatever the render scale
+    Sprite* sprite = _renderTexture->getSprite();
+    sprite->setAnchorPoint(Vec2::ZERO);
+    sprite->setPosition(Vec2::ZERO);
+    sprite->setScale(_renderScale > 0.0f ? 1.0f / _renderScale : 1.0f);
+}
+
+void CachedNode::renderChildren(Renderer* renderer)
+{
+    // Cleared first, so that changes made while rendering (such as labels waiting for glyphs) cause another render next frame
+    _cacheDirty = false;
+
+    Mat4 transform;
+    Mat4::createScale(_renderScale, _renderScale, 1.0f, &transform);
+
+    // The children are visited in the local space of this node rather than in screen space, so screen culling does not apply
+    renderer->pushOffscreenVisit();
+    _renderTexture->beginWithClear(0.0f, 0.0f, 0.0f, 0.0f);
+
+    this->draw(renderer, transform, FLAGS_DIRTY_MASK);
+
+    sortAllChildren();
+
+    for (const auto& child : _children)
+    {
+        child->visit(renderer, transform, FLAGS_DIRTY_MASK);
+    }
+
+    _renderTexture->end();
+    renderer->popOffscreenVisit();
+}
+
+NS_CC_END
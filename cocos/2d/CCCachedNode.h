@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCCACHED_NODE_H__
+#define __CCCACHED_NODE_H__
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+class RenderTexture;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ * @brief CachedNode renders its children into an offscreen texture, and then draws that texture as a single quad
+ * until something below it changes. This suits panels with many sprites and labels that rarely change.
+ *
+ * The children are rendered again after a change to the transform, content size, color, opacity, visibility, order, children
+ * or shader of any node below, or to the content of a Sprite, Label, DrawNode or TMX layer. Anything that animates on its own
+ * (such as a particle system) or changes shader uniforms directly on a GLProgramState must call invalidate() whenever it should
+ * be redrawn, or be kept outside of the cached subtree.
+ *
+ * The children are rendered in the local space of this node, and anything outside of [0, contentSize] is clipped.
+ */
+class CC_DLL CachedNode : public Node
+{
+public:
+    /** Creates a cached node.
+     *
+     * @param size The content size, which is the area of the children that is cached.
+     * @param renderScale The resolution of the cache relative to the content size.
+     * @return An autoreleased CachedNode object.
+     */
+    static CachedNode* create(const CSize& size, float renderScale = 1.0f);
+
+    /** Forces the children to be rendered again on the next visit. */
+    void invalidate();
+
+    /** Checks whether the children will be rendered again on the next visit. */
+    bool isCacheDirty() const { return _cacheDirty; }
+
+    /** Sets the resolution of the cache relative to the content size.
+     * Values below 1 save memory for blurry or distant content, values above 1 keep the content sharp when this node is scaled up.
+     */
+    void setRenderScale(float renderScale);
+
+    /** Gets the resolution of the cache relative to the content size. */
+    float getRenderScale() const { return _renderScale; }
+
+    /** Enables or disables the cache. While disabled the children are visited directly, like the children of a plain Node. */
+    void setCacheEnabled(bool cacheEnabled);
+
+    /** Checks whether the cache is enabled. */
+    bool isCacheEnabled() const { return _cacheEnabled; }
+
+    // Overrides
+    virtual void setContentSize(const CSize& contentSize) override;
+    virtual void visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) override;
+
+public:
+    CachedNode();
+    virtual ~CachedNode();
+
+    bool initWithSize(const CSize& size, float renderScale);
+
+protected:
+    virtual void onCachedSubtreeDirty() override;
+
+    void updateRenderTexture();
+    void renderChildren(Renderer* renderer);
+
+    RenderTexture* _renderTexture;
+    float _renderScale;
+    bool _cacheEnabled;
+    bool _cacheDirty;
+    bool _renderTextureDirty;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(CachedNode);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCCACHED_NODE_H__
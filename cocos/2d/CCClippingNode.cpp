@@ -27,6 +27,8 @@
  */
 
 #include "2d/CCClippingNode.h"
+#include "2d/CCDrawNode.h"
+#include "2d/CCLayer.h"
 #include "base/CCConsole.h"
 #include "base/CCDirector.h"
 #include "base/CCStencilStateManager.h"
@@ -154,15 +156,27 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
 
     this->setContentSize(_stencil == nullptr ? CSize::ZERO : _stencil->getContentSize());
 
-    _beforeVisitCmd.init(0.0f);
-    _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
-    renderer->addCommand(&_beforeVisitCmd);
-    
-    _stencil->visit(renderer, _modelViewTransform, _selfFlags);
+    // Rectangular stencils are applied with a scissor rect, which avoids clearing and writing the stencil buffer
+    bool useScissor = this->getScissorRect(_scissorRect);
+
+    if (useScissor)
+    {
+        _beforeVisitCmd.init(0.0f);
+        _beforeVisitCmd.func = CC_CALLBACK_0(ClippingNode::onBeforeVisitScissor, this);
+        renderer->addCommand(&_beforeVisitCmd);
+    }
+    else
+    {
+        _beforeVisitCmd.init(0.0f);
+        _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
+        renderer->addCommand(&_beforeVisitCmd);
+
+        _stencil->visit(renderer, _modelViewTransform, _selfFlags);
 
-    _afterDrawStencilCmd.init(0.0f);
-    _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
-    renderer->addCommand(&_afterDrawStencilCmd);
+        _afterDrawStencilCmd.init(0.0f);
+        _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
+        renderer->addCommand(&_afterDrawStencilCmd);
+    }
     
     // self draw
     this->draw(renderer, _modelViewTransform, _selfFlags);
@@ -177,12 +191,111 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     }
 
     _afterVisitCmd.init(0.0f);
-    _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+
+    if (useScissor)
+    {
+        _afterVisitCmd.func = CC_CALLBACK_0(ClippingNode::onAfterVisitScissor, this);
+    }
+    else
+    {
+        _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    }
+
     renderer->addCommand(&_afterVisitCmd);
 
     _selfFlags = 0;
 }
 
+bool ClippingNode::getScissorRect(CRect& rect) const
+{
+    if (_stencil == nullptr || !_stencil->isVisible() || !_stencil->getChildren().empty()
+        || _stencilStateManager->isInverted() || _stencilStateManager->getAlphaThreshold() < 1.0f)
+    {
+        return false;
+    }
+
+    CRect localRect;
+    DrawNode* drawNode = dynamic_cast<DrawNode*>(_stencil);
+
+    if (drawNode != nullptr)
+    {
+        if (!drawNode->getSolidRect(localRect))
+        {
+            return false;
+        }
+    }
+    else if (dynamic_cast<LayerColor*>(_stencil) != nullptr)
+    {
+        localRect = CRect(Vec2::ZERO, _stencil->getContentSize());
+    }
+    else
+    {
+        return false;
+    }
+
+    Mat4 transform = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION) * _modelViewTransform * _stencil->getNodeToParentTransform();
+    Vec2 corners[4] =
+    {
+        Vec2(localRect.getMinX(), localRect.getMinY()),
+        Vec2(localRect.getMaxX(), localRect.getMinY()),
+        Vec2(localRect.getMaxX(), localRect.getMaxY()),
+        Vec2(localRect.getMinX(), localRect.getMaxY()),
+    };
+    Vec2 projected[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        Vec4 clip;
+        transform.transformVector(Vec4(corners[i].x, corners[i].y, 0.0f, 1.0f), &clip);
+
+        if (clip.w <= 0.0f)
+        {
+            return false;
+        }
+
+        projected[i] = Vec2(clip.x / clip.w, clip.y / clip.w);
+    }
+
+    // The edges must stay parallel to the screen axes, which rules out rotation, skew and perspective
+    const float epsilon = 0.0001f;
+    bool horizontalFirst = std::abs(projected[0].y - projected[1].y) <= epsilon && std::abs(projected[2].y - projected[3].y) <= epsilon
+        && std::abs(projected[1].x - projected[2].x) <= epsilon && std::abs(projected[3].x - projected[0].x) <= epsilon;
+    bool verticalFirst = std::abs(projected[0].x - projected[1].x) <= epsilon && std::abs(projected[2].x - projected[3].x) <= epsilon
+        && std::abs(projected[1].y - projected[2].y) <= epsilon && std::abs(projected[3].y - projected[0].y) <= epsilon;
+
+    if (!horizontalFirst && !verticalFirst)
+    {
+        return false;
+    }
+
+    float minX = std::min(projected[0].x, projected[2].x);
+    float maxX = std::max(projected[0].x, projected[2].x);
+    float minY = std::min(projected[0].y, projected[2].y);
+    float maxY = std::max(projected[0].y, projected[2].y);
+
+    rect = CRect(minX, minY, maxX - minX, maxY - minY);
+    return true;
+}
+
+void ClippingNode::onBeforeVisitScissor()
+{
+    // The viewport is read at render time, so that clipping inside a RenderTexture maps onto its target
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    float x = viewport[0] + (_scissorRect.getMinX() + 1.0f) * 0.5f * viewport[2];
+    float y = viewport[1] + (_scissorRect.getMinY() + 1.0f) * 0.5f * viewport[3];
+    float width = _scissorRect.size.width * 0.5f * viewport[2];
+    float height = _scissorRect.size.height * 0.5f * viewport[3];
+
+    Director::getInstance()->getRenderer()->pushScissorRect(CRect(x, y, width, height));
+}
+
+void ClippingNode::onAfterVisitScissor()
+{
+    Director::getInstance()->getRenderer()->popScissorRect();
+}
+
 Node* ClippingNode::getStencil() const
 {
     return _stencil;
@@ -216,6 +329,8 @@ void ClippingNode::setStencil(Node *stencil)
     
     if (_stencil != nullptr)
         _originStencilProgram = _stencil->getGLProgram();
+
+    this->setContentSize(_stencil == nullptr ? CSize::ZERO : _stencil->getContentSize());
 }
 
 bool ClippingNode::hasContent() const
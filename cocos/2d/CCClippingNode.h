@@ -153,6 +153,17 @@ public:
     virtual bool init(Node *stencil);
 
 protected:
+    /** Checks whether the stencil is a solid rectangle that stays axis aligned on screen, in which case it can be applied
+     * with glScissor instead of the stencil buffer.
+     *
+     * @param rect Receives the clipped area in normalized device coordinates.
+     * @return True if the scissor test can replace the stencil test.
+     */
+    bool getScissorRect(CRect& rect) const;
+
+    void onBeforeVisitScissor();
+    void onAfterVisitScissor();
+
     Node* _stencil;
     GLProgram* _originStencilProgram;
    
@@ -162,6 +173,8 @@ protected:
     CustomCommand _afterDrawStencilCmd;
     CustomCommand _afterVisitCmd;
 
+    CRect _scissorRect;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ClippingNode);
 };
@@ -23,6 +23,9 @@
  */
 
 #include "2d/CCDrawNode.h"
+
+#include <unordered_map>
+
 #include "base/CCConsole.h"
 #include "base/CCEventType.h"
 #include "base/CCConfiguration.h"
@@ -98,6 +101,90 @@ static inline Tex2F __t(const Vec2 &v)
     return *(Tex2F*)&v;
 }
 
+// Matches what ccShader_PositionColorLengthTexture.vert does with u_alpha, for the batched path where the shader cannot
+static inline V3F_C4B_T2F toBatchVertex(const Vec2 &position, const Color4B &color, const Tex2F &texCoords, float opacity)
+{
+    float alpha = color.a * opacity;
+    float premultiply = alpha / 255.0f;
+    Color4B premultiplied = Color4B(
+        (GLubyte)(color.r * premultiply + 0.5f),
+        (GLubyte)(color.g * premultiply + 0.5f),
+        (GLubyte)(color.b * premultiply + 0.5f),
+        (GLubyte)(alpha + 0.5f));
+
+    V3F_C4B_T2F vertex = { Vec3(position.x, position.y, 0.0f), premultiplied, texCoords };
+    return vertex;
+}
+
+// Unit circle tessellations keyed by segment count. Circles, ellipses and rounded corners map these through an affine transform instead of calling trig per segment.
+struct UnitCircle
+{
+    std::vector<Vec2> points;   // segments + 1 points, the last one closing the loop at angle 2 * PI
+    std::vector<Vec2> fan;      // triangle list filling the circle, fanned from the first point
+};
+
+static std::unordered_map<unsigned int, UnitCircle> s_unitCircles;
+
+static const UnitCircle& getUnitCircle(unsigned int segments)
+{
+    auto it = s_unitCircles.find(segments);
+
+    if (it != s_unitCircles.end())
+    {
+        return it->second;
+    }
+
+    UnitCircle& circle = s_unitCircles[segments];
+    const float coef = 2.0f * (float)M_PI / segments;
+
+    circle.points.resize(segments + 1);
+
+    for (unsigned int i = 0; i <= segments; i++)
+    {
+        circle.points[i] = Vec2(cosf(i * coef), sinf(i * coef));
+    }
+
+    for (unsigned int i = 0; i + 2 < segments; i++)
+    {
+        circle.fan.push_back(circle.points[0]);
+        circle.fan.push_back(circle.points[i + 1]);
+        circle.fan.push_back(circle.points[i + 2]);
+    }
+
+    return circle;
+}
+
+static inline Vec2 applyTransform(const AffineTransform& t, const Vec2& point)
+{
+    return Vec2(t.a * point.x + t.c * point.y + t.tx, t.b * point.x + t.d * point.y + t.ty);
+}
+
+// Scratch outline reused by the rounded rectangles
+static std::vector<Vec2> s_roundedRectPoints;
+
+// The renderer indexes commands with unsigned shorts, so larger nodes are split into several whole triangle commands
+static const int BATCH_VERTICES_PER_COMMAND = (Renderer::VBO_SIZE - 1) / 3 * 3;
+
+// Every TrianglesCommand of a DrawNode indexes its own vertices in order, so they all share one index list.
+// It is filled once at its full size, since queued commands keep pointing at it until the renderer flushes them.
+static const unsigned short* getSequentialIndices()
+{
+    static unsigned short indices[BATCH_VERTICES_PER_COMMAND];
+    static bool filled = false;
+
+    if (!filled)
+    {
+        for (int i = 0; i < BATCH_VERTICES_PER_COMMAND; i++)
+        {
+            indices[i] = (unsigned short)i;
+        }
+
+        filled = true;
+    }
+
+    return indices;
+}
+
 // implementation of DrawNode
 
 DrawNode::DrawNode(GLfloat lineWidth)
@@ -116,9 +203,16 @@ DrawNode::DrawNode(GLfloat lineWidth)
 , _bufferCapacityGLLine(0)
 , _bufferCountGLLine(0)
 , _bufferGLLine(nullptr)
+, _batchBuffer(nullptr)
+, _batchCapacity(0)
+, _batchCount(0)
+, _batchOpacity(0)
+, _batchLineWidth(0.0f)
+, _batchGLProgramState(nullptr)
 , _dirty(false)
 , _dirtyGLPoint(false)
 , _dirtyGLLine(false)
+, _dirtyBatch(false)
 , _lineWidth(lineWidth)
 , _defaultLineWidth(lineWidth)
 , _lowestPoint(Vec2::ZERO)
@@ -135,6 +229,9 @@ DrawNode::~DrawNode()
     _bufferGLPoint = nullptr;
     free(_bufferGLLine);
     _bufferGLLine = nullptr;
+    free(_batchBuffer);
+    _batchBuffer = nullptr;
+    CC_SAFE_RELEASE_NULL(_batchGLProgramState);
     
     glDeleteBuffers(1, &_vbo);
     glDeleteBuffers(1, &_vboGLLine);
@@ -206,6 +303,11 @@ bool DrawNode::init()
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 
     setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR));
+
+    // Shared by every DrawNode so that their commands get the same material id
+    CC_SAFE_RELEASE(_batchGLProgramState);
+    _batchGLProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP);
+    CC_SAFE_RETAIN(_batchGLProgramState);
     
     ensureCapacity(512);
     ensureCapacityGLPoint(64);
@@ -284,12 +386,123 @@ bool DrawNode::init()
     _dirty = true;
     _dirtyGLLine = true;
     _dirtyGLPoint = true;
+    _dirtyBatch = true;
     
     return true;
 }
 
+bool DrawNode::isBatchable() const
+{
+    return _batchGLProgramState != nullptr
+        && getGLProgram() == GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
+}
+
+void DrawNode::updateBatchBuffer()
+{
+    if (!_dirtyBatch && _batchOpacity == _displayedOpacity && _batchLineWidth == _lineWidth)
+    {
+        return;
+    }
+
+    // Triangles first, then points, then lines, in the order the CustomCommands draw them
+    const int lineCount = _bufferCountGLLine / 2;
+    const int count = _bufferCount + (_bufferCountGLPoint + lineCount) * 6;
+
+    if (count > _batchCapacity)
+    {
+        V3F_C4B_T2F* batchBuffer = (V3F_C4B_T2F*)realloc((void*)_batchBuffer, count * sizeof(V3F_C4B_T2F));
+
+        if (batchBuffer == nullptr)
+        {
+            CCLOG("cocos2d: DrawNode: not enough memory to batch %d vertices", count);
+            _batchCount = 0;
+            return;
+        }
+
+        _batchBuffer = batchBuffer;
+        _batchCapacity = count;
+    }
+
+    const float opacity = _displayedOpacity / 255.0f;
+    V3F_C4B_T2F* cursor = _batchBuffer;
+
+    for (int i = 0; i < _bufferCount; i++)
+    {
+        *cursor++ = toBatchVertex(_buffer[i].vertices, _buffer[i].colors, _buffer[i].texCoords, opacity);
+    }
+
+    // GL points are squares, the point size is kept in the u texture coordinate
+    for (int i = 0; i < _bufferCountGLPoint; i++)
+    {
+        const V2F_C4B_T2F& point = _bufferGLPoint[i];
+        const float half = point.texCoords.u / 2.0f;
+        const Tex2F center = Tex2F(0.0f, 0.0f);
+
+        V3F_C4B_T2F bl = toBatchVertex(Vec2(point.vertices.x - half, point.vertices.y - half), point.colors, center, opacity);
+        V3F_C4B_T2F br = toBatchVertex(Vec2(point.vertices.x + half, point.vertices.y - half), point.colors, center, opacity);
+        V3F_C4B_T2F tl = toBatchVertex(Vec2(point.vertices.x - half, point.vertices.y + half), point.colors, center, opacity);
+        V3F_C4B_T2F tr = toBatchVertex(Vec2(point.vertices.x + half, point.vertices.y + half), point.colors, center, opacity);
+
+        *cursor++ = bl; *cursor++ = br; *cursor++ = tr;
+        *cursor++ = bl; *cursor++ = tr; *cursor++ = tl;
+    }
+
+    // GL lines become quads that are _lineWidth wide
+    const float halfWidth = _lineWidth / 2.0f;
+
+    for (int i = 0; i < lineCount; i++)
+    {
+        const V2F_C4B_T2F& from = _bufferGLLine[i * 2];
+        const V2F_C4B_T2F& to = _bufferGLLine[i * 2 + 1];
+        const Tex2F center = Tex2F(0.0f, 0.0f);
+
+        Vec2 direction = to.vertices - from.vertices;
+        float length = direction.length();
+        Vec2 n = length > 0.0f ? Vec2(-direction.y, direction.x) * (halfWidth / length) : Vec2::ZERO;
+
+        V3F_C4B_T2F a = toBatchVertex(from.vertices - n, from.colors, center, opacity);
+        V3F_C4B_T2F b = toBatchVertex(from.vertices + n, from.colors, center, opacity);
+        V3F_C4B_T2F c = toBatchVertex(to.vertices + n, to.colors, center, opacity);
+        V3F_C4B_T2F d = toBatchVertex(to.vertices - n, to.colors, center, opacity);
+
+        *cursor++ = a; *cursor++ = b; *cursor++ = c;
+        *cursor++ = a; *cursor++ = c; *cursor++ = d;
+    }
+
+    _batchCount = count;
+    _batchOpacity = _displayedOpacity;
+    _batchLineWidth = _lineWidth;
+    _dirtyBatch = false;
+}
+
 void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
+    if (isBatchable())
+    {
+        updateBatchBuffer();
+
+        int commandCount = (_batchCount + BATCH_VERTICES_PER_COMMAND - 1) / BATCH_VERTICES_PER_COMMAND;
+
+        if (commandCount > (int)_trianglesCommands.size())
+        {
+            _trianglesCommands.resize(commandCount);
+        }
+
+        const unsigned short* indices = getSequentialIndices();
+
+        for (int i = 0; i < commandCount; i++)
+        {
+            int first = i * BATCH_VERTICES_PER_COMMAND;
+            int vertexCount = std::min(BATCH_VERTICES_PER_COMMAND, _batchCount - first);
+            TrianglesCommand::Triangles triangles = { _batchBuffer + first, const_cast<unsigned short*>(indices), vertexCount, vertexCount };
+
+            _trianglesCommands[i].init(0.0f, (GLuint)0, _batchGLProgramState, _blendFunc, triangles, transform, flags);
+            renderer->addCommand(&_trianglesCommands[i]);
+        }
+
+        return;
+    }
+
     if(_bufferCount)
     {
         _customCommand.init(0.0f, transform, flags);
@@ -324,7 +537,7 @@ void DrawNode::onDraw(const Mat4 &transform, uint32_t /*flags*/)
     if (_dirty)
     {
         glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCount, _buffer, GL_STREAM_DRAW);
         
         _dirty = false;
     }
@@ -369,7 +582,7 @@ void DrawNode::onDrawGLLine(const Mat4 &transform, uint32_t /*flags*/)
     if (_dirtyGLLine)
     {
         glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCountGLLine, _bufferGLLine, GL_STREAM_DRAW);
         _dirtyGLLine = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -414,7 +627,7 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t /*flags*/)
     if (_dirtyGLPoint)
     {
         glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCountGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
         
         _dirtyGLPoint = false;
     }
@@ -457,6 +670,8 @@ void DrawNode::drawPoint(const Vec2& position, const float pointSize, const Colo
     
     _bufferCountGLPoint += 1;
     _dirtyGLPoint = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawPoints(const Vec2 *position, unsigned int numberOfPoints, const Color4F &color)
@@ -480,6 +695,8 @@ void DrawNode::drawPoints(const Vec2 *position, unsigned int numberOfPoints, con
     
     _bufferCountGLPoint += numberOfPoints;
     _dirtyGLPoint = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawLine(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -499,6 +716,8 @@ void DrawNode::drawLine(const Vec2 &origin, const Vec2 &destination, const Color
     
     _bufferCountGLLine += 2;
     _dirtyGLLine = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -550,80 +769,59 @@ void DrawNode::drawPoly(const Vec2 *poli, unsigned int numberOfPoints, bool clos
     }
     
     _bufferCountGLLine += vertex_count;
+    _dirtyGLLine = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawEllipse(const Vec2 &center, float rx, float ry, float angle, int segments, bool drawLineToCenter, const Color4F &color)
 {
-	int additionalSegment = 1;
-
-	if (drawLineToCenter)
-	{
-		additionalSegment++;
-	}
-
-	const float coef = 2.0f * (float)M_PI / segments;
-
-	Vec2 *vertices = new (std::nothrow) Vec2[segments + 2];
-
-	if (!vertices)
+	if (segments <= 0)
 	{
 		return;
 	}
 
-	float rads, distance, a, j, k;
+	// Same points as sampling (distance * sin(a + angle), distance * cos(a + angle)) per segment, scaled by the content scale factor
+	const float scale = CC_CONTENT_SCALE_FACTOR();
+	const float sinAngle = sinf(angle);
+	const float cosAngle = cosf(angle);
+	const AffineTransform transform = AffineTransformMake(
+		scale * ry * sinAngle, scale * ry * cosAngle,
+		scale * rx * cosAngle, -scale * rx * sinAngle,
+		scale * center.x, scale * center.y);
+	const UnitCircle& circle = getUnitCircle((unsigned int)segments);
 
-	for (int i = 0; i <= segments; ++i)
-	{
-		rads = i * coef;
-		distance = sqrt(pow(sinf(rads) * rx, 2) + pow(cosf(rads) * ry, 2));
-		a = atan2(sinf(rads) * rx, cosf(rads) * ry);
-		j = distance * sinf(a + angle) + center.x;
-		k = distance * cosf(a + angle) + center.y;
-
-		vertices[i].x = j * CC_CONTENT_SCALE_FACTOR();
-		vertices[i].y = k * CC_CONTENT_SCALE_FACTOR();
-	}
+	appendTransformedLines(circle.points.data(), (unsigned int)circle.points.size(), transform, color);
 
 	if (drawLineToCenter)
 	{
-		vertices[segments + 1].x = center.x;
-		vertices[segments + 1].y = center.y;
-		drawPoly(vertices, segments + 2, true, color);
+		drawLine(applyTransform(transform, circle.points.back()), center, color);
+		drawLine(center, applyTransform(transform, circle.points.front()), color);
 	}
-	else
-	{
-		drawPoly(vertices, segments + 1, true, color);
-	}
-
-	CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY, const Color4F &color)
 {
-    const float coef = 2.0f * (float)M_PI/segments;
-    
-    Vec2 *vertices = new (std::nothrow) Vec2[segments+2];
-    if( ! vertices )
+    if (segments == 0)
+    {
         return;
-    
-    for(unsigned int i = 0;i <= segments; i++) {
-        float rads = i*coef;
-        GLfloat j = radius * cosf(rads + angle) * scaleX + center.x;
-        GLfloat k = radius * sinf(rads + angle) * scaleY + center.y;
-        
-        vertices[i].x = j;
-        vertices[i].y = k;
     }
+
+    const float sinAngle = sinf(angle);
+    const float cosAngle = cosf(angle);
+    const AffineTransform transform = AffineTransformMake(
+        radius * scaleX * cosAngle, radius * scaleY * sinAngle,
+        -radius * scaleX * sinAngle, radius * scaleY * cosAngle,
+        center.x, center.y);
+    const UnitCircle& circle = getUnitCircle(segments);
+
+    appendTransformedLines(circle.points.data(), (unsigned int)circle.points.size(), transform, color);
+
     if(drawLineToCenter)
     {
-        vertices[segments+1].x = center.x;
-        vertices[segments+1].y = center.y;
-        drawPoly(vertices, segments+2, true, color);
+        drawLine(applyTransform(transform, circle.points.back()), center, color);
+        drawLine(center, applyTransform(transform, circle.points.front()), color);
     }
-    else
-        drawPoly(vertices, segments+1, true, color);
-    
-    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawCircle(const Vec2 &center, float radius, float angle, unsigned int segments, bool drawLineToCenter, const Color4F &color)
@@ -697,6 +895,8 @@ void DrawNode::drawDot(const Vec2 &pos, float radius, const Color4F &color)
     _bufferCount += vertex_count;
     
     _dirty = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawRect(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Vec2& p4, const Color4F &color)
@@ -781,6 +981,8 @@ void DrawNode::drawSegment(const Vec2 &from, const Vec2 &to, float radius, const
     _bufferCount += vertex_count;
     
     _dirty = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColor, float borderWidth, const Color4F &borderColor)
@@ -814,9 +1016,11 @@ void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColo
     
     if(outline)
     {
+        // Reused between calls so that outlined polygons drawn every frame do not allocate
         struct ExtrudeVerts {Vec2 offset, n;};
-        struct ExtrudeVerts* extrude = (struct ExtrudeVerts*)malloc(sizeof(struct ExtrudeVerts)*count);
-        memset(extrude, 0, sizeof(struct ExtrudeVerts)*count);
+        static std::vector<ExtrudeVerts> s_extrude;
+        s_extrude.resize(count);
+        ExtrudeVerts* extrude = s_extrude.data();
         
         for (int i = 0; i < count; i++)
         {
@@ -862,13 +1066,13 @@ void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColo
             };
             *cursor++ = tmp2;
         }
-        
-        free(extrude);
     }
     
     _bufferCount += vertex_count;
     
     _dirty = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::drawSolidRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -883,6 +1087,134 @@ void DrawNode::drawSolidRect(const Vec2 &origin, const Vec2 &destination, const
     drawSolidPoly(vertices, 4, color );
 }
 
+void DrawNode::drawRoundedRect(const Vec2 &origin, const Vec2 &destination, float radius, unsigned int cornerSegments, const Color4F &color)
+{
+    const std::vector<Vec2>& points = buildRoundedRect(origin, destination, radius, cornerSegments);
+
+    drawPoly(points.data(), (unsigned int)points.size(), true, color);
+}
+
+void DrawNode::drawSolidRoundedRect(const Vec2 &origin, const Vec2 &destination, float radius, unsigned int cornerSegments, const Color4F &color)
+{
+    const std::vector<Vec2>& points = buildRoundedRect(origin, destination, radius, cornerSegments);
+
+    drawSolidPoly(points.data(), (unsigned int)points.size(), color);
+}
+
+const std::vector<Vec2>& DrawNode::buildRoundedRect(const Vec2 &origin, const Vec2 &destination, float radius, unsigned int cornerSegments)
+{
+    const float minX = std::min(origin.x, destination.x);
+    const float minY = std::min(origin.y, destination.y);
+    const float maxX = std::max(origin.x, destination.x);
+    const float maxY = std::max(origin.y, destination.y);
+
+    radius = std::max(0.0f, std::min(radius, std::min(maxX - minX, maxY - minY) / 2.0f));
+    cornerSegments = std::max(cornerSegments, 1u);
+
+    // Counter clockwise from the top right corner, each corner being a quarter of the same cached circle
+    const Vec2 centers[] = {
+        Vec2(maxX - radius, maxY - radius),
+        Vec2(minX + radius, maxY - radius),
+        Vec2(minX + radius, minY + radius),
+        Vec2(maxX - radius, minY + radius),
+    };
+    const UnitCircle& circle = getUnitCircle(cornerSegments * 4);
+
+    s_roundedRectPoints.clear();
+
+    for (int corner = 0; corner < 4; corner++)
+    {
+        const AffineTransform transform = AffineTransformMake(radius, 0.0f, 0.0f, radius, centers[corner].x, centers[corner].y);
+
+        for (unsigned int i = 0; i <= cornerSegments; i++)
+        {
+            s_roundedRectPoints.push_back(applyTransform(transform, circle.points[corner * cornerSegments + i]));
+        }
+    }
+
+    return s_roundedRectPoints;
+}
+
+void DrawNode::appendTransformedLines(const Vec2 *points, unsigned int numberOfPoints, const AffineTransform &transform, const Color4F &color)
+{
+    if (numberOfPoints < 2)
+    {
+        return;
+    }
+
+    const unsigned int vertex_count = 2 * (numberOfPoints - 1);
+    ensureCapacityGLLine(vertex_count);
+
+    const Color4B color4B = Color4B(color);
+    const Tex2F texCoords = Tex2F(0.0f, 0.0f);
+    V2F_C4B_T2F *point = (V2F_C4B_T2F*)(_bufferGLLine + _bufferCountGLLine);
+    Vec2 previous = applyTransform(transform, points[0]);
+    Vec2 lowest = previous;
+    Vec2 highest = previous;
+
+    for (unsigned int i = 1; i < numberOfPoints; i++)
+    {
+        Vec2 next = applyTransform(transform, points[i]);
+
+        V2F_C4B_T2F a = {previous, color4B, texCoords};
+        V2F_C4B_T2F b = {next, color4B, texCoords};
+        *point = a;
+        *(point+1) = b;
+        point += 2;
+
+        lowest.x = std::min(lowest.x, next.x);
+        lowest.y = std::min(lowest.y, next.y);
+        highest.x = std::max(highest.x, next.x);
+        highest.y = std::max(highest.y, next.y);
+        previous = next;
+    }
+
+    this->updateBoundsToPoint(lowest);
+    this->updateBoundsToPoint(highest);
+
+    _bufferCountGLLine += vertex_count;
+    _dirtyGLLine = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
+}
+
+void DrawNode::appendTransformedTriangles(const Vec2 *vertices, unsigned int numberOfVertices, const AffineTransform &transform, const Color4F &color)
+{
+    if (numberOfVertices < 3)
+    {
+        return;
+    }
+
+    ensureCapacity(numberOfVertices);
+
+    const Color4B color4B = Color4B(color);
+    const Tex2F texCoords = Tex2F(0.0f, 0.0f);
+    V2F_C4B_T2F *cursor = _buffer + _bufferCount;
+    Vec2 lowest = applyTransform(transform, vertices[0]);
+    Vec2 highest = lowest;
+
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        Vec2 position = applyTransform(transform, vertices[i]);
+
+        V2F_C4B_T2F vertex = {position, color4B, texCoords};
+        *cursor++ = vertex;
+
+        lowest.x = std::min(lowest.x, position.x);
+        lowest.y = std::min(lowest.y, position.y);
+        highest.x = std::max(highest.x, position.x);
+        highest.y = std::max(highest.y, position.y);
+    }
+
+    this->updateBoundsToPoint(lowest);
+    this->updateBoundsToPoint(highest);
+
+    _bufferCount += numberOfVertices;
+    _dirty = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
+}
+
 void DrawNode::drawSolidPoly(const Vec2 *poli, unsigned int numberOfPoints, const Color4F &color)
 {
     drawPolygon(poli, numberOfPoints, color, 0.0, Color4F(0.0, 0.0, 0.0, 0.0));
@@ -890,25 +1222,20 @@ void DrawNode::drawSolidPoly(const Vec2 *poli, unsigned int numberOfPoints, cons
 
 void DrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, float scaleX, float scaleY, const Color4F &color)
 {
-    const float coef = 2.0f * (float)M_PI/segments;
-    
-    Vec2 *vertices = new (std::nothrow) Vec2[segments];
-    if( ! vertices )
-        return;
-    
-    for(unsigned int i = 0;i < segments; i++)
+    if (segments == 0)
     {
-        float rads = i*coef;
-        GLfloat j = radius * cosf(rads + angle) * scaleX + center.x;
-        GLfloat k = radius * sinf(rads + angle) * scaleY + center.y;
-        
-        vertices[i].x = j;
-        vertices[i].y = k;
+        return;
     }
-    
-    drawSolidPoly(vertices, segments, color);
-    
-    CC_SAFE_DELETE_ARRAY(vertices);
+
+    const float sinAngle = sinf(angle);
+    const float cosAngle = cosf(angle);
+    const AffineTransform transform = AffineTransformMake(
+        radius * scaleX * cosAngle, radius * scaleY * sinAngle,
+        -radius * scaleX * sinAngle, radius * scaleY * cosAngle,
+        center.x, center.y);
+    const UnitCircle& circle = getUnitCircle(segments);
+
+    appendTransformedTriangles(circle.fan.data(), (unsigned int)circle.fan.size(), transform, color);
 }
 
 void DrawNode::drawSolidCircle( const Vec2& center, float radius, float angle, unsigned int segments, const Color4F& color)
@@ -936,6 +1263,8 @@ void DrawNode::drawTriangle(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, cons
 
     _bufferCount += vertex_count;
     _dirty = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
 }
 
 void DrawNode::clear()
@@ -948,9 +1277,72 @@ void DrawNode::clear()
     _dirtyGLLine = true;
     _bufferCountGLPoint = 0;
     _dirtyGLPoint = true;
+    _dirtyBatch = true;
+    invalidateCachedAncestors();
     _lineWidth = _defaultLineWidth;
 }
 
+bool DrawNode::getSolidRect(CRect &rect) const
+{
+    if (_bufferCount != 6 || _bufferCountGLLine != 0 || _bufferCountGLPoint != 0)
+    {
+        return false;
+    }
+
+    float minX = _buffer[0].vertices.x;
+    float minY = _buffer[0].vertices.y;
+    float maxX = minX;
+    float maxY = minY;
+
+    for (int i = 1; i < 6; i++)
+    {
+        minX = std::min(minX, _buffer[i].vertices.x);
+        minY = std::min(minY, _buffer[i].vertices.y);
+        maxX = std::max(maxX, _buffer[i].vertices.x);
+        maxY = std::max(maxY, _buffer[i].vertices.y);
+    }
+
+    if (maxX <= minX || maxY <= minY)
+    {
+        return false;
+    }
+
+    // Both triangles must use three distinct corners of the bounds, and leave out opposite corners so that they meet on a diagonal
+    int missingCorners[2];
+
+    for (int triangle = 0; triangle < 2; triangle++)
+    {
+        int corners = 0;
+
+        for (int i = triangle * 3; i < triangle * 3 + 3; i++)
+        {
+            const Vec2& vertex = _buffer[i].vertices;
+
+            if ((vertex.x != minX && vertex.x != maxX) || (vertex.y != minY && vertex.y != maxY))
+            {
+                return false;
+            }
+
+            corners |= 1 << ((vertex.x == maxX ? 1 : 0) | (vertex.y == maxY ? 2 : 0));
+        }
+
+        missingCorners[triangle] = ~corners & 0xF;
+
+        if (missingCorners[triangle] != 1 && missingCorners[triangle] != 2 && missingCorners[triangle] != 4 && missingCorners[triangle] != 8)
+        {
+            return false;
+        }
+    }
+
+    if ((missingCorners[0] | missingCorners[1]) != 0x9 && (missingCorners[0] | missingCorners[1]) != 0x6)
+    {
+        return false;
+    }
+
+    rect = CRect(minX, minY, maxX - minX, maxY - minY);
+    return true;
+}
+
 const BlendFunc& DrawNode::getBlendFunc() const
 {
     return _blendFunc;
@@ -34,7 +34,10 @@
 
 #include "2d/CCNode.h"
 #include "base/ccTypes.h"
+#include <vector>
+
 #include "renderer/CCCustomCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "math/CCMath.h"
 
 NS_CC_BEGIN
@@ -191,6 +194,28 @@ public:
      * @js NA
      */
     void drawSolidRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color);
+
+    /** Draws a rectangle with rounded corners given the origin and destination point measured in points.
+     *
+     * @param origin The rectangle origin.
+     * @param destination The rectangle destination.
+     * @param radius The corner radius, clamped to half of the shortest side.
+     * @param cornerSegments The number of segments of each corner.
+     * @param color The rectangle color.
+     * @js NA
+     */
+    void drawRoundedRect(const Vec2 &origin, const Vec2 &destination, float radius, unsigned int cornerSegments, const Color4F &color);
+
+    /** Draws a solid rectangle with rounded corners given the origin and destination point measured in points.
+     *
+     * @param origin The rectangle origin.
+     * @param destination The rectangle destination.
+     * @param radius The corner radius, clamped to half of the shortest side.
+     * @param cornerSegments The number of segments of each corner.
+     * @param color The rectangle color.
+     * @js NA
+     */
+    void drawSolidRoundedRect(const Vec2 &origin, const Vec2 &destination, float radius, unsigned int cornerSegments, const Color4F &color);
     
     /** Draws a solid polygon given a pointer to CGPoint coordinates, the number of vertices measured in points, and a color.
      *
@@ -259,6 +284,14 @@ public:
     
     /** Clear the geometry in the node's buffer. */
     void clear();
+
+    /** Checks whether the node draws nothing but one solid axis aligned rectangle, such as a single drawSolidRect().
+     * ClippingNode uses this to clip with a scissor rect instead of the stencil buffer.
+     *
+     * @param rect Receives the rectangle in node space.
+     * @return True if the node is exactly one solid rectangle.
+     */
+    bool getSolidRect(CRect &rect) const;
     /** Get the color mixed mode.
     * @lua NA
     */
@@ -272,7 +305,8 @@ public:
     */
     void setBlendFunc(const BlendFunc &blendFunc);
 
-    /**
+    /** Draws the node with one CustomCommand per primitive type. Only used when a custom GLProgram is set,
+     * the default program is drawn with TrianglesCommands that batch with other DrawNodes.
      * @js NA
      */
     virtual void onDraw(const Mat4 &transform, uint32_t flags);
@@ -302,6 +336,18 @@ protected:
     void ensureCapacityGLPoint(int count);
     void ensureCapacityGLLine(int count);
 
+    /** Appends a polyline of cached points, mapped through one affine transform */
+    void appendTransformedLines(const Vec2 *points, unsigned int numberOfPoints, const AffineTransform &transform, const Color4F &color);
+    /** Appends a triangle list of cached vertices, mapped through one affine transform */
+    void appendTransformedTriangles(const Vec2 *vertices, unsigned int numberOfVertices, const AffineTransform &transform, const Color4F &color);
+    /** Writes the outline of a rounded rectangle into the shared scratch polygon */
+    const std::vector<Vec2>& buildRoundedRect(const Vec2 &origin, const Vec2 &destination, float radius, unsigned int cornerSegments);
+
+    /** Whether the node can be drawn with TrianglesCommands, which requires the default GLProgram */
+    bool isBatchable() const;
+    /** Converts triangles, lines and points into world space ready triangles for the batched path */
+    void updateBatchBuffer();
+
     GLuint      _vao;
     GLuint      _vbo;
     GLuint      _vaoGLPoint;
@@ -328,9 +374,18 @@ protected:
     CustomCommand _customCommandGLPoint;
     CustomCommand _customCommandGLLine;
 
+    V3F_C4B_T2F *_batchBuffer;          // triangles, lines as thin quads and points as squares, with the opacity premultiplied
+    int         _batchCapacity;
+    int         _batchCount;
+    GLubyte     _batchOpacity;          // the opacity and line width _batchBuffer was built with
+    GLfloat     _batchLineWidth;
+    GLProgramState* _batchGLProgramState;
+    std::vector<TrianglesCommand> _trianglesCommands;
+
     bool        _dirty;
     bool        _dirtyGLPoint;
     bool        _dirtyGLLine;
+    bool        _dirtyBatch;
     
     GLfloat         _lineWidth;
 
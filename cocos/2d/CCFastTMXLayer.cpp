@@ -759,6 +759,7 @@ void TMXLayer::setFlaggedTileGIDByIndex(int index, uint32_t gid)
     _tiles[index] = gid;
     _quadsDirty = true;
     _dirty = true;
+    invalidateCachedAncestors();
 }
 
 void TMXLayer::removeChild(Node* node, bool cleanup)
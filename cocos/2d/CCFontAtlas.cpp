@@ -30,7 +30,13 @@
 #include <iconv.h>
 #endif
 
+#include <algorithm>
+#include <climits>
+#include <memory>
+
 #include "2d/CCFontFreeType.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
@@ -45,15 +51,36 @@ const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
 
+static int s_maxPageSize = 2048;
+static bool s_asyncRasterization = false;
+
+static void clearLetterDefinition(FontLetterDefinition& letterDefinition)
+{
+    letterDefinition.validDefinition = letterDefinition.xAdvance != 0;
+    letterDefinition.width = 0;
+    letterDefinition.height = 0;
+    letterDefinition.U = 0;
+    letterDefinition.V = 0;
+    letterDefinition.offsetX = 0;
+    letterDefinition.offsetY = 0;
+    letterDefinition.textureID = 0;
+}
+
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
 , _fontFreeType(nullptr)
 , _iconv(nullptr)
 , _currentPageData(nullptr)
+, _currentPageDataSize(0)
+, _currentPageWidth(0)
+, _currentPageHeight(0)
+, _bytesPerPixel(1)
+, _textureRevision(0)
+, _glyphRevision(0)
+, _glyphGeneration(0)
 , _fontAscender(0)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
-, _currLineHeight(0)
 {
     _font->retain();
 
@@ -63,8 +90,6 @@ FontAtlas::FontAtlas(Font &theFont)
         _lineHeight = _font->getFontMaxHeight();
         _fontAscender = _fontFreeType->getFontAscender();
         _currentPage = 0;
-        _currentPageOrigX = 0;
-        _currentPageOrigY = 0;
         _letterEdgeExtend = 2;
         _letterPadding = 0;
 
@@ -79,32 +104,16 @@ FontAtlas::FontAtlas(Font &theFont)
 
 void FontAtlas::reinit()
 {
-    if (_currentPageData)
-    {
-        delete []_currentPageData;
-        _currentPageData = nullptr;
-    }
-    
-    auto texture = new (std::nothrow) Texture2D;
-    
-    _currentPageDataSize = CacheTextureWidth * CacheTextureHeight;
-    
     auto outlineSize = _fontFreeType->getOutlineSize();
     if(outlineSize > 0)
     {
         _lineHeight += 2 * outlineSize;
-        _currentPageDataSize *= 2;
     }
-    
-    _currentPageData = new (std::nothrow) unsigned char[_currentPageDataSize];
-    memset(_currentPageData, 0, _currentPageDataSize);
-    
-    auto  pixelFormat = outlineSize > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
-    texture->initWithData(_currentPageData, _currentPageDataSize,
-                          pixelFormat, CacheTextureWidth, CacheTextureHeight, CSize(CacheTextureWidth,CacheTextureHeight) );
-    
-    addTexture(texture,0);
-    texture->release();
+
+    _bytesPerPixel = outlineSize > 0 ? 2 : 1;
+    _currentPage = -1;
+
+    startNewPage();
 }
 
 FontAtlas::~FontAtlas()
@@ -127,11 +136,11 @@ void FontAtlas::reset()
 {
     releaseTextures();
     
-    _currLineHeight = 0;
-    _currentPage = 0;
-    _currentPageOrigX = 0;
-    _currentPageOrigY = 0;
     _letterDefinitions.clear();
+
+    // Glyphs still on the worker belong to the released pages
+    _pendingGlyphs.clear();
+    _glyphGeneration++;
     
     reinit();
 }
@@ -334,121 +343,494 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
+    if (s_asyncRasterization)
+    {
+        requestGlyphs(codeMapOfNewChar, nullptr);
+        return false;
+    }
+
     int adjustForExtend = _letterEdgeExtend / 2;
     long bitmapWidth;
     long bitmapHeight;
-    int glyphHeight;
     CRect tempRect;
     FontLetterDefinition tempDef;
 
-    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
-
-    float startY = _currentPageOrigY;
-
     for (auto&& it : codeMapOfNewChar)
     {
         auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
+
         if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
         {
-            tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x - adjustForDistanceMap - adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+            int x = 0;
+            int y = 0;
 
-            if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+            if (reserveLetter(tempRect, bitmapHeight, tempDef, x, y))
             {
-                _currentPageOrigY += _currLineHeight;
-                _currLineHeight = 0;
-                _currentPageOrigX = 0;
-                if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
-                {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
-                    _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                        CacheTextureWidth, CacheTextureHeight - startY);
-
-                    startY = 0.0f;
-
-                    _currentPageOrigY = 0;
-                    memset(_currentPageData, 0, _currentPageDataSize);
-                    _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, CSize(CacheTextureWidth, CacheTextureHeight));
-                    addTexture(tex, _currentPage);
-                    tex->release();
-                }
+                _fontFreeType->renderCharAt(_currentPageData, x + adjustForExtend, y + adjustForExtend, bitmap, bitmapWidth, bitmapHeight, _currentPageWidth);
             }
-            glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
-            if (glyphHeight > _currLineHeight)
+            else
             {
-                _currLineHeight = glyphHeight;
+                CCLOG("FontAtlas: glyph %u does not fit in the max page size", it.first);
+
+                // renderCharAt() would have released the outline bitmap
+                if (_fontFreeType->getOutlineSize() > 0)
+                    delete[] bitmap;
             }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
-
-            tempDef.U = _currentPageOrigX;
-            tempDef.V = _currentPageOrigY;
-            tempDef.textureID = _currentPage;
-            _currentPageOrigX += tempDef.width + 1;
-            // take from pixels to points
-            tempDef.width = tempDef.width / scaleFactor;
-            tempDef.height = tempDef.height / scaleFactor;
-            tempDef.U = tempDef.U / scaleFactor;
-            tempDef.V = tempDef.V / scaleFactor;
-        }
-        else{
-            if(bitmap)
+        }
+        else
+        {
+            if (bitmap)
                 delete[] bitmap;
-            if (tempDef.xAdvance)
-                tempDef.validDefinition = true;
-            else
-                tempDef.validDefinition = false;
 
-            tempDef.width = 0;
-            tempDef.height = 0;
-            tempDef.U = 0;
-            tempDef.V = 0;
-            tempDef.offsetX = 0;
-            tempDef.offsetY = 0;
-            tempDef.textureID = 0;
-            _currentPageOrigX += 1;
+            clearLetterDefinition(tempDef);
         }
 
         _letterDefinitions[it.first] = tempDef;
     }
 
-    unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+    uploadDirtyRect();
+
+    return true;
+}
+
+void FontAtlas::setAsyncRasterizationEnabled(bool enabled)
+{
+    s_asyncRasterization = enabled;
+}
+
+bool FontAtlas::isAsyncRasterizationEnabled()
+{
+    return s_asyncRasterization;
+}
+
+void FontAtlas::prewarm(const std::u32string& charset, const std::function<void()>& callback)
+{
+    std::unordered_map<unsigned int, unsigned int> codeMapOfNewChar;
+
+    if (_fontFreeType != nullptr)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+        findNewCharacters(charset, codeMapOfNewChar);
     }
-    else
+
+    requestGlyphs(codeMapOfNewChar, callback);
+}
+
+void FontAtlas::prewarm(const std::string& utf8Charset, const std::function<void()>& callback)
+{
+    std::u32string utf32;
+
+    if (!StringUtils::UTF8ToUTF32(utf8Charset, utf32))
+    {
+        CCLOG("FontAtlas::prewarm: invalid UTF-8 charset");
+    }
+
+    prewarm(utf32, callback);
+}
+
+void FontAtlas::requestGlyphs(const std::unordered_map<unsigned int, unsigned int>& charCodeMap, const std::function<void()>& callback)
+{
+    std::vector<std::pair<unsigned int, unsigned int>> codes;
+    codes.reserve(charCodeMap.size());
+
+    for (auto&& it : charCodeMap)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY;
+        if (_pendingGlyphs.insert(it.first).second)
+        {
+            codes.push_back(it);
+        }
     }
-    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
+
+    if (codes.empty() && callback == nullptr)
+    {
+        return;
+    }
+
+    // Even an empty job is queued for a callback, so it runs after the jobs already holding its characters
+    auto glyphs = std::make_shared<std::vector<FontGlyphBitmap>>();
+    auto font = _fontFreeType;
+    auto generation = _glyphGeneration;
+
+    // The atlas, and the font it retains, must outlive the job
+    retain();
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_GLYPH, [this, glyphs, generation, callback](void*)
+    {
+        // Results for pages released by reset() are dropped, the glyphs will be requested again
+        if (generation == _glyphGeneration)
+        {
+            addRasterizedGlyphs(*glyphs);
+        }
+
+        if (callback)
+        {
+            callback();
+        }
+
+        release();
+    }, nullptr, [font, glyphs, codes]()
+    {
+        glyphs->resize(codes.size());
+
+        for (size_t index = 0; index < codes.size(); index++)
+        {
+            font->rasterizeGlyph(codes[index].second, (*glyphs)[index]);
+            (*glyphs)[index].charCode = codes[index].first;
+        }
+    });
+}
+
+void FontAtlas::addRasterizedGlyphs(const std::vector<FontGlyphBitmap>& glyphs)
+{
+    if (glyphs.empty())
+    {
+        return;
+    }
+
+    int adjustForExtend = _letterEdgeExtend / 2;
+    FontLetterDefinition tempDef;
+
+    for (auto&& glyph : glyphs)
+    {
+        tempDef.xAdvance = glyph.xAdvance;
+
+        if (!glyph.pixels.empty())
+        {
+            int x = 0;
+            int y = 0;
+
+            if (reserveLetter(glyph.rect, glyph.bitmapHeight, tempDef, x, y))
+            {
+                int rowSize = glyph.width * _bytesPerPixel;
+
+                for (int row = 0; row < glyph.height; row++)
+                {
+                    auto dest = _currentPageData + ((y + adjustForExtend + row) * _currentPageWidth + x + adjustForExtend) * _bytesPerPixel;
+                    memcpy(dest, glyph.pixels.data() + row * rowSize, rowSize);
+                }
+            }
+            else
+            {
+                CCLOG("FontAtlas: glyph %u does not fit in the max page size", glyph.charCode);
+            }
+        }
+        else
+        {
+            clearLetterDefinition(tempDef);
+        }
+
+        _letterDefinitions[glyph.charCode] = tempDef;
+        _pendingGlyphs.erase(glyph.charCode);
+    }
+
+    uploadDirtyRect();
+    _glyphRevision++;
+}
+
+bool FontAtlas::reserveLetter(const CRect& glyphRect, long bitmapHeight, FontLetterDefinition& letterDefinition, int& outX, int& outY)
+{
+    int adjustForDistanceMap = _letterPadding / 2;
+    int adjustForExtend = _letterEdgeExtend / 2;
+
+    letterDefinition.validDefinition = true;
+    letterDefinition.width = glyphRect.size.width + _letterPadding + _letterEdgeExtend;
+    letterDefinition.height = glyphRect.size.height + _letterPadding + _letterEdgeExtend;
+    letterDefinition.offsetX = glyphRect.origin.x - adjustForDistanceMap - adjustForExtend;
+    letterDefinition.offsetY = _fontAscender + glyphRect.origin.y - adjustForDistanceMap - adjustForExtend;
+
+    // Reserve one extra texel to the right and below each glyph so linear filtering never reads a neighbour
+    int slotWidth = static_cast<int>(letterDefinition.width) + 1;
+    int slotHeight = std::max(static_cast<int>(letterDefinition.height), static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend) + 1;
+
+    if (!allocateGlyphRect(slotWidth, slotHeight, outX, outY))
+    {
+        clearLetterDefinition(letterDefinition);
+        return false;
+    }
+
+    _dirtyMinX = std::min(_dirtyMinX, outX);
+    _dirtyMinY = std::min(_dirtyMinY, outY);
+    _dirtyMaxX = std::max(_dirtyMaxX, std::min(outX + slotWidth, _currentPageWidth));
+    _dirtyMaxY = std::max(_dirtyMaxY, std::min(outY + slotHeight, _currentPageHeight));
+
+    // take from pixels to points
+    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
+    letterDefinition.U = outX / scaleFactor;
+    letterDefinition.V = outY / scaleFactor;
+    letterDefinition.width = letterDefinition.width / scaleFactor;
+    letterDefinition.height = letterDefinition.height / scaleFactor;
+    letterDefinition.textureID = _currentPage;
 
     return true;
 }
 
+bool FontAtlas::allocateGlyphRect(int width, int height, int& outX, int& outY)
+{
+    bool found = findPagePosition(width, height, _currentPageWidth, _currentPageHeight, outX, outY)
+        || (growCurrentPage(width, height) && findPagePosition(width, height, _currentPageWidth, _currentPageHeight, outX, outY));
+
+    if (!found)
+    {
+        startNewPage();
+
+        found = findPagePosition(width, height, _currentPageWidth, _currentPageHeight, outX, outY)
+            || (growCurrentPage(width, height) && findPagePosition(width, height, _currentPageWidth, _currentPageHeight, outX, outY));
+    }
+
+    if (found)
+    {
+        addSkylineLevel(outX, outY, width, height);
+    }
+
+    return found;
+}
+
+bool FontAtlas::findPagePosition(int width, int height, int pageWidth, int pageHeight, int& outX, int& outY) const
+{
+    int bestBottom = INT_MAX;
+    int bestWidth = INT_MAX;
+    bool found = false;
+
+    for (size_t index = 0; index < _skyline.size(); index++)
+    {
+        int x = _skyline[index].x;
+
+        if (x + width > pageWidth)
+        {
+            break;
+        }
+
+        // The rectangle rests on the highest segment it spans
+        int y = 0;
+        int remaining = width;
+
+        for (size_t span = index; remaining > 0 && span < _skyline.size(); span++)
+        {
+            y = std::max(y, _skyline[span].y);
+            remaining -= _skyline[span].width;
+        }
+
+        if (remaining > 0 || y + height > pageHeight)
+        {
+            continue;
+        }
+
+        if (y + height < bestBottom || (y + height == bestBottom && _skyline[index].width < bestWidth))
+        {
+            bestBottom = y + height;
+            bestWidth = _skyline[index].width;
+            outX = x;
+            outY = y;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void FontAtlas::addSkylineLevel(int x, int y, int width, int height)
+{
+    SkylineSegment segment = { x, y + height, width };
+    auto it = std::lower_bound(_skyline.begin(), _skyline.end(), x, [](const SkylineSegment& other, int value)
+    {
+        return other.x < value;
+    });
+
+    it = _skyline.insert(it, segment);
+
+    // Trim the segments now covered by the new one
+    auto next = it + 1;
+
+    while (next != _skyline.end() && next->x < x + width)
+    {
+        int overlap = x + width - next->x;
+
+        if (overlap >= next->width)
+        {
+            next = _skyline.erase(next);
+        }
+        else
+        {
+            next->x += overlap;
+            next->width -= overlap;
+            break;
+        }
+    }
+
+    // Merge neighbours at the same height
+    for (size_t index = 0; index + 1 < _skyline.size();)
+    {
+        if (_skyline[index].y == _skyline[index + 1].y)
+        {
+            _skyline[index].width += _skyline[index + 1].width;
+            _skyline.erase(_skyline.begin() + index + 1);
+        }
+        else
+        {
+            index++;
+        }
+    }
+}
+
+bool FontAtlas::growCurrentPage(int width, int height)
+{
+    int maxPageSize = std::min(s_maxPageSize, Configuration::getInstance()->getMaxTextureSize());
+
+    // setMaxPageSize() may have raised the limit since the page started, so extend the skyline over the columns it can now grow into
+    int skylineEnd = _skyline.empty() ? 0 : _skyline.back().x + _skyline.back().width;
+
+    if (skylineEnd < maxPageSize)
+    {
+        if (!_skyline.empty() && _skyline.back().y == 0)
+        {
+            _skyline.back().width += maxPageSize - skylineEnd;
+        }
+        else
+        {
+            _skyline.push_back({ skylineEnd, 0, maxPageSize - skylineEnd });
+        }
+    }
+
+    int newWidth = _currentPageWidth;
+    int newHeight = _currentPageHeight;
+    int x = 0;
+    int y = 0;
+
+    // Grow the shorter side first to keep pages square-ish, until the rectangle fits on the skyline
+    do
+    {
+        if (newWidth >= maxPageSize && newHeight >= maxPageSize)
+        {
+            return false;
+        }
+
+        if ((newHeight <= newWidth && newHeight < maxPageSize) || newWidth >= maxPageSize)
+        {
+            newHeight = std::min(newHeight * 2, maxPageSize);
+        }
+        else
+        {
+            newWidth = std::min(newWidth * 2, maxPageSize);
+        }
+    } while (!findPagePosition(width, height, newWidth, newHeight, x, y));
+
+    int oldWidth = _currentPageWidth;
+    int oldHeight = _currentPageHeight;
+    int newDataSize = newWidth * newHeight * _bytesPerPixel;
+    unsigned char* newData = new (std::nothrow) unsigned char[newDataSize];
+
+    if (newData == nullptr)
+    {
+        return false;
+    }
+
+    memset(newData, 0, newDataSize);
+
+    for (int row = 0; row < oldHeight; row++)
+    {
+        memcpy(newData + row * newWidth * _bytesPerPixel, _currentPageData + row * oldWidth * _bytesPerPixel, oldWidth * _bytesPerPixel);
+    }
+
+    delete []_currentPageData;
+    _currentPageData = newData;
+    _currentPageDataSize = newDataSize;
+    _currentPageWidth = newWidth;
+    _currentPageHeight = newHeight;
+
+    // Reallocate the texture from the CPU copy, which already holds every pending glyph, so the grown area starts out cleared
+    auto pixelFormat = _bytesPerPixel == 2 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    _atlasTextures[_currentPage]->initWithData(_currentPageData, _currentPageDataSize, pixelFormat, _currentPageWidth, _currentPageHeight, CSize(_currentPageWidth, _currentPageHeight));
+
+    _dirtyMinX = _currentPageWidth;
+    _dirtyMinY = _currentPageHeight;
+    _dirtyMaxX = 0;
+    _dirtyMaxY = 0;
+    _textureRevision++;
+
+    return true;
+}
+
+void FontAtlas::startNewPage()
+{
+    if (_currentPage >= 0 && _atlasTextures.find(_currentPage) != _atlasTextures.end())
+    {
+        uploadDirtyRect();
+    }
+
+    _currentPage++;
+    _currentPageWidth = CacheTextureWidth;
+    _currentPageHeight = CacheTextureHeight;
+    _currentPageDataSize = _currentPageWidth * _currentPageHeight * _bytesPerPixel;
+
+    delete []_currentPageData;
+    _currentPageData = new (std::nothrow) unsigned char[_currentPageDataSize];
+    memset(_currentPageData, 0, _currentPageDataSize);
+
+    // The skyline spans the widest page this one can grow into, growCurrentPage() extends it if the max page size is raised later
+    _skyline.clear();
+    _skyline.push_back({ 0, 0, std::max(s_maxPageSize, _currentPageWidth) });
+
+    _dirtyMinX = _currentPageWidth;
+    _dirtyMinY = _currentPageHeight;
+    _dirtyMaxX = 0;
+    _dirtyMaxY = 0;
+
+    // The texture starts out cleared, so filtering around glyph rectangles never samples undefined texels
+    auto pixelFormat = _bytesPerPixel == 2 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    auto texture = new (std::nothrow) Texture2D;
+
+    if (_antialiasEnabled)
+    {
+        texture->setAntiAliasTexParameters();
+    }
+    else
+    {
+        texture->setAliasTexParameters();
+    }
+
+    texture->initWithData(_currentPageData, _currentPageDataSize, pixelFormat, _currentPageWidth, _currentPageHeight, CSize(_currentPageWidth, _currentPageHeight));
+
+    addTexture(texture, _currentPage);
+    texture->release();
+}
+
+void FontAtlas::uploadDirtyRect()
+{
+    if (_dirtyMaxX <= _dirtyMinX || _dirtyMaxY <= _dirtyMinY)
+    {
+        return;
+    }
+
+    int width = _dirtyMaxX - _dirtyMinX;
+    int height = _dirtyMaxY - _dirtyMinY;
+    int rowSize = width * _bytesPerPixel;
+    const unsigned char* data = _currentPageData + (_dirtyMinY * _currentPageWidth + _dirtyMinX) * _bytesPerPixel;
+
+    // Sub-rectangles are packed into a scratch buffer, since GLES2 has no GL_UNPACK_ROW_LENGTH
+    if (width != _currentPageWidth)
+    {
+        _uploadBuffer.resize(rowSize * height);
+
+        for (int row = 0; row < height; row++)
+        {
+            memcpy(&_uploadBuffer[row * rowSize], data + row * _currentPageWidth * _bytesPerPixel, rowSize);
+        }
+
+        data = _uploadBuffer.data();
+    }
+
+    // Rows of the scratch buffer are tightly packed, so the alignment is relaxed for this upload only
+    GLint unpackAlignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    _atlasTextures[_currentPage]->updateWithData(data, _dirtyMinX, _dirtyMinY, width, height);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+    _dirtyMinX = _currentPageWidth;
+    _dirtyMinY = _currentPageHeight;
+    _dirtyMaxX = 0;
+    _dirtyMaxY = 0;
+}
+
 void FontAtlas::addTexture(Texture2D *texture, int slot)
 {
     texture->retain();
@@ -460,6 +842,11 @@ Texture2D* FontAtlas::getTexture(int slot)
     return _atlasTextures[slot];
 }
 
+float FontAtlas::getFontSize() const
+{
+    return _fontFreeType ? _fontFreeType->getFontSize() : 0.0f;
+}
+
 void  FontAtlas::setLineHeight(float newHeight)
 {
     _lineHeight = newHeight;
@@ -477,6 +864,16 @@ void FontAtlas::setAliasTexParameters()
     }
 }
 
+void FontAtlas::setMaxPageSize(int maxPageSize)
+{
+    s_maxPageSize = std::max(maxPageSize, std::max(CacheTextureWidth, CacheTextureHeight));
+}
+
+int FontAtlas::getMaxPageSize()
+{
+    return s_maxPageSize;
+}
+
 void FontAtlas::setAntiAliasTexParameters()
 {
     if (! _antialiasEnabled)
@@ -29,11 +29,15 @@
 
 /// @cond DO_NOT_SHOW
 
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
+#include "math/CCGeometry.h"
 #include "platform/CCStdC.h" // ssize_t on windows
 
 NS_CC_BEGIN
@@ -43,6 +47,7 @@ class Texture2D;
 class EventCustom;
 class EventListenerCustom;
 class FontFreeType;
+struct FontGlyphBitmap;
 
 struct FontLetterDefinition
 {
@@ -60,6 +65,7 @@ struct FontLetterDefinition
 class CC_DLL FontAtlas : public Ref
 {
 public:
+    /** Initial size of a glyph page. Pages grow up to the max page size before a new page is started. */
     static const int CacheTextureWidth;
     static const int CacheTextureHeight;
     static const char* CMD_PURGE_FONTATLAS;
@@ -87,6 +93,9 @@ public:
     Texture2D* getTexture(int slot);
     const Font* getFont() const { return _font; }
 
+    /** Gets the font size the glyphs are rasterized at, or 0 for fonts that are not TrueType. */
+    float getFontSize() const;
+
     /** listen the event that renderer was recreated on Android/WP8
      It only has effect on Android and WP8.
      */
@@ -109,7 +118,44 @@ public:
      */
      void setAliasTexParameters();
 
+    /** Sets the largest width and height a glyph page may grow to. It is further limited by the GL max texture size. */
+    static void setMaxPageSize(int maxPageSize);
+    static int getMaxPageSize();
+
+    /** Incremented whenever an existing page texture is resized, which invalidates texture coordinates computed from it. */
+    unsigned int getTextureRevision() const { return _textureRevision; }
+
+    /**
+     * Sets whether prepareLetterDefinitions() rasterizes new glyphs on the glyph worker thread instead of stalling the frame.
+     * Labels leave those letters out until they arrive, then lay themselves out again. Disabled by default.
+     */
+    static void setAsyncRasterizationEnabled(bool enabled);
+    static bool isAsyncRasterizationEnabled();
+
+    /**
+     * Rasterizes the given characters on the glyph worker thread, for example while a loading screen is shown.
+     * @param callback Called on the main thread once the characters are in the atlas.
+     */
+    void prewarm(const std::u32string& charset, const std::function<void()>& callback = nullptr);
+    void prewarm(const std::string& utf8Charset, const std::function<void()>& callback = nullptr);
+
+    /** Checks whether some glyphs are still being rasterized on the glyph worker thread. */
+    bool hasPendingGlyphs() const { return !_pendingGlyphs.empty(); }
+
+    /** Incremented whenever the atlas is reset, which discards its pages and letter definitions. */
+    unsigned int getGeneration() const { return _glyphGeneration; }
+
+    /** Incremented whenever asynchronously rasterized glyphs are added to the atlas. */
+    unsigned int getGlyphRevision() const { return _glyphRevision; }
+
 protected:
+    /** A horizontal span of the skyline: the lowest free row for columns [x, x + width) of the current page. */
+    struct SkylineSegment
+    {
+        int x;
+        int y;
+        int width;
+    };
     void reset();
     
     void reinit();
@@ -120,6 +166,36 @@ protected:
 
     void conversionU32TOGB2312(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
 
+    /** Queues the glyphs that are not already pending on the glyph worker thread. */
+    void requestGlyphs(const std::unordered_map<unsigned int, unsigned int>& charCodeMap, const std::function<void()>& callback);
+
+    /** Copies glyphs rasterized by the worker into the current page and uploads them. */
+    void addRasterizedGlyphs(const std::vector<FontGlyphBitmap>& glyphs);
+
+    /**
+     * Fills in the letter definition of a glyph and reserves its slot in the current page.
+     * @return False if the glyph does not fit, in which case the definition is left empty.
+     */
+    bool reserveLetter(const CRect& glyphRect, long bitmapHeight, FontLetterDefinition& letterDefinition, int& outX, int& outY);
+
+    /** Reserves a width x height rectangle, growing the current page or starting a new one when it is full. */
+    bool allocateGlyphRect(int width, int height, int& outX, int& outY);
+
+    /** Finds the bottom-left-most free spot for a width x height rectangle on a page of the given size. Returns false if it does not fit. */
+    bool findPagePosition(int width, int height, int pageWidth, int pageHeight, int& outX, int& outY) const;
+
+    /** Marks a width x height rectangle at (x, y) as used in the skyline. */
+    void addSkylineLevel(int x, int y, int width, int height);
+
+    /** Doubles the current page until a width x height rectangle fits, then uploads it once at the new size. Returns false at the max page size. */
+    bool growCurrentPage(int width, int height);
+
+    /** Uploads any previous glyphs and starts an empty page at the initial size. */
+    void startNewPage();
+
+    /** Uploads the rectangle of the current page touched since the last upload. */
+    void uploadDirtyRect();
+
     /**
      * Scale each font letter by scaleFactor.
      *
@@ -138,15 +214,25 @@ protected:
     int _currentPage;
     unsigned char *_currentPageData;
     int _currentPageDataSize;
-    float _currentPageOrigX;
-    float _currentPageOrigY;
+    int _currentPageWidth;
+    int _currentPageHeight;
+    int _bytesPerPixel;
+    std::vector<SkylineSegment> _skyline;
+    int _dirtyMinX;
+    int _dirtyMinY;
+    int _dirtyMaxX;
+    int _dirtyMaxY;
+    std::vector<unsigned char> _uploadBuffer;
+    unsigned int _textureRevision;
+    std::unordered_set<char32_t> _pendingGlyphs;
+    unsigned int _glyphRevision;
+    unsigned int _glyphGeneration;
     int _letterPadding;
     int _letterEdgeExtend;
 
     int _fontAscender;
     EventListenerCustom* _rendererRecreatedListener;
     bool _antialiasEnabled;
-    int _currLineHeight;
 
     friend class Label;
 };
@@ -34,6 +34,8 @@
 NS_CC_BEGIN
 
 std::unordered_map<std::string, FontAtlas *> FontAtlasCache::_atlasMap;
+bool FontAtlasCache::_shareDistanceFieldAtlases = false;
+float FontAtlasCache::_distanceFieldReferenceSize = 32.0f;
 #define ATLAS_MAP_KEY_BUFFER 255
 
 void FontAtlasCache::purgeCachedData()
@@ -58,9 +60,16 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
         useDistanceField = false;
     }
 
+    // Distance fields scale well, so every size can be drawn from one atlas rasterized at the reference size
+    float fontSize = config->fontSize;
+    if (useDistanceField && _shareDistanceFieldAtlases)
+    {
+        fontSize = _distanceFieldReferenceSize;
+    }
+
     char tmp[ATLAS_MAP_KEY_BUFFER];
     if (useDistanceField) {
-        snprintf(tmp, ATLAS_MAP_KEY_BUFFER, "df %.2f %d %s", config->fontSize, config->outlineSize,
+        snprintf(tmp, ATLAS_MAP_KEY_BUFFER, "df %.2f %d %s", fontSize, config->outlineSize,
                  realFontFilename.c_str());
     } else {
         snprintf(tmp, ATLAS_MAP_KEY_BUFFER, "%.2f %d %s", config->fontSize, config->outlineSize,
@@ -72,7 +81,7 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 
     if ( it == _atlasMap.end() )
     {
-        auto font = FontFreeType::create(realFontFilename, config->fontSize, config->glyphs,
+        auto font = FontFreeType::create(realFontFilename, fontSize, config->glyphs,
             config->customGlyphs, useDistanceField, config->outlineSize);
         if (font)
         {
@@ -90,6 +99,27 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     return nullptr;
 }
 
+void FontAtlasCache::setDistanceFieldAtlasSharingEnabled(bool enabled)
+{
+    _shareDistanceFieldAtlases = enabled;
+}
+
+bool FontAtlasCache::isDistanceFieldAtlasSharingEnabled()
+{
+    return _shareDistanceFieldAtlases;
+}
+
+void FontAtlasCache::setDistanceFieldReferenceSize(float fontSize)
+{
+    CCASSERT(fontSize > 0.0f, "Invalid reference font size");
+    _distanceFieldReferenceSize = fontSize;
+}
+
+float FontAtlasCache::getDistanceFieldReferenceSize()
+{
+    return _distanceFieldReferenceSize;
+}
+
 bool FontAtlasCache::releaseFontAtlas(FontAtlas *atlas)
 {
     if (nullptr != atlas)
@@ -42,6 +42,17 @@ class CC_DLL FontAtlasCache
 {  
 public:
     static FontAtlas* getFontAtlasTTF(const _ttfConfig* config);
+
+    /**
+     * Sets whether distance field configs of the same font file share one atlas, rasterized at the reference font size.
+     * Labels scale the shared glyphs to their own font size. Only affects atlases requested afterwards. Disabled by default.
+     */
+    static void setDistanceFieldAtlasSharingEnabled(bool enabled);
+    static bool isDistanceFieldAtlasSharingEnabled();
+
+    /** Sets the font size shared distance field atlases are rasterized at. Defaults to 32. */
+    static void setDistanceFieldReferenceSize(float fontSize);
+    static float getDistanceFieldReferenceSize();
     
     static bool releaseFontAtlas(FontAtlas *atlas);
 
@@ -57,6 +68,8 @@ public:
 
 private:
     static std::unordered_map<std::string, FontAtlas *> _atlasMap;
+    static bool _shareDistanceFieldAtlases;
+    static float _distanceFieldReferenceSize;
 };
 
 NS_CC_END
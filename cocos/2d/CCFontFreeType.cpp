@@ -26,11 +26,14 @@ THE SOFTWARE.
 
 #include "2d/CCFontFreeType.h"
 #include FT_BBOX_H
-#include "edtaa3func.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
 #include "2d/CCFontAtlas.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 
 NS_CC_BEGIN
 
@@ -42,13 +45,113 @@ const int  FontFreeType::DistanceMapSpread = 3;
 const char* FontFreeType::_glyphASCII = "\"!#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~¡¢£¤¥¦§¨©ª«¬­®¯°±²³´µ¶·¸¹º»¼½¾¿ÀÁÂÃÄÅÆÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖ×ØÙÚÛÜÝÞßàáâãäåæçèéêëìíîïðñòóôõö÷øùúûüýþ ";
 const char* FontFreeType::_glyphNEHE = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ ";
 
-typedef struct _DataRef
+struct FontFreeType::SharedFace
 {
+    SharedFace()
+    : bytes(nullptr)
+    , size(0)
+    , face(nullptr)
+    , workerFace(nullptr)
+    , encoding(FT_ENCODING_UNICODE)
+    , referenceCount(0)
+    {
+    }
+
+    bool open(FT_Library library, const std::string& fontName);
+    void close();
+
+    // Exactly one of these holds the font bytes
+    MappedFile mappedFile;
     Data data;
+    const unsigned char* bytes;
+    ssize_t size;
+
+    FT_Face face;
+    // Created by the glyph worker thread on first use, guarded by s_workerMutex
+    FT_Face workerFace;
+    FT_Encoding encoding;
     unsigned int referenceCount;
-}DataRef;
+};
+
+// Node based, so the SharedFace pointers held by fonts stay valid while other fonts are added
+static std::unordered_map<std::string, FontFreeType::SharedFace> s_cacheFontData;
+
+// FreeType objects are not thread safe, so the glyph worker thread rasterizes with its own library and faces
+static FT_Library s_workerLibrary = nullptr;
+static std::mutex s_workerMutex;
+
+bool FontFreeType::SharedFace::open(FT_Library library, const std::string& fontName)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(fontName);
+
+    // Fonts on disk are mapped, so only the tables FreeType actually reads are paged in. Fonts inside archives or packages are read instead.
+    if (!fullPath.empty() && mappedFile.open(fullPath))
+    {
+        bytes = mappedFile.getBytes();
+        size = mappedFile.getSize();
+    }
+    else
+    {
+        data = FileUtils::getInstance()->getDataFromFile(fontName);
+
+        if (data.isNull())
+        {
+            return false;
+        }
+
+        bytes = data.getBytes();
+        size = data.getSize();
+    }
+
+    if (FT_New_Memory_Face(library, bytes, size, 0, &face))
+    {
+        face = nullptr;
+        return false;
+    }
+
+    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE))
+    {
+        int foundIndex = -1;
+        for (int charmapIndex = 0; charmapIndex < face->num_charmaps; charmapIndex++)
+        {
+            if (face->charmaps[charmapIndex]->encoding != FT_ENCODING_NONE)
+            {
+                foundIndex = charmapIndex;
+                break;
+            }
+        }
 
-static std::unordered_map<std::string, DataRef> s_cacheFontData;
+        if (foundIndex == -1 || FT_Select_Charmap(face, face->charmaps[foundIndex]->encoding))
+        {
+            FT_Done_Face(face);
+            face = nullptr;
+            return false;
+        }
+
+        encoding = face->charmaps[foundIndex]->encoding;
+    }
+
+    return true;
+}
+
+void FontFreeType::SharedFace::close()
+{
+    if (_FTInitialized && face != nullptr)
+    {
+        FT_Done_Face(face);
+    }
+
+    face = nullptr;
+
+    std::lock_guard<std::mutex> lock(s_workerMutex);
+
+    if (s_workerLibrary != nullptr && workerFace != nullptr)
+    {
+        FT_Done_Face(workerFace);
+    }
+
+    workerFace = nullptr;
+}
 
 FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, CGlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,float outline /* = 0 */)
 {
@@ -90,6 +193,14 @@ void FontFreeType::shutdownFreeType()
         s_cacheFontData.clear();
         _FTInitialized = false;
     }
+
+    std::lock_guard<std::mutex> lock(s_workerMutex);
+
+    if (s_workerLibrary != nullptr)
+    {
+        FT_Done_FreeType(s_workerLibrary);
+        s_workerLibrary = nullptr;
+    }
 }
 
 FT_Library FontFreeType::getFTLibrary()
@@ -100,12 +211,19 @@ FT_Library FontFreeType::getFTLibrary()
 
 FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outline /* = 0 */)
 : _fontRef(nullptr)
+, _sizeRef(nullptr)
 , _stroker(nullptr)
 , _distanceFieldEnabled(distanceFieldEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
 , _fontAtlas(nullptr)
 , _encoding(FT_ENCODING_UNICODE)
+, _fontSize(0.0f)
+, _fontSizePoints(0)
+, _sharedFace(nullptr)
+, _workerFontRef(nullptr)
+, _workerSizeRef(nullptr)
+, _workerStroker(nullptr)
 , _usedGlyphs(CGlyphCollection::ASCII)
 {
     if (outline > 0.0f)
@@ -122,62 +240,44 @@ FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outlin
 
 bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
 {
-    FT_Face face;
     // save font name locally
     _fontName = fontName;
 
     auto it = s_cacheFontData.find(fontName);
-    if (it != s_cacheFontData.end())
-    {
-        (*it).second.referenceCount += 1;
-    }
-    else
+    if (it == s_cacheFontData.end())
     {
-        s_cacheFontData[fontName].referenceCount = 1;
-        s_cacheFontData[fontName].data = FileUtils::getInstance()->getDataFromFile(fontName);    
+        it = s_cacheFontData.emplace(fontName, SharedFace()).first;
 
-        if (s_cacheFontData[fontName].data.isNull())
+        if (!it->second.open(getFTLibrary(), fontName))
         {
+            it->second.close();
+            s_cacheFontData.erase(it);
             return false;
         }
     }
 
-    if (FT_New_Memory_Face(getFTLibrary(), s_cacheFontData[fontName].data.getBytes(), s_cacheFontData[fontName].data.getSize(), 0, &face ))
-        return false;
+    _sharedFace = &it->second;
+    _sharedFace->referenceCount += 1;
+    _fontRef = _sharedFace->face;
+    _encoding = _sharedFace->encoding;
 
-    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE))
+    // The face is shared by every size of the font file, each font keeps its own size object
+    if (FT_New_Size(_fontRef, &_sizeRef))
     {
-        int foundIndex = -1;
-        for (int charmapIndex = 0; charmapIndex < face->num_charmaps; charmapIndex++)
-        {
-            if (face->charmaps[charmapIndex]->encoding != FT_ENCODING_NONE)
-            {
-                foundIndex = charmapIndex;
-                break;
-            }
-        }
-
-        if (foundIndex == -1)
-        {
-            return false;
-        }
-
-        _encoding = face->charmaps[foundIndex]->encoding;
-        if (FT_Select_Charmap(face, _encoding))
-        {
-            return false;
-        }
+        _sizeRef = nullptr;
+        return false;
     }
 
+    activateSize();
+
     // set the requested font size
     int dpi = 72;
-    int fontSizePoints = (int)(64.f * fontSize * CC_CONTENT_SCALE_FACTOR());
-    if (FT_Set_Char_Size(face, fontSizePoints, fontSizePoints, dpi, dpi))
+    _fontSize = fontSize;
+    _fontSizePoints = (int)(64.f * fontSize * CC_CONTENT_SCALE_FACTOR());
+    if (FT_Set_Char_Size(_fontRef, _fontSizePoints, _fontSizePoints, dpi, dpi))
         return false;
     
-    // store the face globally
-    _fontRef = face;
-    _lineHeight = static_cast<int>((_fontRef->size->metrics.ascender - _fontRef->size->metrics.descender) >> 6);
+    _lineHeight = static_cast<int>((_sizeRef->metrics.ascender - _sizeRef->metrics.descender) >> 6);
     
     // done and good
     return true;
@@ -191,23 +291,49 @@ FontFreeType::~FontFreeType()
         {
             FT_Stroker_Done(_stroker);
         }
-        if (_fontRef)
+        if (_sizeRef)
+        {
+            FT_Done_Size(_sizeRef);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_workerMutex);
+
+        if (s_workerLibrary != nullptr)
         {
-            FT_Done_Face(_fontRef);
+            if (_workerStroker)
+            {
+                FT_Stroker_Done(_workerStroker);
+            }
+            if (_workerSizeRef)
+            {
+                FT_Done_Size(_workerSizeRef);
+            }
         }
     }
 
+    // The entry may belong to a newer FreeType instance if FreeType was shut down since this font was created
     auto iter = s_cacheFontData.find(_fontName);
-    if (iter != s_cacheFontData.end())
+    if (iter != s_cacheFontData.end() && &iter->second == _sharedFace)
     {
         iter->second.referenceCount -= 1;
         if (iter->second.referenceCount == 0)
         {
+            iter->second.close();
             s_cacheFontData.erase(iter);
         }
     }
 }
 
+void FontFreeType::activateSize() const
+{
+    if (_fontRef->size != _sizeRef)
+    {
+        FT_Activate_Size(_sizeRef);
+    }
+}
+
 FontAtlas * FontFreeType::createFontAtlas()
 {
     if (_fontAtlas == nullptr)
@@ -242,6 +368,8 @@ int * FontFreeType::getHorizontalKerningForTextUTF32(const std::u32string& text,
         return nullptr;
     memset(sizes,0,outNumLetters * sizeof(int));
 
+    activateSize();
+
     bool hasKerning = FT_HAS_KERNING( _fontRef ) != 0;
     if (hasKerning)
     {
@@ -278,7 +406,7 @@ int  FontFreeType::getHorizontalKerningForChars(uint64_t firstChar, uint64_t sec
 
 int FontFreeType::getFontAscender() const
 {
-    return (static_cast<int>(_fontRef->size->metrics.ascender >> 6));
+    return (static_cast<int>(_sizeRef->metrics.ascender >> 6));
 }
 
 const char* FontFreeType::getFontFamily() const
@@ -290,37 +418,153 @@ const char* FontFreeType::getFontFamily() const
 }
 
 unsigned char* FontFreeType::getGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, CRect &outRect,int &xAdvance)
+{
+    activateSize();
+
+    return renderGlyph(_FTlibrary, _fontRef, _stroker, theChar, outWidth, outHeight, outRect, xAdvance);
+}
+
+bool FontFreeType::initWorkerFace()
+{
+    if (_workerSizeRef != nullptr)
+    {
+        return true;
+    }
+
+    if (s_workerLibrary == nullptr && FT_Init_FreeType(&s_workerLibrary))
+    {
+        s_workerLibrary = nullptr;
+        return false;
+    }
+
+    if (_sharedFace == nullptr)
+    {
+        return false;
+    }
+
+    // The worker face reads the same font bytes as the main face, and is shared by every size of the font file
+    if (_sharedFace->workerFace == nullptr)
+    {
+        if (FT_New_Memory_Face(s_workerLibrary, _sharedFace->bytes, _sharedFace->size, 0, &_sharedFace->workerFace))
+        {
+            _sharedFace->workerFace = nullptr;
+            return false;
+        }
+
+        if (FT_Select_Charmap(_sharedFace->workerFace, _encoding))
+        {
+            FT_Done_Face(_sharedFace->workerFace);
+            _sharedFace->workerFace = nullptr;
+            return false;
+        }
+    }
+
+    _workerFontRef = _sharedFace->workerFace;
+
+    if (FT_New_Size(_workerFontRef, &_workerSizeRef))
+    {
+        _workerSizeRef = nullptr;
+        return false;
+    }
+
+    int dpi = 72;
+    FT_Activate_Size(_workerSizeRef);
+    if (FT_Set_Char_Size(_workerFontRef, _fontSizePoints, _fontSizePoints, dpi, dpi))
+    {
+        FT_Done_Size(_workerSizeRef);
+        _workerSizeRef = nullptr;
+        return false;
+    }
+
+    if (_outlineSize > 0.0f)
+    {
+        FT_Stroker_New(s_workerLibrary, &_workerStroker);
+        FT_Stroker_Set(_workerStroker,
+            (int)(_outlineSize * 64),
+            FT_STROKER_LINECAP_ROUND,
+            FT_STROKER_LINEJOIN_ROUND,
+            0);
+    }
+
+    return true;
+}
+
+bool FontFreeType::rasterizeGlyph(uint64_t theChar, FontGlyphBitmap& outGlyph)
+{
+    std::lock_guard<std::mutex> lock(s_workerMutex);
+
+    outGlyph.width = 0;
+    outGlyph.height = 0;
+    outGlyph.bitmapHeight = 0;
+    outGlyph.pixels.clear();
+
+    if (!initWorkerFace())
+    {
+        outGlyph.rect = CRect::ZERO;
+        outGlyph.xAdvance = 0;
+        return false;
+    }
+
+    if (_workerFontRef->size != _workerSizeRef)
+    {
+        FT_Activate_Size(_workerSizeRef);
+    }
+
+    long bitmapWidth = 0;
+    long bitmapHeight = 0;
+    auto bitmap = renderGlyph(s_workerLibrary, _workerFontRef, _workerStroker, theChar, bitmapWidth, bitmapHeight, outGlyph.rect, outGlyph.xAdvance);
+
+    if (bitmap == nullptr || bitmapWidth <= 0 || bitmapHeight <= 0)
+    {
+        return bitmap != nullptr || outGlyph.xAdvance != 0;
+    }
+
+    int spread = _distanceFieldEnabled ? 2 * DistanceMapSpread : 0;
+    int bytesPerPixel = _outlineSize > 0 ? 2 : 1;
+
+    outGlyph.bitmapHeight = bitmapHeight;
+    outGlyph.width = static_cast<int>(bitmapWidth) + spread;
+    outGlyph.height = static_cast<int>(bitmapHeight) + spread;
+    outGlyph.pixels.resize(outGlyph.width * outGlyph.height * bytesPerPixel);
+
+    // Releases the outline bitmap, the plain one belongs to the face
+    renderCharAt(outGlyph.pixels.data(), 0, 0, bitmap, bitmapWidth, bitmapHeight, outGlyph.width);
+
+    return true;
+}
+
+unsigned char* FontFreeType::renderGlyph(FT_Library library, FT_Face face, FT_Stroker stroker, uint64_t theChar, long &outWidth, long &outHeight, CRect &outRect, int &xAdvance)
 {
     bool invalidChar = true;
     unsigned char* ret = nullptr;
 
     do
     {
-        if (_fontRef == nullptr)
+        if (face == nullptr)
             break;
 
         if (_distanceFieldEnabled)
         {
-            if (FT_Load_Char(_fontRef, theChar, FT_LOAD_RENDER | FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT))
+            if (FT_Load_Char(face, theChar, FT_LOAD_RENDER | FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT))
                 break;
         }
         else
         {
-            if (FT_Load_Char(_fontRef, theChar, FT_LOAD_RENDER | FT_LOAD_NO_AUTOHINT))
+            if (FT_Load_Char(face, theChar, FT_LOAD_RENDER | FT_LOAD_NO_AUTOHINT))
                 break;
         }
 
-        auto& metrics = _fontRef->glyph->metrics;
+        auto& metrics = face->glyph->metrics;
         outRect.origin.x = metrics.horiBearingX >> 6;
         outRect.origin.y = -(metrics.horiBearingY >> 6);
         outRect.size.width = (metrics.width >> 6);
         outRect.size.height = (metrics.height >> 6);
 
-        xAdvance = (static_cast<int>(_fontRef->glyph->metrics.horiAdvance >> 6));
+        xAdvance = (static_cast<int>(face->glyph->metrics.horiAdvance >> 6));
 
-        outWidth  = _fontRef->glyph->bitmap.width;
-        outHeight = _fontRef->glyph->bitmap.rows;
-        ret = _fontRef->glyph->bitmap.buffer;
+        outWidth  = face->glyph->bitmap.width;
+        outHeight = face->glyph->bitmap.rows;
+        ret = face->glyph->bitmap.buffer;
 
         if (_outlineSize > 0 && outWidth > 0 && outHeight > 0)
         {
@@ -328,7 +572,7 @@ unsigned char* FontFreeType::getGlyphBitmap(uint64_t theChar, long &outWidth, lo
             memcpy(copyBitmap,ret,outWidth * outHeight * sizeof(unsigned char));
 
             FT_BBox bbox;
-            auto outlineBitmap = getGlyphBitmapWithOutline(theChar,bbox);
+            auto outlineBitmap = getGlyphBitmapWithOutline(library, face, stroker, theChar, bbox);
             if(outlineBitmap == nullptr)
             {
                 ret = nullptr;
@@ -415,17 +659,17 @@ unsigned char* FontFreeType::getGlyphBitmap(uint64_t theChar, long &outWidth, lo
     }
 }
 
-unsigned char * FontFreeType::getGlyphBitmapWithOutline(uint64_t theChar, FT_BBox &bbox)
+unsigned char * FontFreeType::getGlyphBitmapWithOutline(FT_Library library, FT_Face face, FT_Stroker stroker, uint64_t theChar, FT_BBox &bbox)
 {   
     unsigned char* ret = nullptr;
-    if (FT_Load_Char(_fontRef, theChar, FT_LOAD_NO_BITMAP) == 0)
+    if (FT_Load_Char(face, theChar, FT_LOAD_NO_BITMAP) == 0)
     {
-        if (_fontRef->glyph->format == FT_GLYPH_FORMAT_OUTLINE)
+        if (face->glyph->format == FT_GLYPH_FORMAT_OUTLINE)
         {
             FT_Glyph glyph;
-            if (FT_Get_Glyph(_fontRef->glyph, &glyph) == 0)
+            if (FT_Get_Glyph(face->glyph, &glyph) == 0)
             {
-                FT_Glyph_StrokeBorder(&glyph, _stroker, 0, 1);
+                FT_Glyph_StrokeBorder(&glyph, stroker, 0, 1);
                 if (glyph->format == FT_GLYPH_FORMAT_OUTLINE)
                 {
                     FT_Outline *outline = &reinterpret_cast<FT_OutlineGlyph>(glyph)->outline;
@@ -448,7 +692,7 @@ unsigned char * FontFreeType::getGlyphBitmapWithOutline(uint64_t theChar, FT_BBo
                     params.target = &bmp;
                     params.flags = FT_RASTER_FLAG_AA;
                     FT_Outline_Translate(outline,-bbox.xMin,-bbox.yMin);
-                    FT_Outline_Render(_FTlibrary, outline, &params);
+                    FT_Outline_Render(library, outline, &params);
 
                     ret = bmp.buffer;
                 }
@@ -460,122 +704,165 @@ unsigned char * FontFreeType::getGlyphBitmapWithOutline(uint64_t theChar, FT_BBo
     return ret;
 }
 
-unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
+namespace
 {
-    long pixelAmount = (width + 2 * FontFreeType::DistanceMapSpread) * (height + 2 * FontFreeType::DistanceMapSpread);
-
-    short * xdist = (short *)  malloc( pixelAmount * sizeof(short) );
-    short * ydist = (short *)  malloc( pixelAmount * sizeof(short) );
-    double * gx   = (double *) calloc( pixelAmount, sizeof(double) );
-    double * gy      = (double *) calloc( pixelAmount, sizeof(double) );
-    double * data    = (double *) calloc( pixelAmount, sizeof(double) );
-    double * outside = (double *) calloc( pixelAmount, sizeof(double) );
-    double * inside  = (double *) calloc( pixelAmount, sizeof(double) );
-    long i,j;
-
-    // Convert img into double (data) rescale image levels between 0 and 1
-    long outWidth = width + 2 * FontFreeType::DistanceMapSpread;
-    for (i = 0; i < width; ++i)
-    {
-        for (j = 0; j < height; ++j)
+    const float DistanceFieldInfinity = 1e20f;
+
+    // Glyphs are rendered on both the main thread and the glyph worker thread, so each thread reuses its own buffers
+    struct DistanceFieldScratch
+    {
+        std::vector<float> outside;
+        std::vector<float> inside;
+        std::vector<float> line;
+        std::vector<float> boundaries;
+        std::vector<int> parabolas;
+    };
+
+    thread_local DistanceFieldScratch s_distanceFieldScratch;
+
+    // Felzenszwalb-Huttenlocher 1D squared distance transform of grid[offset + i * stride] for i < length, in linear time
+    void distanceTransform1D(float* grid, int offset, int stride, int length, float* line, float* boundaries, int* parabolas)
+    {
+        parabolas[0] = 0;
+        boundaries[0] = -DistanceFieldInfinity;
+        boundaries[1] = DistanceFieldInfinity;
+        line[0] = grid[offset];
+
+        // Lower envelope of the parabolas rooted at each sample
+        for (int q = 1, k = 0; q < length; q++)
         {
-            data[j * outWidth + FontFreeType::DistanceMapSpread + i] = img[j * width + i] / 255.0;
+            line[q] = grid[offset + q * stride];
+
+            float intersection;
+
+            do
+            {
+                int r = parabolas[k];
+                intersection = (line[q] - line[r] + float(q * q - r * r)) / float(2 * (q - r));
+            } while (intersection <= boundaries[k] && --k > -1);
+
+            k++;
+            parabolas[k] = q;
+            boundaries[k] = intersection;
+            boundaries[k + 1] = DistanceFieldInfinity;
+        }
+
+        for (int q = 0, k = 0; q < length; q++)
+        {
+            while (boundaries[k + 1] < q)
+            {
+                k++;
+            }
+
+            int r = parabolas[k];
+            grid[offset + q * stride] = line[r] + float((q - r) * (q - r));
         }
     }
 
-    width += 2 * FontFreeType::DistanceMapSpread;
-    height += 2 * FontFreeType::DistanceMapSpread;
-
-    // Transform background (outside contour, in areas of 0's)   
-    computegradient( data, (int)width, (int)height, gx, gy);
-    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, outside);
-    for( i=0; i< pixelAmount; i++)
-        if( outside[i] < 0.0 )
-            outside[i] = 0.0;
-
-    // Transform foreground (inside contour, in areas of 1's)   
-    for( i=0; i< pixelAmount; i++)
-        data[i] = 1 - data[i];
-    computegradient( data, (int)width, (int)height, gx, gy);
-    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, inside);
-    for( i=0; i< pixelAmount; i++)
-        if( inside[i] < 0.0 )
-            inside[i] = 0.0;
-
-    // The bipolar distance field is now outside-inside
-    double dist;
-    /* Single channel 8-bit output (bad precision and range, but simple) */    
-    unsigned char *out = (unsigned char *) malloc( pixelAmount * sizeof(unsigned char) );
-    for( i=0; i < pixelAmount; i++)
-    {
-        dist = outside[i] - inside[i];
-        dist = 128.0 - dist*16;
-        if( dist < 0 ) dist = 0;
-        if( dist > 255 ) dist = 255;
-        out[i] = (unsigned char) dist;
-    }
-    /* Dual channel 16-bit output (more complicated, but good precision and range) */
-    /*unsigned char *out = (unsigned char *) malloc( pixelAmount * 3 * sizeof(unsigned char) ); 
-    for( i=0; i< pixelAmount; i++)
-    {
-        dist = outside[i] - inside[i];
-        dist = 128.0 - dist*16;
-        if( dist < 0.0 ) dist = 0.0;
-        if( dist >= 256.0 ) dist = 255.999;
-        // R channel is a copy of the original grayscale image
-        out[3*i] = img[i];
-        // G channel is fraction
-        out[3*i + 1] = (unsigned char) ( 256 - (dist - floor(dist)* 256.0 ));
-        // B channel is truncated integer part
-        out[3*i + 2] = (unsigned char)dist; 
-    }*/
-    
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
-    free( data );
-    free( outside );
-    free( inside );
-
-    return out;
+    void distanceTransform2D(float* grid, int width, int height, DistanceFieldScratch& scratch)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            distanceTransform1D(grid, x, width, height, scratch.line.data(), scratch.boundaries.data(), scratch.parabolas.data());
+        }
+
+        for (int y = 0; y < height; y++)
+        {
+            distanceTransform1D(grid, y * width, 1, width, scratch.line.data(), scratch.boundaries.data(), scratch.parabolas.data());
+        }
+    }
 }
 
-void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
+/**
+ * Writes the signed distance field of an 8-bit coverage bitmap, padded by DistanceMapSpread on every side, into dest.
+ * Partially covered pixels seed the transforms with their sub-pixel distance to the 50% coverage edge, which keeps
+ * antialiased outlines smooth with a single exact pass per axis.
+ */
+static void makeDistanceMap(const unsigned char* img, long width, long height, unsigned char* dest, int destWidth)
 {
-    int iX = posX;
-    int iY = posY;
+    int spread = FontFreeType::DistanceMapSpread;
+    int outWidth = static_cast<int>(width) + 2 * spread;
+    int outHeight = static_cast<int>(height) + 2 * spread;
+    int pixelAmount = outWidth * outHeight;
+    int longestSide = std::max(outWidth, outHeight);
 
-    if (_distanceFieldEnabled)
+    auto& scratch = s_distanceFieldScratch;
+
+    if (static_cast<int>(scratch.outside.size()) < pixelAmount)
     {
-        auto distanceMap = makeDistanceMap(bitmap,bitmapWidth,bitmapHeight);
+        scratch.outside.resize(pixelAmount);
+        scratch.inside.resize(pixelAmount);
+    }
 
-        bitmapWidth += 2 * DistanceMapSpread;
-        bitmapHeight += 2 * DistanceMapSpread;
+    if (static_cast<int>(scratch.line.size()) < longestSide)
+    {
+        scratch.line.resize(longestSide);
+        scratch.boundaries.resize(longestSide + 1);
+        scratch.parabolas.resize(longestSide);
+    }
 
-        for (long y = 0; y < bitmapHeight; ++y)
-        {
-            long bitmap_y = y * bitmapWidth;
+    float* outside = scratch.outside.data();
+    float* inside = scratch.inside.data();
 
-            for (long x = 0; x < bitmapWidth; ++x)
-            {    
-                /* Dual channel 16-bit output (more complicated, but good precision and range) */
-                /*int index = (iX + ( iY * destSize )) * 3;                
-                int index2 = (bitmap_y + x)*3;
-                dest[index] = out[index2];
-                dest[index + 1] = out[index2 + 1];
-                dest[index + 2] = out[index2 + 2];*/
+    // The padding is background: infinitely far from the glyph, right on the background
+    std::fill(outside, outside + pixelAmount, DistanceFieldInfinity);
+    std::fill(inside, inside + pixelAmount, 0.0f);
 
-                //Single channel 8-bit output 
-                dest[iX + ( iY * FontAtlas::CacheTextureWidth )] = distanceMap[bitmap_y + x];
+    for (long y = 0; y < height; y++)
+    {
+        const unsigned char* row = img + y * width;
+        float* outsideRow = outside + (y + spread) * outWidth + spread;
+        float* insideRow = inside + (y + spread) * outWidth + spread;
 
-                iX += 1;
+        for (long x = 0; x < width; x++)
+        {
+            unsigned char coverage = row[x];
+
+            if (coverage == 255)
+            {
+                outsideRow[x] = 0.0f;
+                insideRow[x] = DistanceFieldInfinity;
             }
+            else if (coverage != 0)
+            {
+                float edge = 0.5f - coverage / 255.0f;
+                outsideRow[x] = edge > 0.0f ? edge * edge : 0.0f;
+                insideRow[x] = edge < 0.0f ? edge * edge : 0.0f;
+            }
+        }
+    }
 
-            iX  = posX;
-            iY += 1;
+    distanceTransform2D(outside, outWidth, outHeight, scratch);
+    distanceTransform2D(inside, outWidth, outHeight, scratch);
+
+    // The bipolar distance field is outside - inside, stored as single channel 8-bit (128 at the edge, 16 levels per pixel)
+    for (int y = 0; y < outHeight; y++)
+    {
+        const float* outsideRow = outside + y * outWidth;
+        const float* insideRow = inside + y * outWidth;
+        unsigned char* destRow = dest + y * destWidth;
+
+        for (int x = 0; x < outWidth; x++)
+        {
+            float dist = 128.0f - (std::sqrt(outsideRow[x]) - std::sqrt(insideRow[x])) * 16.0f;
+            destRow[x] = static_cast<unsigned char>(std::min(std::max(dist, 0.0f), 255.0f));
         }
-        free(distanceMap);
+    }
+}
+
+void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
+{
+    renderCharAt(dest, posX, posY, bitmap, bitmapWidth, bitmapHeight, FontAtlas::CacheTextureWidth);
+}
+
+void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight,int destWidth)
+{
+    int iX = posX;
+    int iY = posY;
+
+    if (_distanceFieldEnabled)
+    {
+        makeDistanceMap(bitmap, bitmapWidth, bitmapHeight, dest + iX + iY * destWidth, destWidth);
     }
     else if(_outlineSize > 0)
     {
@@ -587,9 +874,9 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
             for (int x = 0; x < bitmapWidth; ++x)
             {
                 tempChar = bitmap[(bitmap_y + x) * 2];
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) ) * 2] = tempChar;
+                dest[(iX + ( iY * destWidth ) ) * 2] = tempChar;
                 tempChar = bitmap[(bitmap_y + x) * 2 + 1];
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) ) * 2 + 1] = tempChar;
+                dest[(iX + ( iY * destWidth ) ) * 2 + 1] = tempChar;
 
                 iX += 1;
             }
@@ -610,7 +897,7 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
                 unsigned char cTemp = bitmap[bitmap_y + x];
 
                 // the final pixel
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) )] = cTemp;
+                dest[(iX + ( iY * destWidth ) )] = cTemp;
 
                 iX += 1;
             }
@@ -658,8 +945,12 @@ void FontFreeType::releaseFont(const std::string &fontName)
     auto item = s_cacheFontData.begin();
     while (s_cacheFontData.end() != item)
     {
-        if (item->first.find(fontName) != std::string::npos)
+        // Faces still used by a font are shared with it, they are released along with the last font using them
+        if (item->first.find(fontName) != std::string::npos && item->second.referenceCount == 0)
+        {
+            item->second.close();
             item = s_cacheFontData.erase(item);
+        }
         else
             item++;
     }
@@ -32,13 +32,29 @@
 #include "2d/CCFont.h"
 
 #include <string>
+#include <vector>
 #include <ft2build.h>
 
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 #include FT_STROKER_H
 
 NS_CC_BEGIN
 
+/** A glyph rasterized off the main thread, already laid out the way FontAtlas stores it (distance field and outline applied). */
+struct FontGlyphBitmap
+{
+    unsigned int charCode;
+    CRect rect;
+    int xAdvance;
+    /** Height of the glyph bitmap before any distance field padding, used to size the atlas slot. */
+    long bitmapHeight;
+    int width;
+    int height;
+    /** width * height texels, 2 bytes each for outlined fonts. Empty for glyphs without a bitmap, such as spaces. */
+    std::vector<unsigned char> pixels;
+};
+
 class CC_DLL FontFreeType : public Font
 {
 public:
@@ -53,13 +69,25 @@ public:
 
     float getOutlineSize() const { return _outlineSize; }
 
+    /** Gets the size the font was created at, in points. */
+    float getFontSize() const { return _fontSize; }
+
     void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
+    /** Same as above, for a destination page that is destWidth pixels wide. */
+    void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight,int destWidth);
 
     FT_Encoding getEncoding() const { return _encoding; }
 
     int* getHorizontalKerningForTextUTF32(const std::u32string& text, int &outNumLetters) const override;
     
     unsigned char* getGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, CRect &outRect,int &xAdvance);
+
+    /**
+     * Rasterizes a glyph into a self contained bitmap using a second face that belongs to the glyph worker thread,
+     * so it can run while the main thread keeps using this font. The worker face is shared by every size of the font file.
+     * @return False if the glyph could not be loaded.
+     */
+    bool rasterizeGlyph(uint64_t theChar, FontGlyphBitmap& outGlyph);
     
     int getFontAscender() const;
     const char* getFontFamily() const;
@@ -69,6 +97,9 @@ public:
 
     static void releaseFont(const std::string &fontName);
 
+    /** The font file bytes and the faces reading them, shared by every FontFreeType created from the same file. */
+    struct SharedFace;
+
 private:
     static const char* _glyphASCII;
     static const char* _glyphNEHE;
@@ -84,14 +115,30 @@ private:
     FT_Library getFTLibrary();
     
     int getHorizontalKerningForChars(uint64_t firstChar, uint64_t secondChar) const;
-    unsigned char* getGlyphBitmapWithOutline(uint64_t code, FT_BBox &bbox);
+    unsigned char* renderGlyph(FT_Library library, FT_Face face, FT_Stroker stroker, uint64_t theChar, long &outWidth, long &outHeight, CRect &outRect, int &xAdvance);
+    unsigned char* getGlyphBitmapWithOutline(FT_Library library, FT_Face face, FT_Stroker stroker, uint64_t code, FT_BBox &bbox);
+
+    bool initWorkerFace();
+
+    /** Makes the size of this font the active size of the shared face. */
+    void activateSize() const;
 
     void setGlyphCollection(CGlyphCollection glyphs, const char* customGlyphs = nullptr);
     const char* getGlyphCollection() const;
     
+    // Shared with the other sizes of the font file, _sizeRef holds the metrics of this one
     FT_Face _fontRef;
+    FT_Size _sizeRef;
     FT_Stroker _stroker;
     FT_Encoding _encoding;
+    float _fontSize;
+    int _fontSizePoints;
+    SharedFace* _sharedFace;
+
+    // Owned by the glyph worker thread, created on first use
+    FT_Face _workerFontRef;
+    FT_Size _workerSizeRef;
+    FT_Stroker _workerStroker;
 
     std::string _fontName;
     bool _distanceFieldEnabled;
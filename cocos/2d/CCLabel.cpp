@@ -27,6 +27,8 @@
 #include "2d/CCLabel.h"
 
 #include <algorithm>
+#include <list>
+#include <unordered_map>
 
 #include "2d/CCCamera.h"
 #include "2d/CCDrawNode.h"
@@ -47,6 +49,9 @@
 
 NS_CC_BEGIN
 
+// Half width of the antialiased edge of distance field text, in distance units, at a font scale of 1
+static const float DistanceFieldSmoothing = 0.04f;
+
 /**
  * LabelLetter used to update the quad in texture atlas without SpriteBatchNode.
  */
@@ -260,9 +265,13 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
 : _textSprite(nullptr)
 , _shadowNode(nullptr)
 , _fontAtlas(nullptr)
-, _purgeTextureListener(nullptr)
+, _fontAtlasRevision(0)
+, _fontAtlasGlyphRevision(0)
+, _fontScale(1.0f)
+, _waitingForGlyphs(false)
 , _reusedLetter(nullptr)
 , _horizontalKernings(nullptr)
+, _purgeTextureListener(nullptr)
 , _boldEnabled(false)
 , _underlineNode(nullptr)
 , _strikethroughEnabled(false)
@@ -305,6 +314,7 @@ void Label::reset()
     _letters.clear();
     _batchNodes.clear();
     _lettersInfo.clear();
+    _layoutState.valid = false;
     if (_fontAtlas)
     {
         FontAtlasCache::releaseFontAtlas(_fontAtlas);
@@ -333,6 +343,7 @@ void Label::reset()
     }
     _additionalKerning = 0.f;
     _lineHeight = 0.f;
+    _fontScale = 1.0f;
     _lineSpacing = 0.f;
     _maxLineWidth = 0.f;
     _labelDimensions.width = 0.f;
@@ -355,6 +366,7 @@ void Label::reset()
     _uniformEffectColor = -1;
     _uniformEffectType = -1;
     _uniformTextColor = -1;
+    _uniformSmoothing = -1;
 
     _useDistanceField = false;
     _useA8Shader = false;
@@ -422,6 +434,7 @@ void Label::updateShaderProgram()
     }
     
     _uniformTextColor = glGetUniformLocation(getGLProgram()->getProgram(), "u_textColor");
+    _uniformSmoothing = _useDistanceField ? glGetUniformLocation(getGLProgram()->getProgram(), "u_smoothing") : -1;
 }
 
 void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false */, bool useA8Shader /* = false */)
@@ -456,8 +469,9 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
 
     if (_fontAtlas)
     {
-        _lineHeight = _fontAtlas->getLineHeight();
+        _lineHeight = _fontAtlas->getLineHeight() * _fontScale;
         _contentDirty = true;
+        invalidateCachedAncestors();
         _systemFontDirty = false;
     }
     _useDistanceField = distanceFieldEnabled;
@@ -482,12 +496,10 @@ void Label::setString(const std::string& text)
     {
         _utf8Text = text;
         _contentDirty = true;
+        invalidateCachedAncestors();
 
-        std::u32string utf32String;
-        if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
-        {
-            _utf32Text  = utf32String;
-        }
+        // Converts in place, reusing the capacity of _utf32Text. It is left unchanged if the text is not valid UTF8.
+        StringUtils::UTF8ToUTF32(_utf8Text, _utf32Text);
     }
 }
 
@@ -499,6 +511,7 @@ void Label::setAlignment(TextHAlignment hAlignment,TextVAlignment vAlignment)
         _vAlignment = vAlignment;
 
         _contentDirty = true;
+        invalidateCachedAncestors();
     }
 }
 
@@ -508,6 +521,7 @@ void Label::setMaxLineWidth(float maxLineWidth)
     {
         _maxLineWidth = maxLineWidth;
         _contentDirty = true;
+        invalidateCachedAncestors();
     }
 }
 
@@ -525,6 +539,7 @@ void Label::setDimensions(float width, float height)
 
         _maxLineWidth = width;
         _contentDirty = true;
+        invalidateCachedAncestors();
 
         if(_overflow == Overflow::SHRINK){
             if (_originalFontSize > 0) {
@@ -551,6 +566,7 @@ void Label::setLineBreakWithoutSpace(bool breakWithoutSpace)
     {
         _lineBreakWithoutSpaces = breakWithoutSpace;
         _contentDirty = true;     
+        invalidateCachedAncestors();
     }
 }
 
@@ -595,8 +611,8 @@ void Label::updateLabelLetters()
                     letterSprite->setAtlasIndex(_lettersInfo[letterIndex].atlasIndex);
                 }
 
-                auto px = letterInfo.positionX + letterDef.width / 2 + _linesOffsetX[letterInfo.lineIndex];
-                auto py = letterInfo.positionY - letterDef.height / 2 + _letterOffsetY;
+                auto px = letterInfo.positionX + letterDef.width * _fontScale / 2 + _linesOffsetX[letterInfo.lineIndex];
+                auto py = letterInfo.positionY - letterDef.height * _fontScale / 2 + _letterOffsetY;
                 letterSprite->setPosition(px, py);
 
                 this->updateLetterSpriteScale(letterSprite);
@@ -610,13 +626,25 @@ bool Label::alignText()
 {
     if (_fontAtlas == nullptr || _utf32Text.empty())
     {
+        _layoutState.valid = false;
         setContentSize(CSize::ZERO);
         return true;
     }
 
     bool ret = true;
     do {
+        // Edits only prepare and lay out the letters of the paragraphs they touch
+        if (updateLettersIncrementally())
+        {
+            break;
+        }
+
+        _layoutState.valid = false;
+
         _fontAtlas->prepareLetterDefinitions(_utf32Text);
+        _fontAtlasRevision = _fontAtlas->getTextureRevision();
+        _fontAtlasGlyphRevision = _fontAtlas->getGlyphRevision();
+        _waitingForGlyphs = _fontAtlas->hasPendingGlyphs();
         auto& textures = _fontAtlas->getTextures();
         auto size = textures.size();
         if (size > static_cast<size_t>(_batchNodes.size()))
@@ -645,19 +673,26 @@ bool Label::alignText()
             _batchNodes.at(0)->reserveCapacity(_utf32Text.size());
 
         _reusedLetter->setBatchNode(_batchNodes.at(0));
-        
-        _lengthOfString = 0;
-        _textDesiredHeight = 0.f;
-        _linesWidth.clear();
-        if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
-        {
-            multilineTextWrapByWord();
-        }
-        else
+
+        if (!restoreCachedLayout())
         {
-            multilineTextWrapByChar();
+            computeHorizontalKernings(_utf32Text);
+
+            _lengthOfString = 0;
+            _textDesiredHeight = 0.f;
+            _linesWidth.clear();
+            if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
+            {
+                multilineTextWrapByWord();
+            }
+            else
+            {
+                multilineTextWrapByChar();
+            }
+            computeAlignmentOffset();
+
+            storeCachedLayout();
         }
-        computeAlignmentOffset();
 
         if(_overflow == Overflow::SHRINK){
             float fontSize = this->getRenderingFontSize();
@@ -678,6 +713,8 @@ bool Label::alignText()
         updateLabelLetters();
         
         updateColor();
+
+        recordLayoutState();
     }while (0);
 
     return ret;
@@ -735,8 +772,8 @@ bool Label::updateQuads()
                 if (py > _tailoredTopY)
                 {
                     auto clipTop = py - _tailoredTopY;
-                    _reusedRect.origin.y += clipTop;
-                    _reusedRect.size.height -= clipTop;
+                    _reusedRect.origin.y += clipTop / _fontScale;
+                    _reusedRect.size.height -= clipTop / _fontScale;
                     py -= clipTop;
                 }
 
@@ -752,14 +789,14 @@ bool Label::updateQuads()
             }
 
             auto lineIndex = _lettersInfo[ctr].lineIndex;
-            auto px = _lettersInfo[ctr].positionX + letterDef.width/2 + _linesOffsetX[lineIndex];
+            auto px = _lettersInfo[ctr].positionX + letterDef.width * _fontScale / 2 + _linesOffsetX[lineIndex];
 
             if(_labelWidth > 0.f){
                 if (this->isHorizontalClamped(px, lineIndex)) {
                     if(_overflow == Overflow::CLAMP){
                         _reusedRect.size.width = 0;
                     }else if(_overflow == Overflow::SHRINK){
-                        if (_contentSize.width > letterDef.width) {
+                        if (_contentSize.width > letterDef.width * _fontScale) {
                             ret = false;
                             break;
                         }else{
@@ -773,15 +810,7 @@ bool Label::updateQuads()
 
             if (_reusedRect.size.height > 0.f && _reusedRect.size.width > 0.f)
             {
-                _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
-                float letterPositionX = _lettersInfo[ctr].positionX + _linesOffsetX[_lettersInfo[ctr].lineIndex];
-                _reusedLetter->setPosition(letterPositionX, py);
-                auto index = static_cast<int>(_batchNodes.at(letterDef.textureID)->getTextureAtlas()->getTotalQuads());
-                _lettersInfo[ctr].atlasIndex = index;
-
-                this->updateLetterSpriteScale(_reusedLetter);
-
-                _batchNodes.at(letterDef.textureID)->insertQuadFromSprite(_reusedLetter, index);
+                insertLetterQuad(ctr, letterDef.textureID, py);
             }
         }     
     }
@@ -790,6 +819,384 @@ bool Label::updateQuads()
     return ret;
 }
 
+void Label::insertLetterQuad(int letterIndex, int textureID, float py)
+{
+    _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
+    float letterPositionX = _lettersInfo[letterIndex].positionX + _linesOffsetX[_lettersInfo[letterIndex].lineIndex];
+    _reusedLetter->setPosition(letterPositionX, py);
+    auto index = static_cast<int>(_batchNodes.at(textureID)->getTextureAtlas()->getTotalQuads());
+    _lettersInfo[letterIndex].atlasIndex = index;
+
+    this->updateLetterSpriteScale(_reusedLetter);
+
+    _batchNodes.at(textureID)->insertQuadFromSprite(_reusedLetter, index);
+}
+
+void Label::recordLayoutState()
+{
+    // Layouts that still miss glyphs, or that letter sprites were created from, are rebuilt from scratch
+    _layoutState.valid = !_waitingForGlyphs && _letters.empty();
+    _layoutState.fontAtlas = _fontAtlas;
+    _layoutState.atlasGeneration = _fontAtlas->getGeneration();
+    _layoutState.textureRevision = _fontAtlas->getTextureRevision();
+    _layoutState.fontScale = _fontScale;
+    _layoutState.lineHeight = _lineHeight;
+    _layoutState.lineSpacing = _lineSpacing;
+    _layoutState.additionalKerning = _additionalKerning;
+    _layoutState.labelWidth = _labelWidth;
+    _layoutState.labelHeight = _labelHeight;
+    _layoutState.maxLineWidth = _maxLineWidth;
+    _layoutState.hAlignment = _hAlignment;
+    _layoutState.vAlignment = _vAlignment;
+    _layoutState.overflow = _overflow;
+    _layoutState.enableWrap = _enableWrap;
+    _layoutState.lineBreakWithoutSpaces = _lineBreakWithoutSpaces;
+}
+
+bool Label::updateLettersIncrementally()
+{
+    // Left aligned text without clipping keeps the quads of every line an edit does not touch
+    if (!_layoutState.valid || !_letters.empty() || _batchNodes.size() != 1 || _hAlignment != TextHAlignment::LEFT
+        || _overflow != Overflow::NONE || _letterOffsetY > _contentSize.height || _waitingForGlyphs)
+    {
+        return false;
+    }
+
+    if (_layoutState.fontAtlas != _fontAtlas || _layoutState.atlasGeneration != _fontAtlas->getGeneration()
+        || _layoutState.textureRevision != _fontAtlas->getTextureRevision() || _layoutState.fontScale != _fontScale
+        || _layoutState.lineHeight != _lineHeight || _layoutState.lineSpacing != _lineSpacing || _layoutState.additionalKerning != _additionalKerning
+        || _layoutState.labelWidth != _labelWidth || _layoutState.labelHeight != _labelHeight
+        || _layoutState.maxLineWidth != _maxLineWidth || _layoutState.hAlignment != _hAlignment
+        || _layoutState.vAlignment != _vAlignment || _layoutState.overflow != _overflow || _layoutState.enableWrap != _enableWrap
+        || _layoutState.lineBreakWithoutSpaces != _lineBreakWithoutSpaces)
+    {
+        return false;
+    }
+
+    int oldLength = _lengthOfString;
+    int textLength = static_cast<int>(_utf32Text.length());
+    int prefix = 0;
+
+    while (prefix < oldLength && prefix < textLength && _lettersInfo[prefix].utf32Char == _utf32Text[prefix])
+    {
+        prefix++;
+    }
+
+    int suffix = 0;
+
+    while (prefix + suffix < oldLength && prefix + suffix < textLength
+        && _lettersInfo[oldLength - 1 - suffix].utf32Char == _utf32Text[textLength - 1 - suffix])
+    {
+        suffix++;
+    }
+
+    // Paragraphs after the one holding the end of the edit are unchanged, they only move vertically
+    int endIndex = textLength - suffix;
+
+    while (endIndex < textLength && _utf32Text[endIndex] != (char32_t)TextFormatter::NewLine)
+    {
+        endIndex++;
+    }
+
+    int oldEndIndex = endIndex - (textLength - oldLength);
+    int oldEndLine = oldEndIndex < oldLength ? _lettersInfo[oldEndIndex].lineIndex : _numberOfLines - 1;
+
+    // Layout restarts at the start of the paragraph, or after the last unchanged letter when lines do not wrap
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    FontLetterDefinition letterDef;
+    int startIndex = prefix;
+    int startLine = 0;
+    float startX = 0.f;
+
+    while (startIndex > 0 && _utf32Text[startIndex - 1] != (char32_t)TextFormatter::NewLine)
+    {
+        startIndex--;
+    }
+
+    if (startIndex > 0)
+    {
+        startLine = _lettersInfo[startIndex - 1].lineIndex + 1;
+    }
+
+    // Carriage returns and \b change how the letters around them advance, so the paragraphs holding them get the full layout
+    for (int index = startIndex; index < endIndex; index++)
+    {
+        if (_utf32Text[index] == (char32_t)TextFormatter::CarriageReturn || _utf32Text[index] == (char32_t)TextFormatter::NextCharNoChangeX)
+        {
+            return false;
+        }
+    }
+
+    if (!(_enableWrap && _maxLineWidth > 0.f))
+    {
+        for (int index = prefix - 1; index >= startIndex; index--)
+        {
+            if (_lettersInfo[index].valid && _fontAtlas->getLetterDefinitionForChar(_lettersInfo[index].utf32Char, letterDef))
+            {
+                startX = _lettersInfo[index].positionX * contentScaleFactor - letterDef.offsetX * _fontScale + letterDef.xAdvance * _fontScale + _additionalKerning;
+                startLine = _lettersInfo[index].lineIndex;
+
+                int kerningCount = 0;
+                int* kernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF32(_utf32Text.substr(index, 2), kerningCount);
+
+                if (kernings && kerningCount > 1)
+                {
+                    startX += kernings[1] * _fontScale;
+                }
+
+                delete [] kernings;
+
+                startIndex = prefix;
+                break;
+            }
+        }
+    }
+
+    if (endIndex > startIndex)
+    {
+        _fontAtlas->prepareLetterDefinitions(_utf32Text.substr(startIndex, endIndex - startIndex));
+
+        // A page that grew or glyphs still being rasterized need the full layout
+        if (_fontAtlas->getTextureRevision() != _layoutState.textureRevision || _fontAtlas->getTextures().size() != 1
+            || _fontAtlas->hasPendingGlyphs())
+        {
+            return false;
+        }
+
+        _fontAtlasGlyphRevision = _fontAtlas->getGlyphRevision();
+    }
+
+    // The quads of the changed paragraphs, which were appended in letter order
+    auto textureAtlas = _batchNodes.at(0)->getTextureAtlas();
+    ssize_t firstQuad = textureAtlas->getTotalQuads();
+    ssize_t endQuad = firstQuad;
+
+    for (int index = startIndex; index < oldLength; index++)
+    {
+        if (_lettersInfo[index].valid && _lettersInfo[index].atlasIndex >= 0)
+        {
+            firstQuad = _lettersInfo[index].atlasIndex;
+            break;
+        }
+    }
+
+    for (int index = oldEndIndex; index < oldLength; index++)
+    {
+        if (_lettersInfo[index].valid && _lettersInfo[index].atlasIndex >= 0)
+        {
+            endQuad = _lettersInfo[index].atlasIndex;
+            break;
+        }
+    }
+
+    // Move the letters after the changed paragraphs to their new indices
+    _lettersInfo.resize(oldLength);
+
+    if (textLength > oldLength)
+    {
+        _lettersInfo.insert(_lettersInfo.begin() + oldEndIndex, textLength - oldLength, LetterInfo());
+    }
+    else if (textLength < oldLength)
+    {
+        _lettersInfo.erase(_lettersInfo.begin() + endIndex, _lettersInfo.begin() + oldEndIndex);
+    }
+
+    // Kernings for the relaid letters, including the pair with the line break that ends them
+    int kerningCount = 0;
+    int* kernings = nullptr;
+    int kerningEnd = std::min(endIndex + 1, textLength);
+
+    if (kerningEnd > startIndex)
+    {
+        kernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF32(_utf32Text.substr(startIndex, kerningEnd - startIndex), kerningCount);
+    }
+
+    std::vector<float> linesWidth;
+    float highestY = 0.f;
+    float lowestY = 0.f;
+    int endLine;
+
+    if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
+    {
+        endLine = wrapLetters(CC_CALLBACK_3(Label::getFirstWordLen, this), startIndex, endIndex, startLine, startX, kernings, startIndex, linesWidth, highestY, lowestY);
+    }
+    else
+    {
+        endLine = wrapLetters(CC_CALLBACK_3(Label::getFirstCharLen, this), startIndex, endIndex, startLine, startX, kernings, startIndex, linesWidth, highestY, lowestY);
+    }
+
+    delete [] kernings;
+
+    int lineDelta = endLine - oldEndLine;
+    float lineStep = (_lineHeight + _lineSpacing * contentScaleFactor) / contentScaleFactor;
+
+    if (lineDelta != 0)
+    {
+        for (int index = endIndex; index < textLength; index++)
+        {
+            _lettersInfo[index].lineIndex += lineDelta;
+            _lettersInfo[index].positionY -= lineDelta * lineStep;
+        }
+    }
+
+    _linesWidth.erase(_linesWidth.begin() + startLine, _linesWidth.begin() + oldEndLine + 1);
+    _linesWidth.insert(_linesWidth.begin() + startLine, linesWidth.begin(), linesWidth.end());
+    _numberOfLines = static_cast<int>(_linesWidth.size());
+    _lengthOfString = textLength;
+
+    float longestLine = 0.f;
+    for (auto lineWidth : _linesWidth)
+    {
+        if (longestLine < lineWidth)
+            longestLine = lineWidth;
+    }
+
+    float oldLetterOffsetY = _letterOffsetY;
+    _textDesiredHeight = (_numberOfLines * _lineHeight) / contentScaleFactor;
+    if (_numberOfLines > 1)
+        _textDesiredHeight += (_numberOfLines - 1) * _lineSpacing;
+    CSize contentSize(_labelWidth, _labelHeight);
+    if (_labelWidth <= 0.f)
+        contentSize.width = longestLine;
+    if (_labelHeight <= 0.f)
+        contentSize.height = _textDesiredHeight;
+    setContentSize(contentSize);
+    computeAlignmentOffset();
+
+    // Letters only reach past the text box from the first or the last line, since the line height covers the ascent and descent of the font
+    // Placeholders are skipped, only laid out letters have a line index
+    for (int index = 0; index < textLength; index++)
+    {
+        if (!_lettersInfo[index].valid)
+        {
+            continue;
+        }
+
+        if (_lettersInfo[index].lineIndex != 0)
+        {
+            break;
+        }
+
+        highestY = std::max(highestY, _lettersInfo[index].positionY);
+    }
+
+    for (int index = textLength - 1; index >= 0; index--)
+    {
+        if (!_lettersInfo[index].valid)
+        {
+            continue;
+        }
+
+        if (_lettersInfo[index].lineIndex != _numberOfLines - 1)
+        {
+            break;
+        }
+
+        if (_fontAtlas->getLetterDefinitionForChar(_lettersInfo[index].utf32Char, letterDef))
+        {
+            lowestY = std::min(lowestY, _lettersInfo[index].positionY - letterDef.height * _fontScale);
+        }
+    }
+
+    _tailoredTopY = contentSize.height;
+    _tailoredBottomY = 0.f;
+    if (highestY > 0.f)
+        _tailoredTopY = contentSize.height + highestY;
+    if (lowestY < -_textDesiredHeight)
+        _tailoredBottomY = _textDesiredHeight + lowestY;
+
+    // Text that no longer fits gets its top clipped, which only the full layout does
+    if (_letterOffsetY > _contentSize.height)
+    {
+        return false;
+    }
+
+    textureAtlas->removeQuadsAtIndex(firstQuad, endQuad - firstQuad);
+    _reusedLetter->setBatchNode(_batchNodes.at(0));
+
+    ssize_t appendedQuad = textureAtlas->getTotalQuads();
+
+    for (int letterIndex = startIndex; letterIndex < endIndex; letterIndex++)
+    {
+        if (_lettersInfo[letterIndex].valid)
+        {
+            auto& relaidDef = _fontAtlas->_letterDefinitions[_lettersInfo[letterIndex].utf32Char];
+
+            _reusedRect.size.height = relaidDef.height;
+            _reusedRect.size.width = relaidDef.width;
+            _reusedRect.origin.x = relaidDef.U;
+            _reusedRect.origin.y = relaidDef.V;
+
+            if (_reusedRect.size.height > 0.f && _reusedRect.size.width > 0.f)
+            {
+                insertLetterQuad(letterIndex, relaidDef.textureID, _lettersInfo[letterIndex].positionY + _letterOffsetY);
+            }
+        }
+    }
+
+    ssize_t insertedQuads = textureAtlas->getTotalQuads() - appendedQuad;
+
+    if (insertedQuads > 0 && appendedQuad != firstQuad)
+    {
+        textureAtlas->moveQuadsFromIndex(appendedQuad, insertedQuads, firstQuad);
+
+        for (int letterIndex = startIndex; letterIndex < endIndex; letterIndex++)
+        {
+            if (_lettersInfo[letterIndex].valid && _lettersInfo[letterIndex].atlasIndex >= 0)
+            {
+                _lettersInfo[letterIndex].atlasIndex -= static_cast<int>(appendedQuad - firstQuad);
+            }
+        }
+    }
+
+    int quadDelta = static_cast<int>(insertedQuads - (endQuad - firstQuad));
+
+    if (quadDelta != 0)
+    {
+        for (int letterIndex = endIndex; letterIndex < textLength; letterIndex++)
+        {
+            if (_lettersInfo[letterIndex].valid && _lettersInfo[letterIndex].atlasIndex >= 0)
+            {
+                _lettersInfo[letterIndex].atlasIndex += quadDelta;
+            }
+        }
+    }
+
+    // Quads before the edit follow the vertical alignment, quads after it also follow the lines added or removed
+    auto quads = textureAtlas->getQuads();
+    auto totalQuads = textureAtlas->getTotalQuads();
+    float prefixShift = _letterOffsetY - oldLetterOffsetY;
+    float suffixShift = prefixShift - lineDelta * lineStep;
+
+    if (prefixShift != 0.f)
+    {
+        for (ssize_t index = 0; index < firstQuad; ++index)
+        {
+            quads[index].bl.vertices.y += prefixShift;
+            quads[index].br.vertices.y += prefixShift;
+            quads[index].tl.vertices.y += prefixShift;
+            quads[index].tr.vertices.y += prefixShift;
+        }
+    }
+
+    if (suffixShift != 0.f)
+    {
+        for (ssize_t index = firstQuad + insertedQuads; index < totalQuads; ++index)
+        {
+            quads[index].bl.vertices.y += suffixShift;
+            quads[index].br.vertices.y += suffixShift;
+            quads[index].tl.vertices.y += suffixShift;
+            quads[index].tr.vertices.y += suffixShift;
+        }
+    }
+
+    textureAtlas->setDirty(true);
+
+    updateQuadColors(textureAtlas, firstQuad, insertedQuads);
+
+    return true;
+}
+
 bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
 {
     FontAtlas *newAtlas = FontAtlasCache::getFontAtlasTTF(&ttfConfig);
@@ -802,6 +1209,7 @@ bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
 
     _currentLabelType = LabelType::TTF;
     setFontAtlas(newAtlas,ttfConfig.distanceFieldEnabled,true);
+    updateFontScale(ttfConfig.fontSize);
 
     _fontConfig = ttfConfig;
 
@@ -831,6 +1239,21 @@ bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
     return true;
 }
 
+void Label::updateFontScale(float fontSize)
+{
+    // A shared distance field atlas is rasterized at its own size, and scaled to the requested one
+    float atlasFontSize = _fontAtlas ? _fontAtlas->getFontSize() : 0.0f;
+    float fontScale = atlasFontSize > 0.0f ? fontSize / atlasFontSize : 1.0f;
+
+    if (fontScale != _fontScale)
+    {
+        _fontScale = fontScale;
+        _lineHeight = _fontAtlas->getLineHeight() * _fontScale;
+        _contentDirty = true;
+        invalidateCachedAncestors();
+    }
+}
+
 void Label::scaleFontSizeDown(float fontSize)
 {
     bool shouldUpdateContent = true;
@@ -858,6 +1281,7 @@ void Label::enableGlow(const Color4B& glowColor)
             config.distanceFieldEnabled = true;
             setTTFConfig(config);
             _contentDirty = true;
+            invalidateCachedAncestors();
         }
         _currLabelEffect = LabelEffect::GLOW;
         _effectColorF.r = glowColor.r / 255.0f;
@@ -895,6 +1319,7 @@ void Label::enableOutline(const Color4B& outlineColor,int outlineSize /* = -1 */
             _effectColorF.a = outlineColor.a / 255.f;
             _currLabelEffect = LabelEffect::OUTLINE;
             _contentDirty = true;
+            invalidateCachedAncestors();
         }
         _outlineSize = outlineSize;
     }
@@ -969,6 +1394,7 @@ void Label::enableUnderline()
         _underlineNode = DrawNode::create();
         addChild(_underlineNode, 100000);
         _contentDirty = true;
+        invalidateCachedAncestors();
     }
 }
 
@@ -1002,6 +1428,7 @@ void Label::disableEffect(LabelEffect effect)
                 }
                 _currLabelEffect = LabelEffect::NORMAL;
                 _contentDirty = true;
+                invalidateCachedAncestors();
             }
             break;
         case cocos2d::LabelEffect::SHADOW:
@@ -1138,13 +1565,7 @@ void Label::updateContent()
 
     if (_fontAtlas)
     {
-        std::u32string utf32String;
-        if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
-        {
-            _utf32Text = utf32String;
-        }
-
-        computeHorizontalKernings(_utf32Text);
+        // setString() keeps _utf32Text in sync, and alignText() computes kernings only when the layout is not cached
         updateFinished = alignText();
     }
     else
@@ -1232,10 +1653,6 @@ void Label::onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor)
         }
 
         glProgram->setUniformsForBuiltins(_shadowTransform);
-        for (auto&& it : _letters)
-        {
-            it.second->updateTransform();
-        }
         for (auto&& batchNode : _batchNodes)
         {
             batchNode->getTextureAtlas()->drawQuads();
@@ -1249,10 +1666,6 @@ void Label::onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor)
         setColor(Color3B(shadowColor));
 
         glProgram->setUniformsForBuiltins(_shadowTransform);
-        for (auto&& it : _letters)
-        {
-            it.second->updateTransform();
-        }
         for (auto&& batchNode : _batchNodes)
         {
             batchNode->getTextureAtlas()->drawQuads();
@@ -1269,6 +1682,18 @@ void Label::onDraw(const Mat4& transform, bool /*transformUpdated*/)
     glprogram->use();
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
 
+    if (_uniformSmoothing != -1)
+    {
+        // Set before the shadow pass, since the program is shared. Keeps the edge about one screen pixel wide however much the distance field is scaled.
+        glprogram->setUniformLocationWith1f(_uniformSmoothing, clampf(DistanceFieldSmoothing / _fontScale, 0.01f, 0.25f));
+    }
+
+    // Letter sprites only rewrite their quads when dirty, and the shadow reuses the same quads
+    for (auto&& it : _letters)
+    {
+        it.second->updateTransform();
+    }
+
     if (_shadowEnabled)
     {
         if (_boldEnabled)
@@ -1278,26 +1703,15 @@ void Label::onDraw(const Mat4& transform, bool /*transformUpdated*/)
     }
 
     glprogram->setUniformsForBuiltins(transform);
-    for (auto&& it : _letters)
-    {
-        it.second->updateTransform();
-    }
 
     if (_currentLabelType == LabelType::TTF)
     {
         switch (_currLabelEffect) {
         case LabelEffect::OUTLINE:
-            // draw outline of text
-            glprogram->setUniformLocationWith1i(_uniformEffectType, 1); // 1: outline
+            // draw the outline and the text over it in one pass
+            glprogram->setUniformLocationWith1i(_uniformEffectType, 1); // 1: outline and text
             glprogram->setUniformLocationWith4f(_uniformEffectColor,
                 _effectColorF.r, _effectColorF.g, _effectColorF.b, _effectColorF.a);
-            for (auto&& batchNode : _batchNodes)
-            {
-                batchNode->getTextureAtlas()->drawQuads();
-            }
-
-            // draw text without outline
-            glprogram->setUniformLocationWith1i(_uniformEffectType, 0); // 0: text
             glprogram->setUniformLocationWith4f(_uniformTextColor, _textColorF.r, _textColorF.g, _textColorF.b, _textColorF.a);
             break;
         case LabelEffect::GLOW:
@@ -1342,11 +1756,25 @@ void Label::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t pare
     {
         return;
     }
+
+    // A glyph page that grew since the quads were built has different texture coordinates,
+    // and glyphs rasterized asynchronously may have arrived since the last layout
+    if (_fontAtlas && (_fontAtlasRevision != _fontAtlas->getTextureRevision()
+        || (_waitingForGlyphs && _fontAtlasGlyphRevision != _fontAtlas->getGlyphRevision())))
+    {
+        _contentDirty = true;
+    }
     
     if (_systemFontDirty || _contentDirty)
     {
         updateContent();
     }
+
+    // A cached rendering of this label has to be refreshed once the missing glyphs have arrived
+    if (_waitingForGlyphs)
+    {
+        invalidateCachedAncestors();
+    }
     
     if(_selfFlags & FLAGS_DIRTY_MASK)
     {
@@ -1486,8 +1914,8 @@ Sprite* Label::getLetter(int letterIndex, bool applyCursorOffset, bool offsetUni
 
         if (!offsetUnicodeCombines || !StringUtils::isUnicodeCombine(letterInfo.utf32Char))
         {
-            px = letterInfo.positionX + (applyCursorOffset ? 0.0f : uvRect.size.width / 2.0f) + _linesOffsetX[letterInfo.lineIndex];
-            py = letterInfo.positionY - uvRect.size.height / 2.0f + _letterOffsetY;
+            px = letterInfo.positionX + (applyCursorOffset ? 0.0f : uvRect.size.width * _fontScale / 2.0f) + _linesOffsetX[letterInfo.lineIndex];
+            py = letterInfo.positionY - uvRect.size.height * _fontScale / 2.0f + _letterOffsetY;
         }
         else
         {
@@ -1507,7 +1935,7 @@ Sprite* Label::getLetter(int letterIndex, bool applyCursorOffset, bool offsetUni
                 {
                     if (!isPrioNormalLetter)
                     {
-                        offset += (isPositive ? -letterDefSeek.height / 2.0f : letterDefSeek.height / 2.0f);
+                        offset += (isPositive ? -letterDefSeek.height * _fontScale / 2.0f : letterDefSeek.height * _fontScale / 2.0f);
                     }
 
                     py += offset;
@@ -1535,23 +1963,24 @@ Sprite* Label::getLetter(int letterIndex, bool applyCursorOffset, bool offsetUni
 
                     if (letterInfoSeek.lineIndex >= 0 && letterInfoSeek.lineIndex < int(_linesOffsetX.size()))
                     {
-                        px += letterInfoSeek.positionX + (applyCursorOffset ? 0.0f : uvRectSeek.size.width / 2) + _linesOffsetX[letterInfoSeek.lineIndex];
+                        px += letterInfoSeek.positionX + (applyCursorOffset ? 0.0f : uvRectSeek.size.width * _fontScale / 2) + _linesOffsetX[letterInfoSeek.lineIndex];
                     }
-                    py += letterInfoSeek.positionY - uvRectSeek.size.height / 2 + _letterOffsetY;
+                    py += letterInfoSeek.positionY - uvRectSeek.size.height * _fontScale / 2 + _letterOffsetY;
                 }
             }
             else
             {
                 if (letterInfo.lineIndex >= 0 && letterInfo.lineIndex < int(_linesOffsetX.size()))
                 {
-                    px += letterInfo.positionX + (applyCursorOffset ? 0.0f : uvRect.size.width / 2) + _linesOffsetX[letterInfo.lineIndex];
+                    px += letterInfo.positionX + (applyCursorOffset ? 0.0f : uvRect.size.width * _fontScale / 2) + _linesOffsetX[letterInfo.lineIndex];
                 }
-                py += letterInfo.positionY - uvRect.size.height / 2 + _letterOffsetY;
+                py += letterInfo.positionY - uvRect.size.height * _fontScale / 2 + _letterOffsetY;
             }
         }
 
         letter->setPosition(px, py);
         letter->setOpacity(_realOpacity);
+        this->updateLetterSpriteScale(letter);
         
         addChild(letter);
         _letters[letterIndex] = letter;
@@ -1568,6 +1997,7 @@ void Label::setLineHeight(float height)
     {
         _lineHeight = height;
         _contentDirty = true;
+        invalidateCachedAncestors();
     }
 }
 
@@ -1583,6 +2013,7 @@ void Label::setLineSpacing(float height)
     {
         _lineSpacing = height;
         _contentDirty = true;
+        invalidateCachedAncestors();
     }
 }
 
@@ -1600,6 +2031,7 @@ void Label::setAdditionalKerning(float space)
         {
             _additionalKerning = space;
             _contentDirty = true;
+            invalidateCachedAncestors();
         }
     }
     else
@@ -1741,6 +2173,7 @@ void Label::setTextColor(const Color4B &color)
     if (_currentLabelType == LabelType::STRING_TEXTURE && _textColor != color)
     {
         _contentDirty = true;
+        invalidateCachedAncestors();
     }
 
     _textColor = color;
@@ -1752,11 +2185,15 @@ void Label::setTextColor(const Color4B &color)
 
 void Label::updateColor()
 {
-    if (_batchNodes.empty())
+    for (auto&& batchNode : _batchNodes)
     {
-        return;
+        auto textureAtlas = batchNode->getTextureAtlas();
+        updateQuadColors(textureAtlas, 0, textureAtlas->getTotalQuads());
     }
+}
 
+void Label::updateQuadColors(TextureAtlas* textureAtlas, ssize_t firstQuad, ssize_t quadCount)
+{
     Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
 
     // special opacity for premultiplied textures
@@ -1767,22 +2204,15 @@ void Label::updateColor()
         color4.b *= _displayedOpacity/255.0f;
     }
 
-    cocos2d::TextureAtlas* textureAtlas;
-    V3F_C4B_T2F_Quad *quads;
-    for (auto&& batchNode:_batchNodes)
-    {
-        textureAtlas = batchNode->getTextureAtlas();
-        quads = textureAtlas->getQuads();
-        auto count = textureAtlas->getTotalQuads();
+    V3F_C4B_T2F_Quad* quads = textureAtlas->getQuads();
 
-        for (int index = 0; index < count; ++index)
-        {
-            quads[index].bl.colors = color4;
-            quads[index].br.colors = color4;
-            quads[index].tl.colors = color4;
-            quads[index].tr.colors = color4;
-            textureAtlas->updateQuad(&quads[index], index);
-        }
+    for (ssize_t index = firstQuad; index < firstQuad + quadCount; ++index)
+    {
+        quads[index].bl.colors = color4;
+        quads[index].br.colors = color4;
+        quads[index].tl.colors = color4;
+        quads[index].tr.colors = color4;
+        textureAtlas->updateQuad(&quads[index], index);
     }
 }
 
@@ -1930,6 +2360,7 @@ void Label::enableWrap(bool enable)
     this->rescaleWithOriginalFontSize();
     
     _contentDirty = true;
+    invalidateCachedAncestors();
 }
 
 bool Label::isWrapEnabled()const
@@ -1952,6 +2383,7 @@ void Label::setOverflow(Overflow overflow)
     this->rescaleWithOriginalFontSize();
     
     _contentDirty = true;
+    invalidateCachedAncestors();
 }
 
 void Label::rescaleWithOriginalFontSize()
@@ -1969,7 +2401,7 @@ Label::Overflow Label::getOverflow()const
 
 void Label::updateLetterSpriteScale(Sprite* sprite)
 {
-    sprite->setScale(1.0f);
+    sprite->setScale(_fontScale);
 }
 
 void Label::computeAlignmentOffset()
@@ -2030,7 +2462,7 @@ int Label::getFirstWordLen(const std::u32string& utf32Text, int startIndex, int
     if (!_fontAtlas->getLetterDefinitionForChar(character, letterDef)) {
         return len;
     }
-    auto nextLetterX = letterDef.xAdvance + _additionalKerning;
+    auto nextLetterX = letterDef.xAdvance * _fontScale + _additionalKerning;
 
     auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
     for (int index = startIndex + 1; index < textLen; ++index)
@@ -2041,14 +2473,14 @@ int Label::getFirstWordLen(const std::u32string& utf32Text, int startIndex, int
             break;
         }
 
-        auto letterX = (nextLetterX + letterDef.offsetX) / contentScaleFactor;
-        if (_maxLineWidth > 0.f && letterX + letterDef.width > _maxLineWidth
+        auto letterX = (nextLetterX + letterDef.offsetX * _fontScale) / contentScaleFactor;
+        if (_maxLineWidth > 0.f && letterX + letterDef.width * _fontScale > _maxLineWidth
             && !StringUtils::isUnicodeSpace(character))
         {
             return len;
         }
 
-        nextLetterX += letterDef.xAdvance + _additionalKerning;
+        nextLetterX += letterDef.xAdvance * _fontScale + _additionalKerning;
 
         if (character == (char16_t)TextFormatter::NewLine
             || StringUtils::isUnicodeSpace(character)
@@ -2065,36 +2497,71 @@ int Label::getFirstWordLen(const std::u32string& utf32Text, int startIndex, int
 bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int, int)>& nextTokenLen)
 {
     int textLen = getStringLength();
-    int lineIndex = 0;
-    float nextTokenX = 0.f;
-    float nextTokenY = 0.f;
+    float highestY = 0.f;
+    float lowestY = 0.f;
+
+    int lineIndex = wrapLetters(nextTokenLen, 0, textLen, 0, 0.f, _horizontalKernings, 0, _linesWidth, highestY, lowestY);
+
     float longestLine = 0.f;
-    float letterRight = 0.f;
+    for (auto lineWidth : _linesWidth)
+    {
+        if (longestLine < lineWidth)
+            longestLine = lineWidth;
+    }
 
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    _numberOfLines = lineIndex + 1;
+    _textDesiredHeight = (_numberOfLines * _lineHeight) / contentScaleFactor;
+    if (_numberOfLines > 1)
+        _textDesiredHeight += (_numberOfLines - 1) * _lineSpacing;
+    CSize contentSize(_labelWidth, _labelHeight);
+    if (_labelWidth <= 0.f)
+        contentSize.width = longestLine;
+    if (_labelHeight <= 0.f)
+        contentSize.height = _textDesiredHeight;
+    setContentSize(contentSize);
+
+    _tailoredTopY = contentSize.height;
+    _tailoredBottomY = 0.f;
+    if (highestY > 0.f)
+        _tailoredTopY = contentSize.height + highestY;
+    if (lowestY < -_textDesiredHeight)
+        _tailoredBottomY = _textDesiredHeight + lowestY;
+
+    return true;
+}
+
+int Label::wrapLetters(const std::function<int(const std::u32string&, int, int)>& nextTokenLen, int startIndex, int endIndex, int lineIndex, float startX,
+    const int* kernings, int kerningsIndex, std::vector<float>& linesWidth, float& highestY, float& lowestY)
+{
+    int textLen = static_cast<int>(_utf32Text.length());
     auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
     float lineSpacing = _lineSpacing * contentScaleFactor;
-    float highestY = 0.f;
-    float lowestY = 0.f;
+    float nextTokenX = startX;
+    float nextTokenY = -lineIndex * (_lineHeight + lineSpacing);
+    float letterRight = startX / contentScaleFactor;
     FontLetterDefinition letterDef;
     Vec2 letterPosition;
     bool nextChangeSize = true;
 
-    for (int index = 0; index < textLen; )
+    for (int index = startIndex; index < endIndex; )
     {
         auto character = _utf32Text[index];
         if (character == (char32_t)TextFormatter::NewLine)
         {
-            _linesWidth.push_back(letterRight);
+            linesWidth.push_back(letterRight);
+            recordPlaceholderInfo(index, character);
+            // The line a line break ends, so an edit can find where the next paragraph starts
+            _lettersInfo[index].lineIndex = lineIndex;
             letterRight = 0.f;
             lineIndex++;
             nextTokenX = 0.f;
             nextTokenY -= _lineHeight + lineSpacing;
-            recordPlaceholderInfo(index, character);
             index++;
             continue;
         }
 
-        auto tokenLen = nextTokenLen(_utf32Text, index, textLen);
+        auto tokenLen = nextTokenLen(_utf32Text, index, endIndex);
         float tokenHighestY = highestY;
         float tokenLowestY = lowestY;
         float tokenRight = letterRight;
@@ -2123,11 +2590,11 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
                 continue;
             }
 
-            auto letterX = (nextLetterX + letterDef.offsetX) / contentScaleFactor;
-            if (_enableWrap && _maxLineWidth > 0.f && nextTokenX > 0.f && letterX + letterDef.width > _maxLineWidth
+            auto letterX = (nextLetterX + letterDef.offsetX * _fontScale) / contentScaleFactor;
+            if (_enableWrap && _maxLineWidth > 0.f && nextTokenX > 0.f && letterX + letterDef.width * _fontScale > _maxLineWidth
                 && !StringUtils::isUnicodeSpace(character) && nextChangeSize)
             {
-                _linesWidth.push_back(letterRight);
+                linesWidth.push_back(letterRight);
                 letterRight = 0.f;
                 lineIndex++;
                 nextTokenX = 0.f;
@@ -2139,14 +2606,14 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
             {
                 letterPosition.x = letterX;
             }
-            letterPosition.y = (nextTokenY - letterDef.offsetY) / contentScaleFactor;
+            letterPosition.y = (nextTokenY - letterDef.offsetY * _fontScale) / contentScaleFactor;
             recordLetterInfo(letterPosition, character, letterIndex, lineIndex);
 
             if (nextChangeSize)
             {
-                if (_horizontalKernings && letterIndex < textLen - 1)
-                    nextLetterX += _horizontalKernings[letterIndex + 1];
-                nextLetterX += letterDef.xAdvance + _additionalKerning;
+                if (kernings && letterIndex < textLen - 1)
+                    nextLetterX += kernings[letterIndex + 1 - kerningsIndex] * _fontScale;
+                nextLetterX += letterDef.xAdvance * _fontScale + _additionalKerning;
 
                     tokenRight = nextLetterX / contentScaleFactor;
                 }
@@ -2154,8 +2621,8 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
 
             if (tokenHighestY < letterPosition.y)
                 tokenHighestY = letterPosition.y;
-            if (tokenLowestY > letterPosition.y - letterDef.height)
-                tokenLowestY = letterPosition.y - letterDef.height;
+            if (tokenLowestY > letterPosition.y - letterDef.height * _fontScale)
+                tokenLowestY = letterPosition.y - letterDef.height * _fontScale;
         }
 
         if (newLine)
@@ -2169,33 +2636,13 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
             highestY = tokenHighestY;
         if (lowestY > tokenLowestY)
             lowestY = tokenLowestY;
-        if (longestLine < letterRight)
-            longestLine = letterRight;
 
         index += tokenLen;
     }
 
-    _linesWidth.push_back(letterRight);
-
-    _numberOfLines = lineIndex + 1;
-    _textDesiredHeight = (_numberOfLines * _lineHeight) / contentScaleFactor;
-    if (_numberOfLines > 1)
-        _textDesiredHeight += (_numberOfLines - 1) * _lineSpacing;
-    CSize contentSize(_labelWidth, _labelHeight);
-    if (_labelWidth <= 0.f)
-        contentSize.width = longestLine;
-    if (_labelHeight <= 0.f)
-        contentSize.height = _textDesiredHeight;
-    setContentSize(contentSize);
-
-    _tailoredTopY = contentSize.height;
-    _tailoredBottomY = 0.f;
-    if (highestY > 0.f)
-        _tailoredTopY = contentSize.height + highestY;
-    if (lowestY < -_textDesiredHeight)
-        _tailoredBottomY = _textDesiredHeight + lowestY;
+    linesWidth.push_back(letterRight);
 
-    return true;
+    return lineIndex;
 }
 
 bool Label::multilineTextWrapByWord()
@@ -2229,7 +2676,7 @@ bool Label::isHorizontalClamp()
         {
             auto& letterDef = _fontAtlas->_letterDefinitions[_lettersInfo[ctr].utf32Char];
 
-            auto px = _lettersInfo[ctr].positionX + letterDef.width/2;
+            auto px = _lettersInfo[ctr].positionX + letterDef.width * _fontScale / 2;
             auto lineIndex = _lettersInfo[ctr].lineIndex;
 
             if(_labelWidth > 0.f){
@@ -2322,4 +2769,235 @@ void Label::recordPlaceholderInfo(int letterIndex, char32_t utf32Char)
     _lettersInfo[letterIndex].valid = false;
 }
 
+
+/**
+ * A least recently used cache of Label layouts: the letter positions and line metrics produced by the wrap and alignment passes.
+ * A layout only depends on the font, the string and the layout settings, all of which are part of the key.
+ */
+class LabelLayoutCache
+{
+public:
+    struct Key
+    {
+        std::u32string text;
+        std::string fontFilePath;
+        float fontSize;
+        int outlineSize;
+        bool distanceFieldEnabled;
+        float fontScale;
+        float lineHeight;
+        float lineSpacing;
+        float additionalKerning;
+        float maxLineWidth;
+        float labelWidth;
+        float labelHeight;
+        TextHAlignment hAlignment;
+        TextVAlignment vAlignment;
+        Label::Overflow overflow;
+        bool lineBreakWithoutSpaces;
+        bool enableWrap;
+        float contentScaleFactor;
+        size_t hash;
+
+        bool operator==(const Key& other) const
+        {
+            return hash == other.hash && text == other.text && fontFilePath == other.fontFilePath && fontSize == other.fontSize
+                && outlineSize == other.outlineSize && distanceFieldEnabled == other.distanceFieldEnabled && fontScale == other.fontScale
+                && lineHeight == other.lineHeight && lineSpacing == other.lineSpacing && additionalKerning == other.additionalKerning
+                && maxLineWidth == other.maxLineWidth && labelWidth == other.labelWidth && labelHeight == other.labelHeight
+                && hAlignment == other.hAlignment && vAlignment == other.vAlignment && overflow == other.overflow
+                && lineBreakWithoutSpaces == other.lineBreakWithoutSpaces && enableWrap == other.enableWrap
+                && contentScaleFactor == other.contentScaleFactor;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return key.hash; }
+    };
+
+    struct Layout
+    {
+        std::vector<Label::LetterInfo> letters;
+        std::vector<float> linesWidth;
+        std::vector<float> linesOffsetX;
+        int numberOfLines;
+        float textDesiredHeight;
+        float letterOffsetY;
+        float tailoredTopY;
+        float tailoredBottomY;
+        CSize contentSize;
+    };
+
+    static LabelLayoutCache& getInstance()
+    {
+        static LabelLayoutCache instance;
+        return instance;
+    }
+
+    static Key makeKey(const Label* label)
+    {
+        Key key;
+        key.text = label->_utf32Text;
+        key.fontFilePath = label->_fontConfig.fontFilePath;
+        key.fontSize = label->_fontConfig.fontSize;
+        key.outlineSize = label->_fontConfig.outlineSize;
+        key.distanceFieldEnabled = label->_fontConfig.distanceFieldEnabled;
+        key.fontScale = label->_fontScale;
+        key.lineHeight = label->_lineHeight;
+        key.lineSpacing = label->_lineSpacing;
+        key.additionalKerning = label->_additionalKerning;
+        key.maxLineWidth = label->_maxLineWidth;
+        key.labelWidth = label->_labelWidth;
+        key.labelHeight = label->_labelHeight;
+        key.hAlignment = label->_hAlignment;
+        key.vAlignment = label->_vAlignment;
+        key.overflow = label->_overflow;
+        key.lineBreakWithoutSpaces = label->_lineBreakWithoutSpaces;
+        key.enableWrap = label->_enableWrap;
+        key.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+
+        size_t hash = std::hash<std::u32string>()(key.text);
+        hash = hash * 31 + std::hash<std::string>()(key.fontFilePath);
+        hash = hash * 31 + std::hash<float>()(key.fontSize * key.fontScale);
+        hash = hash * 31 + std::hash<float>()(key.maxLineWidth);
+        hash = hash * 31 + std::hash<float>()(key.labelWidth);
+        hash = hash * 31 + (size_t)key.hAlignment * 3 + (size_t)key.vAlignment;
+        key.hash = hash;
+
+        return key;
+    }
+
+    const Layout* find(const Key& key)
+    {
+        auto it = _index.find(key);
+
+        if (it == _index.end())
+        {
+            return nullptr;
+        }
+
+        // Move to the front of the recency list
+        _entries.splice(_entries.begin(), _entries, it->second);
+
+        return &it->second->second;
+    }
+
+    void insert(Key&& key, Layout&& layout)
+    {
+        if (_capacity == 0 || _index.find(key) != _index.end())
+        {
+            return;
+        }
+
+        while (_entries.size() >= _capacity)
+        {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+
+        _entries.emplace_front(std::move(key), std::move(layout));
+        _index.emplace(_entries.front().first, _entries.begin());
+    }
+
+    void setCapacity(size_t capacity)
+    {
+        _capacity = capacity;
+
+        while (_entries.size() > _capacity)
+        {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+    }
+
+    size_t getCapacity() const { return _capacity; }
+
+    void clear()
+    {
+        _index.clear();
+        _entries.clear();
+    }
+
+private:
+    LabelLayoutCache()
+    : _capacity(256)
+    {
+    }
+
+    typedef std::list<std::pair<Key, Layout>> EntryList;
+
+    EntryList _entries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> _index;
+    size_t _capacity;
+};
+
+void Label::setLayoutCacheCapacity(size_t capacity)
+{
+    LabelLayoutCache::getInstance().setCapacity(capacity);
+}
+
+size_t Label::getLayoutCacheCapacity()
+{
+    return LabelLayoutCache::getInstance().getCapacity();
+}
+
+void Label::clearLayoutCache()
+{
+    LabelLayoutCache::getInstance().clear();
+}
+
+bool Label::restoreCachedLayout()
+{
+    // Shrinking changes the font size while it lays out, so those labels always run the full passes
+    if (_overflow == Overflow::SHRINK || _currentLabelType != LabelType::TTF || LabelLayoutCache::getInstance().getCapacity() == 0)
+    {
+        return false;
+    }
+
+    auto layout = LabelLayoutCache::getInstance().find(LabelLayoutCache::makeKey(this));
+
+    if (layout == nullptr)
+    {
+        return false;
+    }
+
+    _lettersInfo = layout->letters;
+    _lengthOfString = static_cast<int>(_utf32Text.length());
+    _lettersInfo.resize(std::max(_lettersInfo.size(), _utf32Text.length()));
+    _linesWidth = layout->linesWidth;
+    _linesOffsetX = layout->linesOffsetX;
+    _numberOfLines = layout->numberOfLines;
+    _textDesiredHeight = layout->textDesiredHeight;
+    setContentSize(layout->contentSize);
+    _letterOffsetY = layout->letterOffsetY;
+    _tailoredTopY = layout->tailoredTopY;
+    _tailoredBottomY = layout->tailoredBottomY;
+
+    return true;
+}
+
+void Label::storeCachedLayout()
+{
+    // Letters still being rasterized asynchronously were laid out as placeholders
+    if (_overflow == Overflow::SHRINK || _currentLabelType != LabelType::TTF || _waitingForGlyphs
+        || LabelLayoutCache::getInstance().getCapacity() == 0)
+    {
+        return;
+    }
+
+    LabelLayoutCache::Layout layout;
+    layout.letters.assign(_lettersInfo.begin(), _lettersInfo.begin() + std::min(static_cast<size_t>(_lengthOfString), _lettersInfo.size()));
+    layout.linesWidth = _linesWidth;
+    layout.linesOffsetX = _linesOffsetX;
+    layout.numberOfLines = _numberOfLines;
+    layout.textDesiredHeight = _textDesiredHeight;
+    layout.letterOffsetY = _letterOffsetY;
+    layout.tailoredTopY = _tailoredTopY;
+    layout.tailoredBottomY = _tailoredBottomY;
+    layout.contentSize = _contentSize;
+
+    LabelLayoutCache::getInstance().insert(LabelLayoutCache::makeKey(this), std::move(layout));
+}
+
 NS_CC_END
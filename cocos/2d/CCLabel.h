@@ -91,6 +91,7 @@ enum class TextFormatter : char
 
 class Sprite;
 class SpriteBatchNode;
+class TextureAtlas;
 class DrawNode;
 class EventListenerCustom;
 
@@ -501,6 +502,16 @@ public:
 	virtual void removeLetters();
 	virtual void removeAllChildrenWithCleanup(bool cleanup) override;
     virtual void removeChild(Node* child, bool cleanup = true) override;
+
+    /**
+     * Sets how many text layouts are kept for reuse. TTF labels with the same font, string and layout settings
+     * share glyph positions and line metrics instead of wrapping and aligning the text again. 0 disables the cache.
+     */
+    static void setLayoutCacheCapacity(size_t capacity);
+    static size_t getLayoutCacheCapacity();
+
+    /** Removes all cached text layouts. */
+    static void clearLayoutCache();
     
     /**
      * Constructor of Label.
@@ -539,6 +550,27 @@ protected:
         STRING_TEXTURE
     };
 
+    /** The settings the current letter layout and quads were built with, to tell whether a new string can be laid out incrementally. */
+    struct LayoutState
+    {
+        bool valid;
+        FontAtlas* fontAtlas;
+        unsigned int atlasGeneration;
+        unsigned int textureRevision;
+        float fontScale;
+        float lineHeight;
+        float lineSpacing;
+        float additionalKerning;
+        float labelWidth;
+        float labelHeight;
+        float maxLineWidth;
+        TextHAlignment hAlignment;
+        TextVAlignment vAlignment;
+        Overflow overflow;
+        bool enableWrap;
+        bool lineBreakWithoutSpaces;
+    };
+
     virtual void setFontAtlas(FontAtlas* atlas, bool distanceFieldEnabled = false, bool useA8Shader = false);
 
     void computeStringNumLines();
@@ -550,6 +582,8 @@ protected:
     bool multilineTextWrapByChar();
     bool multilineTextWrapByWord();
     bool multilineTextWrap(const std::function<int(const std::u32string&, int, int)>& lambda);
+    int wrapLetters(const std::function<int(const std::u32string&, int, int)>& nextTokenLen, int startIndex, int endIndex, int lineIndex, float startX,
+        const int* kernings, int kerningsIndex, std::vector<float>& linesWidth, float& highestY, float& lowestY);
     void shrinkLabelToContentSize(const std::function<bool(void)>& lambda);
     bool isHorizontalClamp();
     bool isVerticalClamp();
@@ -575,6 +609,13 @@ protected:
     bool isHorizontalClamped(float letterPositionX, int lineIndex);
     void restoreFontSize();
     void updateLetterSpriteScale(Sprite* sprite);
+    void updateFontScale(float fontSize);
+    bool restoreCachedLayout();
+    void storeCachedLayout();
+    void recordLayoutState();
+    bool updateLettersIncrementally();
+    void insertLetterQuad(int letterIndex, int textureID, float py);
+    void updateQuadColors(TextureAtlas* textureAtlas, ssize_t firstQuad, ssize_t quadCount);
 	int getFirstCharLen(const std::u32string& utf32Text, int startIndex, int textLen);
 	int getFirstWordLen(const std::u32string& utf32Text, int startIndex, int textLen);
 
@@ -600,8 +641,14 @@ protected:
     Sprite* _shadowNode;
 
     FontAtlas* _fontAtlas;
+    unsigned int _fontAtlasRevision;
+    unsigned int _fontAtlasGlyphRevision;
+    /** Scale from the size the font atlas was rasterized at to the requested font size. */
+    float _fontScale;
+    bool _waitingForGlyphs;
     Vector<SpriteBatchNode*> _batchNodes;
     std::vector<LetterInfo> _lettersInfo;
+    LayoutState _layoutState;
 
     //! used for optimization
     Sprite *_reusedLetter;
@@ -639,6 +686,7 @@ protected:
     GLint _uniformEffectColor;
     GLint _uniformEffectType; // 0: None, 1: Outline, 2: Shadow; Only used when outline is enabled.
     GLint _uniformTextColor;
+    GLint _uniformSmoothing;
     bool _useDistanceField;
     bool _useA8Shader;
 
@@ -678,6 +726,8 @@ protected:
     bool _strikethroughEnabled;
 
 private:
+    friend class LabelLayoutCache;
+
     CC_DISALLOW_COPY_AND_ASSIGN(Label);
 };
 
@@ -57,6 +57,7 @@ NS_CC_BEGIN
 
 // FIXME:: Yes, nodes might have a sort problem once every 30 days if the game runs at 60 FPS and each frame sprites are reordered.
 std::uint32_t Node::s_globalOrderOfArrival = 0;
+std::uint32_t Node::s_cachingNodeCount = 0;
 
 // MARK: Constructor, Destructor, Init
 
@@ -85,6 +86,7 @@ Node::Node()
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
 , _isTransitionFinished(false)
+, _cachesSubtree(false)
 , _displayedOpacity(255)
 , _realOpacity(255)
 , _displayedColor(Color3B::WHITE)
@@ -173,6 +175,7 @@ void Node::setLocalZOrder(std::int32_t z)
     if (_parent)
     {
         _parent->reorderChild(this, z);
+        invalidateCachedAncestors();
     }
 }
 
@@ -183,6 +186,22 @@ void Node::_setLocalZOrder(std::int32_t z)
     _localZOrder = z;
 }
 
+void Node::invalidateCachedAncestors()
+{
+    if (s_cachingNodeCount == 0)
+    {
+        return;
+    }
+
+    for (Node* node = _parent; node != nullptr; node = node->_parent)
+    {
+        if (node->_cachesSubtree)
+        {
+            node->onCachedSubtreeDirty();
+        }
+    }
+}
+
 void Node::updateOrderOfArrival()
 {
     _orderOfArrival = (++s_globalOrderOfArrival);
@@ -199,6 +218,7 @@ void Node::makeDirty()
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
     _selfFlags |= FLAGS_CONTENT_SIZE_DIRTY;
+    invalidateCachedAncestors();
 }
 
 /// rotation setter
@@ -210,6 +230,7 @@ void Node::setRotation(float rotation)
     _rotationX = rotation;
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
     
     updateRotationQuat();
 }
@@ -232,6 +253,7 @@ void Node::setRotationQuat(const Quaternion& quat)
     _rotationQuat = quat;
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 }
 
 Quaternion Node::getRotationQuat() const
@@ -281,6 +303,7 @@ void Node::setScaleX(float scaleX)
     _scaleX = scaleX;
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 }
 
 /// scaleY getter
@@ -298,6 +321,7 @@ void Node::setScaleY(float scaleY)
     _scaleY = scaleY;
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 }
 
 
@@ -339,6 +363,7 @@ void Node::setPosition(float x, float y)
     
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
     _usingNormalizedPosition = false;
 }
 
@@ -385,6 +410,7 @@ void Node::setPositionZ(float positionZ)
     
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 
     _positionZ = positionZ;
 }
@@ -406,6 +432,7 @@ void Node::setPositionNormalized(const Vec2& position)
     _normalizedPositionDirty = true;
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -430,6 +457,8 @@ void Node::setVisible(bool visible)
             _transformDirty = _inverseDirty = true;
             _selfFlags |= FLAGS_TRANSFORM_DIRTY;
         }
+
+        invalidateCachedAncestors();
     }
 }
 
@@ -452,6 +481,7 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformDirty = _inverseDirty = true;
         _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+        invalidateCachedAncestors();
     }
 }
 
@@ -470,7 +500,7 @@ void Node::setContentSize(const CSize & size)
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformDirty = _inverseDirty = true;
         _selfFlags |= FLAGS_CONTENT_SIZE_DIRTY;
-        _selfFlags |= FLAGS_CONTENT_SIZE_DIRTY;
+        invalidateCachedAncestors();
     }
 }
 
@@ -486,6 +516,7 @@ void Node::setParent(Node * parent)
     _parent = parent;
     _transformDirty = _inverseDirty = true;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 }
 
 /// isRelativeAnchorPoint getter
@@ -502,6 +533,7 @@ void Node::setIgnoreAnchorPointForPosition(bool newValue)
         _ignoreAnchorPointForPosition = newValue;
         _transformDirty = _inverseDirty = true;
         _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+        invalidateCachedAncestors();
     }
 }
 
@@ -530,6 +562,8 @@ void Node::setGLProgramState(cocos2d::GLProgramState* glProgramState)
 
         if (_glProgramState)
             _glProgramState->setNodeBinding(this);
+
+        invalidateCachedAncestors();
     }
 }
 
@@ -543,6 +577,8 @@ void Node::setGLProgram(GLProgram* glProgram)
         _glProgramState->retain();
 
         _glProgramState->setNodeBinding(this);
+
+        invalidateCachedAncestors();
     }
 }
 
@@ -641,6 +677,7 @@ void Node::addChildInsert(Node *child, int index, bool isReentry)
 	}
 
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 	_reorderChildDirty = true;
 	_children.insert(std::min(index, (int)_children.size()), child);
 	child->_setLocalZOrder(0);
@@ -745,6 +782,7 @@ void Node::removeChildNoExit(Node* child)
 
     if( index != CC_INVALID_INDEX )
     {
+        child->invalidateCachedAncestors();
         child->setParent(nullptr);
 
         _children.erase(index);
@@ -793,6 +831,7 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
         }
 
         // set parent nil at the end
+        child->invalidateCachedAncestors();
         child->setParent(nullptr);
     }
     
@@ -823,6 +862,7 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
     }
 
     // set parent nil at the end
+    child->invalidateCachedAncestors();
     child->setParent(nullptr);
 
     _children.erase(childIndex);
@@ -838,6 +878,7 @@ void Node::insertChild(Node* child, int z)
 	}
     
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
     _reorderChildDirty = true;
     _children.pushBack(child);
     child->_setLocalZOrder(z);
@@ -1148,6 +1189,7 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _selfFlags |= FLAGS_TRANSFORM_DIRTY;
+    invalidateCachedAncestors();
 }
 
 AffineTransform Node::getParentToNodeAffineTransform() const
@@ -1272,13 +1314,22 @@ void Node::setOpacity(GLubyte opacity)
     }
 
     _displayedOpacity = _realOpacity = opacity;
+    invalidateCachedAncestors();
     
     updateCascadeOpacity();
 }
 
 void Node::updateDisplayedOpacity(GLubyte parentOpacity)
 {
-    _displayedOpacity = _realOpacity * parentOpacity/255.0;
+    GLubyte displayedOpacity = _realOpacity * parentOpacity/255.0;
+
+    // sortAllChildren() cascades the opacity on every visit, so only actual changes invalidate caches
+    if (displayedOpacity != _displayedOpacity)
+    {
+        invalidateCachedAncestors();
+    }
+
+    _displayedOpacity = displayedOpacity;
     updateColor();
     
     if (_cascadeOpacityEnabled)
@@ -1356,6 +1407,11 @@ const Color3B& Node::getDisplayedColor() const
 
 void Node::setColor(const Color3B& color)
 {
+    if (color != _realColor)
+    {
+        invalidateCachedAncestors();
+    }
+
     _displayedColor = _realColor = color;
     
     updateCascadeColor();
@@ -1363,9 +1419,17 @@ void Node::setColor(const Color3B& color)
 
 void Node::updateDisplayedColor(const Color3B& parentColor)
 {
-    _displayedColor.r = _realColor.r * parentColor.r/255.0;
-    _displayedColor.g = _realColor.g * parentColor.g/255.0;
-    _displayedColor.b = _realColor.b * parentColor.b/255.0;
+    Color3B displayedColor;
+    displayedColor.r = _realColor.r * parentColor.r/255.0;
+    displayedColor.g = _realColor.g * parentColor.g/255.0;
+    displayedColor.b = _realColor.b * parentColor.b/255.0;
+
+    if (displayedColor != _displayedColor)
+    {
+        invalidateCachedAncestors();
+    }
+
+    _displayedColor = displayedColor;
     updateColor();
     
     if (_cascadeColorEnabled)
@@ -1218,6 +1218,12 @@ protected:
     // update quaternion from Rotation
     void updateRotationQuat();
 
+    /// Tells the CachedNode ancestors of this node that their cached rendering is out of date.
+    void invalidateCachedAncestors();
+
+    /// Called on a node with _cachesSubtree set when something below it changed, see CachedNode.
+    virtual void onCachedSubtreeDirty() {}
+
 private:
     void addChildHelper(Node* child, int localZOrder, const std::string &name, bool isReentry = false);
     
@@ -1260,6 +1266,7 @@ protected:
     };
 
     static std::uint32_t s_globalOrderOfArrival;
+    static std::uint32_t s_cachingNodeCount;    ///< number of nodes with _cachesSubtree set, invalidation is skipped while it is zero
 
     Vector<Node*> _children;        ///< array of children nodes
     Node *_parent;                  ///< weak reference to parent node
@@ -1277,6 +1284,7 @@ protected:
                                           ///< Used by Layer and Scene.
     bool _reorderChildDirty;          ///< children order dirty flag
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
+    bool _cachesSubtree;              ///< true if this node renders its children into a cache, see CachedNode
     
     // opacity controls
     GLubyte     _displayedOpacity;
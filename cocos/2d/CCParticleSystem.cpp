@@ -45,6 +45,7 @@ THE SOFTWARE.
 
 #include "2d/CCParticleSystem.h"
 
+#include <cfloat>
 #include <string>
 
 #include "2d/CCParticleBatchNode.h"
@@ -56,6 +57,14 @@ THE SOFTWARE.
 #include "renderer/CCTextureCache.h"
 #include "platform/CCFileUtils.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_PARTICLE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define CC_PARTICLE_NEON 1
+#include <arm_neon.h>
+#endif
+
 using namespace std;
 
 NS_CC_BEGIN
@@ -101,6 +110,7 @@ inline void normalize_point(float x, float y, particle_point* out)
 
 /**
  A more effect random number getter function, get from ejoy2d.
+ The seed is a persistent stream per system, so the mantissa comes from the high bits: the low 15 bits of this generator repeat every 32768 calls.
  */
 inline static float RANDOM_M11(unsigned int *seed) {
     *seed = *seed * 134775813 + 1;
@@ -108,92 +118,466 @@ inline static float RANDOM_M11(unsigned int *seed) {
         uint32_t d;                                     
         float f;
     } u;
-    u.d = (((uint32_t)(*seed) & 0x7fff) << 8) | 0x40000000;
+    u.d = ((((uint32_t)(*seed) >> 16) & 0x7fff) << 8) | 0x40000000;
     return u.f - 3.0f;
 }
 
+#if defined(CC_PARTICLE_SSE2) || defined(CC_PARTICLE_NEON)
+
+// Four lane helpers, so the particle kernels below are written once for SSE2 and NEON
+#if defined(CC_PARTICLE_SSE2)
+typedef __m128 float4;
+
+static inline float4 load4(const float* p) { return _mm_loadu_ps(p); }
+static inline void store4(float* p, float4 v) { _mm_storeu_ps(p, v); }
+static inline float4 splat4(float f) { return _mm_set1_ps(f); }
+static inline float4 add4(float4 a, float4 b) { return _mm_add_ps(a, b); }
+static inline float4 sub4(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+static inline float4 mul4(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+static inline float4 max4(float4 a, float4 b) { return _mm_max_ps(a, b); }
+
+// 1 / sqrt(n) from the hardware estimate refined by one Newton-Raphson step (relative error below 2e-7), 0 where n is zero, denormal or infinite
+static inline float4 rsqrt4(float4 n)
+{
+    float4 estimate = _mm_rsqrt_ps(n);
+    estimate = _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), n), _mm_mul_ps(estimate, estimate))));
+
+    return _mm_and_ps(estimate, _mm_and_ps(_mm_cmpge_ps(n, _mm_set1_ps(FLT_MIN)), _mm_cmple_ps(n, _mm_set1_ps(FLT_MAX))));
+}
+#else
+typedef float32x4_t float4;
+
+static inline float4 load4(const float* p) { return vld1q_f32(p); }
+static inline void store4(float* p, float4 v) { vst1q_f32(p, v); }
+static inline float4 splat4(float f) { return vdupq_n_f32(f); }
+static inline float4 add4(float4 a, float4 b) { return vaddq_f32(a, b); }
+static inline float4 sub4(float4 a, float4 b) { return vsubq_f32(a, b); }
+static inline float4 mul4(float4 a, float4 b) { return vmulq_f32(a, b); }
+static inline float4 max4(float4 a, float4 b) { return vmaxq_f32(a, b); }
+
+// 1 / sqrt(n) from the hardware estimate refined by two Newton-Raphson steps (relative error below 2e-7), 0 where n is zero, denormal or infinite
+static inline float4 rsqrt4(float4 n)
+{
+    float4 estimate = vrsqrteq_f32(n);
+    estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(n, estimate), estimate));
+    estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(n, estimate), estimate));
+
+    uint32x4_t valid = vandq_u32(vcgeq_f32(n, vdupq_n_f32(FLT_MIN)), vcleq_f32(n, vdupq_n_f32(FLT_MAX)));
+
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(estimate), valid));
+}
+#endif
+
+/*
+ * Sine and cosine of four angles in radians. The angle is reduced to [-pi/4, pi/4] around the nearest multiple of pi/2,
+ * then evaluated with the Cephes single precision polynomials. The absolute error stays below 1e-6 for |angle| < 8192,
+ * which radius mode particles never leave: their angle only grows by degreesPerSecond over their lifetime.
+ */
+static inline void sinCos4(float4 angle, float4& outSin, float4& outCos)
+{
+#if defined(CC_PARTICLE_SSE2)
+    __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(0.636619772f)));
+    float4 multiple = _mm_cvtepi32_ps(quadrant);
+#else
+    float4 scaled = vmulq_f32(angle, vdupq_n_f32(0.636619772f));
+    int32x4_t quadrant = vcvtq_s32_f32(vaddq_f32(scaled, vbslq_f32(vcltq_f32(scaled, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f))));
+    float4 multiple = vcvtq_f32_s32(quadrant);
+#endif
+
+    // pi / 2 split in three parts, so that the reduction stays exact for large multiples
+    float4 r = sub4(angle, mul4(multiple, splat4(1.5703125f)));
+    r = sub4(r, mul4(multiple, splat4(4.837512969970703125e-4f)));
+    r = sub4(r, mul4(multiple, splat4(7.54978995489188216e-8f)));
+
+    float4 r2 = mul4(r, r);
+    float4 sinR = add4(mul4(splat4(-1.9515295891e-4f), r2), splat4(8.3321608736e-3f));
+    sinR = add4(mul4(sinR, r2), splat4(-1.6666654611e-1f));
+    sinR = add4(mul4(mul4(sinR, r2), r), r);
+
+    float4 cosR = add4(mul4(splat4(2.443315711809948e-5f), r2), splat4(-1.388731625493765e-3f));
+    cosR = add4(mul4(cosR, r2), splat4(4.166664568298827e-2f));
+    cosR = add4(sub4(mul4(mul4(cosR, r2), r2), mul4(splat4(0.5f), r2)), splat4(1.0f));
+
+    // Odd quadrants swap sine and cosine, the quadrant also decides the signs
+#if defined(CC_PARTICLE_SSE2)
+    float4 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    float4 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+    float4 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+    outSin = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosR), _mm_andnot_ps(swap, sinR)), sinSign);
+    outCos = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sinR), _mm_andnot_ps(swap, cosR)), cosSign);
+#else
+    uint32x4_t swap = vtstq_s32(quadrant, vdupq_n_s32(1));
+    uint32x4_t sinSign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(quadrant), vdupq_n_u32(2)), 30);
+    uint32x4_t cosSign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(vaddq_s32(quadrant, vdupq_n_s32(1))), vdupq_n_u32(2)), 30);
+
+    outSin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cosR, sinR)), sinSign));
+    outCos = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sinR, cosR)), cosSign));
+#endif
+}
+
+// Lifetime, color, size and rotation of particles [index, index + 4), shared by both modes
+static inline void updateParticleAttributes4(ParticleData& data, int index, float4 dt)
+{
+    store4(data.timeToLive + index, sub4(load4(data.timeToLive + index), dt));
+
+    store4(data.colorR + index, add4(load4(data.colorR + index), mul4(load4(data.deltaColorR + index), dt)));
+    store4(data.colorG + index, add4(load4(data.colorG + index), mul4(load4(data.deltaColorG + index), dt)));
+    store4(data.colorB + index, add4(load4(data.colorB + index), mul4(load4(data.deltaColorB + index), dt)));
+    store4(data.colorA + index, add4(load4(data.colorA + index), mul4(load4(data.deltaColorA + index), dt)));
+
+    float4 size = add4(load4(data.size + index), mul4(load4(data.deltaSize + index), dt));
+    store4(data.size + index, max4(size, splat4(0.0f)));
+
+    store4(data.rotation + index, add4(load4(data.rotation + index), mul4(load4(data.deltaRotation + index), dt)));
+}
+
+// Bit n is set if particle n of the four is still alive
+static inline int getAliveMask4(const float* timeToLive)
+{
+#if defined(CC_PARTICLE_SSE2)
+    return _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(timeToLive), _mm_setzero_ps()));
+#else
+    uint32x4_t alive = vshrq_n_u32(vcgtq_f32(vld1q_f32(timeToLive), vdupq_n_f32(0.0f)), 31);
+
+    return (int)(vgetq_lane_u32(alive, 0) | (vgetq_lane_u32(alive, 1) << 1) | (vgetq_lane_u32(alive, 2) << 2) | (vgetq_lane_u32(alive, 3) << 3));
+#endif
+}
+
+// Returns the number of particles integrated, the caller finishes the remaining count % 4
+static int updateGravityParticles4(ParticleData& data, int count, float dt, float gravityX, float gravityY, float yCoordFlipped)
+{
+    const float4 dt4 = splat4(dt);
+    const float4 moveScale = splat4(dt * yCoordFlipped);
+    const float4 gravityX4 = splat4(gravityX);
+    const float4 gravityY4 = splat4(gravityY);
+    int index = 0;
+
+    for (; index + 4 <= count; index += 4)
+    {
+        float4 x = load4(data.posx + index);
+        float4 y = load4(data.posy + index);
+        float4 inverseLength = rsqrt4(add4(mul4(x, x), mul4(y, y)));
+        float4 radialX = mul4(x, inverseLength);
+        float4 radialY = mul4(y, inverseLength);
+        float4 radialAccel = load4(data.modeA.radialAccel + index);
+        float4 tangentialAccel = load4(data.modeA.tangentialAccel + index);
+
+        // (gravity + radial + tangential) * dt, the tangent is the radial direction turned by 90 degrees
+        float4 accelX = add4(sub4(mul4(radialX, radialAccel), mul4(radialY, tangentialAccel)), gravityX4);
+        float4 accelY = add4(add4(mul4(radialY, radialAccel), mul4(radialX, tangentialAccel)), gravityY4);
+        float4 dirX = add4(load4(data.modeA.dirX + index), mul4(accelX, dt4));
+        float4 dirY = add4(load4(data.modeA.dirY + index), mul4(accelY, dt4));
+
+        store4(data.modeA.dirX + index, dirX);
+        store4(data.modeA.dirY + index, dirY);
+        store4(data.posx + index, add4(x, mul4(dirX, moveScale)));
+        store4(data.posy + index, add4(y, mul4(dirY, moveScale)));
+
+        updateParticleAttributes4(data, index, dt4);
+    }
+
+    return index;
+}
+
+// Returns the number of particles integrated, the caller finishes the remaining count % 4
+static int updateRadiusParticles4(ParticleData& data, int count, float dt, float yCoordFlipped)
+{
+    const float4 dt4 = splat4(dt);
+    const float4 minusOne = splat4(-1.0f);
+    const float4 minusYCoordFlipped = splat4(-yCoordFlipped);
+    int index = 0;
+
+    for (; index + 4 <= count; index += 4)
+    {
+        float4 angle = add4(load4(data.modeB.angle + index), mul4(load4(data.modeB.degreesPerSecond + index), dt4));
+        float4 radius = add4(load4(data.modeB.radius + index), mul4(load4(data.modeB.deltaRadius + index), dt4));
+        float4 sinAngle;
+        float4 cosAngle;
+
+        sinCos4(angle, sinAngle, cosAngle);
+
+        store4(data.modeB.angle + index, angle);
+        store4(data.modeB.radius + index, radius);
+        store4(data.posx + index, mul4(mul4(cosAngle, radius), minusOne));
+        store4(data.posy + index, mul4(mul4(sinAngle, radius), minusYCoordFlipped));
+
+        updateParticleAttributes4(data, index, dt4);
+    }
+
+    return index;
+}
+
+#endif // CC_PARTICLE_SSE2 || CC_PARTICLE_NEON
+
+static inline void updateParticleAttributes(ParticleData& data, int index, float dt)
+{
+    data.timeToLive[index] -= dt;
+
+    data.colorR[index] += data.deltaColorR[index] * dt;
+    data.colorG[index] += data.deltaColorG[index] * dt;
+    data.colorB[index] += data.deltaColorB[index] * dt;
+    data.colorA[index] += data.deltaColorA[index] * dt;
+    data.size[index] += (data.deltaSize[index] * dt);
+    data.size[index] = MAX(0, data.size[index]);
+    data.rotation[index] += data.deltaRotation[index] * dt;
+}
+
+/*
+ * Integrates every particle of a gravity mode system in one pass over the arrays: lifetime, radial and tangential acceleration,
+ * movement, color, size and rotation. Four particles at a time where SSE2 or NEON is available.
+ */
+static void updateGravityParticles(ParticleData& data, int count, float dt, float gravityX, float gravityY, float yCoordFlipped)
+{
+    int index = 0;
+
+#if defined(CC_PARTICLE_SSE2) || defined(CC_PARTICLE_NEON)
+    index = updateGravityParticles4(data, count, dt, gravityX, gravityY, yCoordFlipped);
+#endif
+
+    for (; index < count; ++index)
+    {
+        particle_point tmp, radial = {0.0f, 0.0f}, tangential;
+
+        // radial acceleration
+        if (data.posx[index] || data.posy[index])
+        {
+            normalize_point(data.posx[index], data.posy[index], &radial);
+        }
+        tangential = radial;
+        radial.x *= data.modeA.radialAccel[index];
+        radial.y *= data.modeA.radialAccel[index];
+
+        // tangential acceleration
+        std::swap(tangential.x, tangential.y);
+        tangential.x *= - data.modeA.tangentialAccel[index];
+        tangential.y *= data.modeA.tangentialAccel[index];
+
+        // (gravity + radial + tangential) * dt
+        tmp.x = radial.x + tangential.x + gravityX;
+        tmp.y = radial.y + tangential.y + gravityY;
+        tmp.x *= dt;
+        tmp.y *= dt;
+
+        data.modeA.dirX[index] += tmp.x;
+        data.modeA.dirY[index] += tmp.y;
+
+        // this is cocos2d-x v3.0
+        tmp.x = data.modeA.dirX[index] * dt * yCoordFlipped;
+        tmp.y = data.modeA.dirY[index] * dt * yCoordFlipped;
+        data.posx[index] += tmp.x;
+        data.posy[index] += tmp.y;
+
+        updateParticleAttributes(data, index, dt);
+    }
+}
+
+/*
+ * Integrates every particle of a radius mode system in one pass over the arrays, the radius mode counterpart of updateGravityParticles().
+ */
+static void updateRadiusParticles(ParticleData& data, int count, float dt, float yCoordFlipped)
+{
+    int index = 0;
+
+#if defined(CC_PARTICLE_SSE2) || defined(CC_PARTICLE_NEON)
+    index = updateRadiusParticles4(data, count, dt, yCoordFlipped);
+#endif
+
+    for (; index < count; ++index)
+    {
+        data.modeB.angle[index] += data.modeB.degreesPerSecond[index] * dt;
+        data.modeB.radius[index] += data.modeB.deltaRadius[index] * dt;
+        data.posx[index] = - cosf(data.modeB.angle[index]) * data.modeB.radius[index];
+        data.posy[index] = - sinf(data.modeB.angle[index]) * data.modeB.radius[index] * yCoordFlipped;
+
+        updateParticleAttributes(data, index, dt);
+    }
+}
+
 ParticleData::ParticleData()
+: compactionIndices(nullptr)
+, maxCount(0)
+, _arena(nullptr)
+{
+    float** streams[FLOAT_STREAM_COUNT];
+    getFloatStreams(streams);
+
+    for (auto stream : streams)
+    {
+        *stream = nullptr;
+    }
+
+    atlasIndex = nullptr;
+}
+
+void ParticleData::getFloatStreams(float** outStreams[FLOAT_STREAM_COUNT])
 {
-    memset(this, 0, sizeof(ParticleData));
+    float** streams[] = {
+        &posx, &posy, &startPosX, &startPosY,
+        &colorR, &colorG, &colorB, &colorA,
+        &deltaColorR, &deltaColorG, &deltaColorB, &deltaColorA,
+        &size, &deltaSize, &rotation, &deltaRotation, &timeToLive,
+        &modeA.dirX, &modeA.dirY, &modeA.radialAccel, &modeA.tangentialAccel,
+        &modeB.angle, &modeB.degreesPerSecond, &modeB.radius, &modeB.deltaRadius,
+    };
+
+    static_assert(sizeof(streams) / sizeof(streams[0]) == FLOAT_STREAM_COUNT, "ParticleData::FLOAT_STREAM_COUNT is out of date");
+
+    memcpy(outStreams, streams, sizeof(streams));
 }
 
 bool ParticleData::init(int count)
 {
+    release();
+
     maxCount = count;
 
-    range = std::vector<int>(count);
+    // One allocation per system. Every stream starts on its own cache line, so streams never share a line and their SIMD blocks stay aligned.
+    const size_t cacheLine = 64;
+    size_t streamSize = (count * sizeof(float) + cacheLine - 1) & ~(cacheLine - 1);
+    size_t compactionSize = (2 * count * sizeof(int) + cacheLine - 1) & ~(cacheLine - 1);
+
+    _arena = malloc(streamSize * (FLOAT_STREAM_COUNT + 1) + compactionSize + cacheLine - 1);
+
+    if (_arena == nullptr)
+    {
+        return false;
+    }
+
+    unsigned char* cursor = (unsigned char*)(((uintptr_t)_arena + cacheLine - 1) & ~(uintptr_t)(cacheLine - 1));
+    float** streams[FLOAT_STREAM_COUNT];
+    getFloatStreams(streams);
 
-    for (int index = 0; index < count; index++)
+    for (auto stream : streams)
     {
-        range[index] = index;
+        *stream = (float*)cursor;
+        cursor += streamSize;
     }
-    
-    posx= (float*)malloc(count * sizeof(float));
-    posy= (float*)malloc(count * sizeof(float));
-    startPosX= (float*)malloc(count * sizeof(float));
-    startPosY= (float*)malloc(count * sizeof(float));
-    colorR= (float*)malloc(count * sizeof(float));
-    colorG= (float*)malloc(count * sizeof(float));
-    colorB= (float*)malloc(count * sizeof(float));
-    colorA= (float*)malloc(count * sizeof(float));
-    deltaColorR= (float*)malloc(count * sizeof(float));
-    deltaColorG= (float*)malloc(count * sizeof(float));
-    deltaColorB= (float*)malloc(count * sizeof(float));
-    deltaColorA= (float*)malloc(count * sizeof(float));
-    size= (float*)malloc(count * sizeof(float));
-    deltaSize= (float*)malloc(count * sizeof(float));
-    rotation= (float*)malloc(count * sizeof(float));
-    deltaRotation= (float*)malloc(count * sizeof(float));
-    timeToLive= (float*)malloc(count * sizeof(float));
-    atlasIndex= (unsigned int*)malloc(count * sizeof(unsigned int));
-    
-    modeA.dirX= (float*)malloc(count * sizeof(float));
-    modeA.dirY= (float*)malloc(count * sizeof(float));
-    modeA.radialAccel= (float*)malloc(count * sizeof(float));
-    modeA.tangentialAccel= (float*)malloc(count * sizeof(float));
-    
-    modeB.angle= (float*)malloc(count * sizeof(float));
-    modeB.degreesPerSecond= (float*)malloc(count * sizeof(float));
-    modeB.deltaRadius= (float*)malloc(count * sizeof(float));
-    modeB.radius= (float*)malloc(count * sizeof(float));
-    
-    return posx && posy && startPosY && startPosX && colorR && colorG && colorB && colorA &&
-    deltaColorR && deltaColorG && deltaColorB && deltaColorA && size && deltaSize &&
-    rotation && deltaRotation && timeToLive && atlasIndex && modeA.dirX && modeA.dirY &&
-    modeA.radialAccel && modeA.tangentialAccel && modeB.angle && modeB.degreesPerSecond &&
-    modeB.deltaRadius && modeB.radius;
+
+    atlasIndex = (unsigned int*)cursor;
+    cursor += streamSize;
+    compactionIndices = (int*)cursor;
+
+    return true;
 }
 
 void ParticleData::release()
 {
-    CC_SAFE_FREE(posx);
-    CC_SAFE_FREE(posy);
-    CC_SAFE_FREE(startPosX);
-    CC_SAFE_FREE(startPosY);
-    CC_SAFE_FREE(colorR);
-    CC_SAFE_FREE(colorG);
-    CC_SAFE_FREE(colorB);
-    CC_SAFE_FREE(colorA);
-    CC_SAFE_FREE(deltaColorR);
-    CC_SAFE_FREE(deltaColorG);
-    CC_SAFE_FREE(deltaColorB);
-    CC_SAFE_FREE(deltaColorA);
-    CC_SAFE_FREE(size);
-    CC_SAFE_FREE(deltaSize);
-    CC_SAFE_FREE(rotation);
-    CC_SAFE_FREE(deltaRotation);
-    CC_SAFE_FREE(timeToLive);
-    CC_SAFE_FREE(atlasIndex);
-    
-    CC_SAFE_FREE(modeA.dirX);
-    CC_SAFE_FREE(modeA.dirY);
-    CC_SAFE_FREE(modeA.radialAccel);
-    CC_SAFE_FREE(modeA.tangentialAccel);
-    
-    CC_SAFE_FREE(modeB.angle);
-    CC_SAFE_FREE(modeB.degreesPerSecond);
-    CC_SAFE_FREE(modeB.deltaRadius);
-    CC_SAFE_FREE(modeB.radius);
+    CC_SAFE_FREE(_arena);
+
+    float** streams[FLOAT_STREAM_COUNT];
+    getFloatStreams(streams);
+
+    for (auto stream : streams)
+    {
+        *stream = nullptr;
+    }
+
+    atlasIndex = nullptr;
+    compactionIndices = nullptr;
+}
+
+int ParticleData::removeDeadParticles(int count)
+{
+    int firstDead = 0;
+
+#if defined(CC_PARTICLE_SSE2) || defined(CC_PARTICLE_NEON)
+    // Most frames nothing dies, skip the leading survivors four at a time
+    while (firstDead + 4 <= count && getAliveMask4(timeToLive + firstDead) == 0xF)
+    {
+        firstDead += 4;
+    }
+#endif
+
+    while (firstDead < count && timeToLive[firstDead] > 0.0f)
+    {
+        firstDead++;
+    }
+
+    if (firstDead == count)
+    {
+        return count;
+    }
+
+    int remaining = count - firstDead;
+    int* survivors = compactionIndices;
+    int* dead = survivors + remaining;
+    int survivorCount = 0;
+    int deadCount = 0;
+    int index = firstDead;
+
+    // Both lists are written for every particle and only the matching count advances, so there is no branch per particle
+#if defined(CC_PARTICLE_SSE2) || defined(CC_PARTICLE_NEON)
+    for (; index + 4 <= count; index += 4)
+    {
+        int aliveMask = getAliveMask4(timeToLive + index);
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            int alive = (aliveMask >> lane) & 1;
+            survivors[survivorCount] = index + lane;
+            dead[deadCount] = index + lane;
+            survivorCount += alive;
+            deadCount += 1 - alive;
+        }
+    }
+#endif
+
+    for (; index < count; ++index)
+    {
+        int alive = timeToLive[index] > 0.0f ? 1 : 0;
+        survivors[survivorCount] = index;
+        dead[deadCount] = index;
+        survivorCount += alive;
+        deadCount += 1 - alive;
+    }
+
+    // Read the atlas indices of the dead particles before the survivors overwrite them
+    for (int k = 0; k < deadCount; ++k)
+    {
+        dead[k] = (int)atlasIndex[dead[k]];
+    }
+
+    float** streams[FLOAT_STREAM_COUNT];
+    getFloatStreams(streams);
+
+    // Survivors only ever move towards the front, so every stream is compacted in place, one stream at a time
+    for (auto stream : streams)
+    {
+        float* array = *stream;
+        float* destination = array + firstDead;
+
+        for (int k = 0; k < survivorCount; ++k)
+        {
+            destination[k] = array[survivors[k]];
+        }
+    }
+
+    for (int k = 0; k < survivorCount; ++k)
+    {
+        atlasIndex[firstDead + k] = atlasIndex[survivors[k]];
+    }
+
+    for (int k = 0; k < deadCount; ++k)
+    {
+        atlasIndex[firstDead + survivorCount + k] = (unsigned int)dead[k];
+    }
+
+    return firstDead + survivorCount;
+}
+
+// Systems whose update() queued a simulation step, retained until updatePendingParticleSystems() runs it
+static std::vector<ParticleSystem*> s_pendingSystems;
+static bool s_parallelUpdateEnabled = true;
+static uint32_t s_randomSeedCounter = 0;
+static const std::string s_pendingSystemsKey = "ParticleSystem::updatePendingParticleSystems";
+
+static uint32_t nextRandomSeed()
+{
+    // Spreads consecutive counters over the whole seed range
+    uint32_t seed = (s_randomSeedCounter++) * 2654435761u;
+
+    return seed ^ (seed >> 16);
 }
 
 Vector<ParticleSystem*> ParticleSystem::__allInstances;
@@ -236,6 +620,10 @@ ParticleSystem::ParticleSystem()
 , _positionType(PositionType::FREE)
 , _paused(false)
 , _canUpdate(true)
+, _randomSeed(nextRandomSeed())
+, _updatePending(false)
+, _updateDeltaTime(0)
+, _removedLastParticle(false)
 , _sourcePositionCompatible(true) // In the furture this member's default value maybe false or be removed.
 {
     modeA.gravity.setZero();
@@ -290,6 +678,70 @@ void ParticleSystem::setTotalParticleCountFactor(float factor)
     __totalParticleCountFactor = factor;
 }
 
+void ParticleSystem::setParallelUpdateEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        updatePendingParticleSystems();
+    }
+
+    s_parallelUpdateEnabled = enabled;
+}
+
+bool ParticleSystem::isParallelUpdateEnabled()
+{
+    return s_parallelUpdateEnabled;
+}
+
+void ParticleSystem::setRandomSeedBase(uint32_t seed)
+{
+    s_randomSeedCounter = seed;
+}
+
+void ParticleSystem::updatePendingParticleSystems()
+{
+    if (s_pendingSystems.empty())
+    {
+        return;
+    }
+
+    // Finishing a system can remove nodes and queue other systems, so work on a list of our own
+    std::vector<ParticleSystem*> systems;
+    systems.swap(s_pendingSystems);
+
+    // Systems updated twice since the last call already ran their first step synchronously
+    std::vector<ParticleSystem*> pendingSystems;
+    pendingSystems.reserve(systems.size());
+
+    for (auto system : systems)
+    {
+        if (system->_updatePending)
+        {
+            pendingSystems.push_back(system);
+        }
+    }
+
+    TRY_PARALLELIZE(
+        pendingSystems.begin(),
+        pendingSystems.end(),
+        [](ParticleSystem* system)
+        {
+            system->simulate();
+        }
+    );
+
+    for (auto system : pendingSystems)
+    {
+        system->_updatePending = false;
+        system->finishUpdate();
+    }
+
+    for (auto system : systems)
+    {
+        system->release();
+    }
+}
+
 bool ParticleSystem::init()
 {
     return initWithTotalParticles(150);
@@ -629,7 +1081,7 @@ void ParticleSystem::addParticles(int count)
 {
     if (_paused)
         return;
-    uint32_t RANDSEED = rand();
+    uint32_t RANDSEED = _randomSeed;
 
     int start = _particleCount;
     _particleCount += count;
@@ -725,6 +1177,8 @@ void ParticleSystem::addParticles(int count)
         
         }
     }
+
+    _randomSeed = RANDSEED;
 }
 
 void ParticleSystem::onEnter()
@@ -779,6 +1233,18 @@ void ParticleSystem::update(float dt)
         return;
     }
 
+    // A system updated again before its queued step ran finishes that step first
+    if (_updatePending)
+    {
+        _updatePending = false;
+        simulate();
+
+        if (!finishUpdate())
+        {
+            return;
+        }
+    }
+
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -807,110 +1273,80 @@ void ParticleSystem::update(float dt)
             this->stopSystem();
         }
     }
-    
+
+    // Emission and transforms need the scene graph, so they stay on the main thread. The rest of the step can run on any thread.
+    _updateDeltaTime = dt;
+
+    if (_positionType == PositionType::FREE)
     {
-        for (int i = 0; i < _particleCount; ++i)
-        {
-            _particleData.timeToLive[i] -= dt;
-        }
-        
-        for (int i = 0; i < _particleCount; ++i)
+        Vec2 currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        Vec3 origin(currentPosition.x, currentPosition.y, 0);
+        _updateWorldToNodeTransform = getWorldToNodeTransform();
+        _updateWorldToNodeTransform.transformPoint(&origin);
+        _updateOrigin.set(origin.x, origin.y);
+    }
+
+    if (s_parallelUpdateEnabled && !_batchNode)
+    {
+        if (!_scheduler->isScheduled(s_pendingSystemsKey, &s_pendingSystems))
         {
-            if (_particleData.timeToLive[i] <= 0.0f)
-            {
-                int j = _particleCount - 1;
-                while (j > 0 && _particleData.timeToLive[j] <= 0)
-                {
-                    _particleCount--;
-                    j--;
-                }
-                _particleData.copyParticle(i, _particleCount - 1);
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    int currentIndex = _particleData.atlasIndex[i];
-                    _batchNode->disableParticle(_atlasIndex + currentIndex);
-                    //switch indexes
-                    _particleData.atlasIndex[_particleCount - 1] = currentIndex;
-                }
-                --_particleCount;
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
+            _scheduler->schedule([](float) { ParticleSystem::updatePendingParticleSystems(); }, &s_pendingSystems, s_pendingSystemsKey);
         }
-        
-        if (_emitterMode == Mode::GRAVITY)
+
+        this->retain();
+        s_pendingSystems.push_back(this);
+        _updatePending = true;
+        return;
+    }
+
+    simulate();
+    finishUpdate();
+}
+
+void ParticleSystem::simulate()
+{
+    float dt = _updateDeltaTime;
+
+    // Every particle is integrated, including the ones that die this frame. They are removed right after.
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        updateGravityParticles(_particleData, _particleCount, dt, modeA.gravity.x, modeA.gravity.y, (float)_yCoordFlipped);
+    }
+    else
+    {
+        updateRadiusParticles(_particleData, _particleCount, dt, (float)_yCoordFlipped);
+    }
+
+    int previousCount = _particleCount;
+    _particleCount = _particleData.removeDeadParticles(_particleCount);
+    _removedLastParticle = _particleCount == 0 && previousCount > 0;
+
+    if (_batchNode)
+    {
+        // Disables the slots of the removed particles, which now sit behind the survivors
+        for (int i = _particleCount; i < previousCount; ++i)
         {
-            for (int i = 0 ; i < _particleCount; ++i)
-            {
-                particle_point tmp, radial = {0.0f, 0.0f}, tangential;
-                
-                // radial acceleration
-                if (_particleData.posx[i] || _particleData.posy[i])
-                {
-                    normalize_point(_particleData.posx[i], _particleData.posy[i], &radial);
-                }
-                tangential = radial;
-                radial.x *= _particleData.modeA.radialAccel[i];
-                radial.y *= _particleData.modeA.radialAccel[i];
-                
-                // tangential acceleration
-                std::swap(tangential.x, tangential.y);
-                tangential.x *= - _particleData.modeA.tangentialAccel[i];
-                tangential.y *= _particleData.modeA.tangentialAccel[i];
-                
-                // (gravity + radial + tangential) * dt
-                tmp.x = radial.x + tangential.x + modeA.gravity.x;
-                tmp.y = radial.y + tangential.y + modeA.gravity.y;
-                tmp.x *= dt;
-                tmp.y *= dt;
-                
-                _particleData.modeA.dirX[i] += tmp.x;
-                _particleData.modeA.dirY[i] += tmp.y;
-                
-                // this is cocos2d-x v3.0
-                // if (_configName.length()>0 && _yCoordFlipped != -1)
-                
-                // this is cocos2d-x v3.0
-                tmp.x = _particleData.modeA.dirX[i] * dt * _yCoordFlipped;
-                tmp.y = _particleData.modeA.dirY[i] * dt * _yCoordFlipped;
-                _particleData.posx[i] += tmp.x;
-                _particleData.posy[i] += tmp.y;
-                
-                _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
-                _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
-                _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
-                _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
-                _particleData.size[i] += (_particleData.deltaSize[i] * dt);
-                _particleData.size[i] = MAX(0, _particleData.size[i]);
-                _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
-            }
+            _batchNode->disableParticle(_atlasIndex + _particleData.atlasIndex[i]);
         }
-        else
+    }
+
+    updateParticleQuads();
+    _transformSystemDirty = false;
+}
+
+bool ParticleSystem::finishUpdate()
+{
+    if (_removedLastParticle && _isAutoRemoveOnFinish)
+    {
+        _removedLastParticle = false;
+        this->unscheduleUpdate();
+
+        if (_parent != nullptr)
         {
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.modeB.angle[i] += _particleData.modeB.degreesPerSecond[i] * dt;
-                _particleData.modeB.radius[i] += _particleData.modeB.deltaRadius[i] * dt;
-                _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
-                _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
-
-                _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
-                _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
-                _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
-                _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
-                _particleData.size[i] += (_particleData.deltaSize[i] * dt);
-                _particleData.size[i] = MAX(0, _particleData.size[i]);
-                _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
-            }
+            _parent->removeChild(this, true);
         }
-        
-        updateParticleQuads();
-        _transformSystemDirty = false;
+
+        return false;
     }
 
     // only update gl buffer when visible
@@ -918,6 +1354,8 @@ void ParticleSystem::update(float dt)
     {
         postStep();
     }
+
+    return true;
 }
 
 void ParticleSystem::updateWithNoTime(void)
@@ -54,7 +54,9 @@ struct particle_point
 class CC_DLL ParticleData
 {
 public:
-    std::vector<int> range;
+    /** Number of float streams, which is every stream below except atlasIndex and compactionIndices. */
+    static const int FLOAT_STREAM_COUNT = 25;
+
     float* posx;
     float* posy;
     float* startPosX;
@@ -93,11 +95,28 @@ public:
         float* deltaRadius;
     } modeB;
     
+    // Scratch space for removeDeadParticles(), survivor indices followed by dead indices
+    int* compactionIndices;
+
     unsigned int maxCount;
     ParticleData();
+    /** Allocates every stream for count particles from a single arena, each stream starting on its own cache line. */
     bool init(int count);
     void release();
     unsigned int getMaxCount() { return maxCount; }
+
+    /** Gets the addresses of the float stream pointers, in the order the streams are laid out in the arena. */
+    void getFloatStreams(float** outStreams[FLOAT_STREAM_COUNT]);
+
+    /**
+     * Removes the particles of [0, count) whose timeToLive ran out, keeping the survivors in order.
+     * The atlas indices of the removed particles are moved behind the survivors, so that atlasIndex stays a permutation of the batch slots.
+     * @return The number of surviving particles. Indices [returned count, count) then hold the removed particles' atlas indices.
+     */
+    int removeDeadParticles(int count);
+
+private:
+    void* _arena;
     
     void copyParticle(int p1, int p2)
     {
@@ -242,6 +261,23 @@ public:
     /** Gets all ParticleSystem references
      */
     static Vector<ParticleSystem*>& getAllParticleSystems();
+
+    /** Sets whether running particle systems are simulated together once per scheduler tick, as parallel jobs where the platform supports it.
+     * When disabled, every system simulates inside its own update(). Enabled by default.
+     * Systems that belong to a ParticleBatchNode always simulate inside update(), as they share the batch node's quads.
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    static bool isParallelUpdateEnabled();
+
+    /** Simulates every particle system queued by update() since the last call.
+     * The scheduler calls this once per tick, after all the node updates. It can be called earlier to get up to date particles right away.
+     */
+    static void updatePendingParticleSystems();
+
+    /** Restarts the sequence that new particle systems are seeded from.
+     * Systems are seeded in creation order, so a scene that creates its systems in the same order after the same base seed replays identically.
+     */
+    static void setRandomSeedBase(uint32_t seed);
 public:
     void addParticles(int count);
     
@@ -766,6 +802,12 @@ public:
     bool canUpdate() { return _canUpdate; }
     void toggleCanUpdate(bool canUpdate) { _canUpdate = canUpdate; }
 
+    /** Sets the state of the random stream that new particles are emitted from.
+     * Two systems with the same configuration and seed emit identical particles.
+     */
+    void setRandomSeed(uint32_t seed) { _randomSeed = seed; }
+    uint32_t getRandomSeed() const { return _randomSeed; }
+
     /**
      * @js ctor
      */
@@ -811,6 +853,13 @@ public:
 
 protected:
     virtual void updateBlendFunc();
+
+    /** Moves the particles queued by update(). Only touches this system's own particles and quads, so systems can simulate in parallel. */
+    void simulate();
+    /** Main thread work after simulate(): auto removal and the GL buffer upload.
+     * @return False if the system removed itself from its parent.
+     */
+    bool finishUpdate();
     
 private:
     friend class EngineDataManager;
@@ -904,6 +953,19 @@ protected:
 
     bool _canUpdate;
 
+    /** State of the random stream new particles are emitted from */
+    uint32_t _randomSeed;
+
+    /** Whether update() queued a simulation step that has not run yet */
+    bool _updatePending;
+    /** Time step of the queued simulation step */
+    float _updateDeltaTime;
+    /** Whether the last simulation step removed the last particle */
+    bool _removedLastParticle;
+    /** Node space origin and world to node transform captured by update(), for free particles. Transforms cannot be computed off the main thread. */
+    Vec2 _updateOrigin;
+    Mat4 _updateWorldToNodeTransform;
+
     /** Is the emitter active */
     bool _isActive;
     
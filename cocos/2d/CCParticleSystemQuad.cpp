@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "2d/CCParticleSystemQuad.h"
 
 #include <algorithm>
+#include <unordered_map>
 
 #include "2d/CCParticleBatchNode.h"
 #include "base/CCConsole.h"
@@ -40,6 +41,7 @@ THE SOFTWARE.
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/ccUTF8.h"
+#include "renderer/CCGLProgramCache.h"
 #include "renderer/CCTextureAtlas.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
@@ -56,8 +58,12 @@ ParticleSystemQuad::ParticleSystemQuad()
 :_quads(nullptr)
 ,_indices(nullptr)
 ,_VAOname(0)
+,_instances(nullptr)
+,_texRect(0.0f, 1.0f, 1.0f, 0.0f)
+,_instancedRenderingEnabled(false)
 {
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
+    memset(_instancedVBO, 0, sizeof(_instancedVBO));
 }
 
 ParticleSystemQuad::~ParticleSystemQuad()
@@ -73,6 +79,8 @@ ParticleSystemQuad::~ParticleSystemQuad()
             GL::bindVAO(0);
         }
     }
+
+    releaseInstancedRendering();
 }
 
 // implementation ParticleSystemQuad
@@ -89,6 +97,185 @@ ParticleSystemQuad * ParticleSystemQuad::create(const std::string& filename)
     return ret;
 }
 
+// Pooled systems per plist file, see createPooled()
+static std::unordered_map<std::string, Vector<ParticleSystemQuad*>> s_pooledSystems;
+
+// One system per pooled plist file that is never handed out, so recycled systems can get the plist properties back without parsing it again
+static std::unordered_map<std::string, ParticleSystemQuad*> s_pooledTemplates;
+
+static ParticleSystemQuad* getPoolTemplate(const std::string& filename)
+{
+    auto iter = s_pooledTemplates.find(filename);
+
+    if (iter != s_pooledTemplates.end())
+    {
+        return iter->second;
+    }
+
+    ParticleSystemQuad* templateSystem = ParticleSystemQuad::create(filename);
+
+    if (templateSystem != nullptr)
+    {
+        templateSystem->retain();
+        s_pooledTemplates.emplace(filename, templateSystem);
+    }
+
+    return templateSystem;
+}
+
+// Only the pool holds it: it is not in the scene, not queued for a particle update and not referenced by the game
+static bool isPooledSystemIdle(ParticleSystemQuad* system)
+{
+    return system->getReferenceCount() == 1 && system->getParent() == nullptr;
+}
+
+ParticleSystemQuad * ParticleSystemQuad::createPooled(const std::string& filename)
+{
+    auto& pool = s_pooledSystems[filename];
+
+    for (auto system : pool)
+    {
+        if (isPooledSystemIdle(system))
+        {
+            ParticleSystemQuad* templateSystem = getPoolTemplate(filename);
+
+            if (templateSystem != nullptr)
+            {
+                system->resetToTemplate(templateSystem);
+            }
+
+            system->resetSystem();
+            system->_particleCount = 0;
+            system->_emitCounter = 0;
+
+            // Like a freshly created system, it stays in use until the autorelease pool drains unless the caller keeps it
+            system->retain();
+            system->autorelease();
+            return system;
+        }
+    }
+
+    ParticleSystemQuad* system = ParticleSystemQuad::create(filename);
+
+    if (system != nullptr)
+    {
+        pool.pushBack(system);
+    }
+
+    return system;
+}
+
+void ParticleSystemQuad::preloadPool(const std::string& filename, int count)
+{
+    auto& pool = s_pooledSystems[filename];
+
+    while ((int)pool.size() < count)
+    {
+        ParticleSystemQuad* system = ParticleSystemQuad::create(filename);
+
+        if (system == nullptr)
+        {
+            break;
+        }
+
+        pool.pushBack(system);
+    }
+}
+
+void ParticleSystemQuad::purgePool()
+{
+    for (auto iter = s_pooledSystems.begin(); iter != s_pooledSystems.end();)
+    {
+        auto& pool = iter->second;
+
+        for (ssize_t index = pool.size() - 1; index >= 0; --index)
+        {
+            if (isPooledSystemIdle(pool.at(index)))
+            {
+                pool.erase(index);
+            }
+        }
+
+        if (pool.empty())
+        {
+            auto templateIter = s_pooledTemplates.find(iter->first);
+
+            if (templateIter != s_pooledTemplates.end())
+            {
+                templateIter->second->release();
+                s_pooledTemplates.erase(templateIter);
+            }
+
+            iter = s_pooledSystems.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void ParticleSystemQuad::resetToTemplate(ParticleSystemQuad* templateSystem)
+{
+    // Node properties a user of the system may have changed
+    stopAllActions();
+    setPosition(templateSystem->getPosition());
+    setRotation(templateSystem->getRotation());
+    setScaleX(templateSystem->getScaleX());
+    setScaleY(templateSystem->getScaleY());
+    setAnchorPoint(templateSystem->getAnchorPoint());
+    setLocalZOrder(templateSystem->getLocalZOrder());
+    setVisible(templateSystem->isVisible());
+    setOpacity(templateSystem->getOpacity());
+    setColor(templateSystem->getColor());
+    setName(templateSystem->getName());
+
+    if (_totalParticles != templateSystem->_totalParticles)
+    {
+        setTotalParticles(templateSystem->_totalParticles);
+    }
+
+    // The texture is set first, since changing it recomputes the blend function that is copied below
+    if (_batchNode == nullptr && templateSystem->_texture != nullptr)
+    {
+        setTexture(templateSystem->_texture);
+    }
+
+    // Emitter properties read from the plist
+    _configName = templateSystem->_configName;
+    _emitterMode = templateSystem->_emitterMode;
+    modeA = templateSystem->modeA;
+    modeB = templateSystem->modeB;
+    _duration = templateSystem->_duration;
+    _sourcePosition = templateSystem->_sourcePosition;
+    _posVar = templateSystem->_posVar;
+    _life = templateSystem->_life;
+    _lifeVar = templateSystem->_lifeVar;
+    _angle = templateSystem->_angle;
+    _angleVar = templateSystem->_angleVar;
+    _startSize = templateSystem->_startSize;
+    _startSizeVar = templateSystem->_startSizeVar;
+    _endSize = templateSystem->_endSize;
+    _endSizeVar = templateSystem->_endSizeVar;
+    _startColor = templateSystem->_startColor;
+    _startColorVar = templateSystem->_startColorVar;
+    _endColor = templateSystem->_endColor;
+    _endColorVar = templateSystem->_endColorVar;
+    _startSpin = templateSystem->_startSpin;
+    _startSpinVar = templateSystem->_startSpinVar;
+    _endSpin = templateSystem->_endSpin;
+    _endSpinVar = templateSystem->_endSpinVar;
+    _emissionRate = templateSystem->_emissionRate;
+    _blendFunc = templateSystem->_blendFunc;
+    _isBlendAdditive = templateSystem->_isBlendAdditive;
+    _opacityModifyRGB = templateSystem->_opacityModifyRGB;
+    _yCoordFlipped = templateSystem->_yCoordFlipped;
+    _positionType = templateSystem->_positionType;
+    _sourcePositionCompatible = templateSystem->_sourcePositionCompatible;
+    _isAutoRemoveOnFinish = templateSystem->_isAutoRemoveOnFinish;
+    _paused = templateSystem->_paused;
+}
+
 ParticleSystemQuad * ParticleSystemQuad::createWithTotalParticles(int numberOfParticles) {
     ParticleSystemQuad *ret = new (std::nothrow) ParticleSystemQuad();
     if (ret && ret->initWithTotalParticles(numberOfParticles))
@@ -177,6 +364,8 @@ void ParticleSystemQuad::initTexCoordsWithRect(const CRect& pointRect)
     // Important. Texture in cocos2d are inverted, so the Y component should be inverted
     std::swap(top, bottom);
 
+    _texRect.set(left, bottom, right, top);
+
     V3F_C4B_T2F_Quad *quads = nullptr;
     unsigned int start = 0, end = 0;
     if (_batchNode)
@@ -235,6 +424,71 @@ void ParticleSystemQuad::setTexture(Texture2D* texture)
     this->setTextureWithRect(texture, CRect(0, 0, s.width, s.height));
 }
 
+void ParticleSystemQuad::setInstancedRenderingEnabled(bool enabled)
+{
+    if (_instancedRenderingEnabled == enabled)
+    {
+        return;
+    }
+
+    _instancedRenderingEnabled = enabled;
+
+    if (!enabled)
+    {
+        releaseInstancedRendering();
+    }
+    else if (Configuration::getInstance()->supportsInstancedArrays())
+    {
+        setupInstancedRendering();
+    }
+}
+
+bool ParticleSystemQuad::isInstancedRenderingActive() const
+{
+    return _instancedRenderingEnabled && _instances != nullptr && _batchNode == nullptr;
+}
+
+bool ParticleSystemQuad::setupInstancedRendering()
+{
+    ParticleInstance* instancesNew = (ParticleInstance*)realloc(_instances, sizeof(ParticleInstance) * _allocatedParticles);
+
+    if (!instancesNew)
+    {
+        CCLOG("cocos2d: Particle system: not enough memory for instanced rendering");
+        releaseInstancedRendering();
+        return false;
+    }
+
+    _instances = instancesNew;
+
+    if (_instancedVBO[0] == 0)
+    {
+        // Corners in triangle strip order: bottom-left, bottom-right, top-left, top-right
+        static const GLfloat corners[] = { -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f };
+
+        glGenBuffers(2, &_instancedVBO[0]);
+
+        glBindBuffer(GL_ARRAY_BUFFER, _instancedVBO[0]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        CHECK_GL_ERROR_DEBUG();
+    }
+
+    return true;
+}
+
+void ParticleSystemQuad::releaseInstancedRendering()
+{
+    CC_SAFE_FREE(_instances);
+
+    if (_instancedVBO[0] != 0)
+    {
+        glDeleteBuffers(2, &_instancedVBO[0]);
+        memset(_instancedVBO, 0, sizeof(_instancedVBO));
+    }
+}
+
 void ParticleSystemQuad::initIndices()
 {
     for(int i = 0; i < _totalParticles; ++i)
@@ -292,13 +546,34 @@ inline void updatePosWithParticle(V3F_C4B_T2F_Quad *quad, const Vec2& newPositio
     quad->tr.vertices.y = cy;
 }
 
+inline Color4B getColorOfParticle(const ParticleData& particleData, int index, bool opacityModifyRGB)
+{
+    GLubyte colorA = particleData.colorA[index] * 255;
+    GLubyte colorR = particleData.colorR[index] * (opacityModifyRGB ? colorA : 255);
+    GLubyte colorG = particleData.colorG[index] * (opacityModifyRGB ? colorA : 255);
+    GLubyte colorB = particleData.colorB[index] * (opacityModifyRGB ? colorA : 255);
+
+    return Color4B(colorR, colorG, colorB, colorA);
+}
+
+inline void updateColorWithParticle(V3F_C4B_T2F_Quad *quad, const ParticleData& particleData, int index, bool opacityModifyRGB)
+{
+    Color4B color = getColorOfParticle(particleData, index, opacityModifyRGB);
+
+    quad->bl.colors = color;
+    quad->br.colors = color;
+    quad->tl.colors = color;
+    quad->tr.colors = color;
+}
+
 void ParticleSystemQuad::updateParticleQuads()
 {
     if (_particleCount <= 0) {
         return;
     }
     
-    V3F_C4B_T2F_Quad *startQuad;
+    V3F_C4B_T2F_Quad *startQuad = nullptr;
+    ParticleInstance *startInstance = nullptr;
     Vec2 pos = Vec2::ZERO;
 
     if (_batchNode)
@@ -307,100 +582,78 @@ void ParticleSystemQuad::updateParticleQuads()
         startQuad = &(batchQuads[_atlasIndex]);
         pos = _position;
     }
+    else if (isInstancedRenderingActive())
+    {
+        startInstance = &(_instances[0]);
+    }
     else
     {
         startQuad = &(_quads[0]);
     }
+
+    auto updateParticle = [&](int i, const Vec2& newPosition)
+    {
+        if (startInstance != nullptr)
+        {
+            ParticleInstance& instance = startInstance[i];
+            instance.x = newPosition.x;
+            instance.y = newPosition.y;
+            instance.size = _particleData.size[i];
+            instance.rotation = _particleData.rotation[i];
+            instance.color = getColorOfParticle(_particleData, i, _opacityModifyRGB);
+        }
+        else
+        {
+            updatePosWithParticle(&startQuad[i], newPosition, _particleData.size[i], _particleData.rotation[i]);
+            updateColorWithParticle(&startQuad[i], _particleData, i, _opacityModifyRGB);
+        }
+    };
     
+    // Runs inside the system's simulation job, possibly off the main thread, so the transforms come from what update() captured
     if( _positionType == PositionType::FREE )
     {
-        Vec2 currentPosition = this->convertToWorldSpace(Vec2::ZERO);
-        Vec3 p1(currentPosition.x, currentPosition.y, 0);
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
-        worldToNodeTM.transformPoint(&p1);
+        const Vec2& p1 = _updateOrigin;
+        const Mat4& worldToNodeTM = _updateWorldToNodeTransform;
 
-        TRY_PARALLELIZE(
-            _particleData.range.begin(),
-            _particleData.range.end(),
-            [=](int i)
-            {
-                Vec3 p2 = Vec3(_particleData.startPosX[i], _particleData.startPosY[i], 0.0f);
-                worldToNodeTM.transformPoint(&p2);
-
-                updatePosWithParticle(&startQuad[i], Vec2(
-                    _particleData.posx[i] - ((p1.x - p2.x) - pos.x), _particleData.posy[i] - ((p1.y - p2.y) - pos.y)),
-                    _particleData.size[i], _particleData.rotation[i]
-                );
-
-                GLubyte colorA = _particleData.colorA[i] * 255;
-                GLubyte colorR = _particleData.colorR[i] * (_opacityModifyRGB ? colorA : 255);
-                GLubyte colorG = _particleData.colorG[i] * (_opacityModifyRGB ? colorA : 255);
-                GLubyte colorB = _particleData.colorB[i] * (_opacityModifyRGB ? colorA : 255);
-
-                startQuad[i].bl.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].br.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].tl.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].tr.colors.set(colorR, colorG, colorB, colorA);
-            }
-        );
+        for (int i = 0; i < _particleCount; ++i)
+        {
+            Vec3 p2 = Vec3(_particleData.startPosX[i], _particleData.startPosY[i], 0.0f);
+            worldToNodeTM.transformPoint(&p2);
+
+            updateParticle(i, Vec2(
+                _particleData.posx[i] - ((p1.x - p2.x) - pos.x), _particleData.posy[i] - ((p1.y - p2.y) - pos.y))
+            );
+        }
     }
     else if( _positionType == PositionType::RELATIVE )
     {
-        TRY_PARALLELIZE(
-            _particleData.range.begin(),
-            _particleData.range.end(),
-            [=](int i)
-            {
-                updatePosWithParticle(&startQuad[i],
-                    Vec2(
-                        _particleData.posx[i] - (_position.x - _particleData.startPosX[i]) + pos.x,
-                        _particleData.posy[i] - (_position.y - _particleData.startPosY[i]) + pos.y
-                    ),
-                    _particleData.size[i],
-                    _particleData.rotation[i]
-                );
-
-                GLubyte colorA = _particleData.colorA[i] * 255;
-                GLubyte colorR = _particleData.colorR[i] * (_opacityModifyRGB ? colorA : 255);
-                GLubyte colorG = _particleData.colorG[i] * (_opacityModifyRGB ? colorA : 255);
-                GLubyte colorB = _particleData.colorB[i] * (_opacityModifyRGB ? colorA : 255);
-
-                startQuad[i].bl.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].br.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].tl.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].tr.colors.set(colorR, colorG, colorB, colorA);
-            }
-        );
+        for (int i = 0; i < _particleCount; ++i)
+        {
+            updateParticle(i,
+                Vec2(
+                    _particleData.posx[i] - (_position.x - _particleData.startPosX[i]) + pos.x,
+                    _particleData.posy[i] - (_position.y - _particleData.startPosY[i]) + pos.y
+                )
+            );
+        }
     }
     else
     {
-        TRY_PARALLELIZE(
-            _particleData.range.begin(),
-            _particleData.range.end(),
-            [=](int i)
-            {
-                updatePosWithParticle(&startQuad[i],
-                    Vec2(_particleData.posx[i] + pos.x, _particleData.posy[i] + pos.y),
-                    _particleData.size[i],
-                    _particleData.rotation[i]
-                );
-
-                GLubyte colorA = _particleData.colorA[i] * 255;
-                GLubyte colorR = _particleData.colorR[i] * (_opacityModifyRGB ? colorA : 255);
-                GLubyte colorG = _particleData.colorG[i] * (_opacityModifyRGB ? colorA : 255);
-                GLubyte colorB = _particleData.colorB[i] * (_opacityModifyRGB ? colorA : 255);
-
-                startQuad[i].bl.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].br.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].tl.colors.set(colorR, colorG, colorB, colorA);
-                startQuad[i].tr.colors.set(colorR, colorG, colorB, colorA);
-            }
-        );
+        for (int i = 0; i < _particleCount; ++i)
+        {
+            updateParticle(i, Vec2(_particleData.posx[i] + pos.x, _particleData.posy[i] + pos.y));
+        }
     }
 }
 
 void ParticleSystemQuad::postStep()
 {
+    // The instanced path uploads its records when drawn
+    if (isInstancedRenderingActive())
+    {
+        return;
+    }
+
     glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
     
     // Option 1: Sub Data
@@ -423,14 +676,64 @@ void ParticleSystemQuad::postStep()
 // overriding draw method
 void ParticleSystemQuad::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    //quad command
-    if(_particleCount > 0)
+    if (_particleCount <= 0)
     {
+        return;
+    }
+
+    if (isInstancedRenderingActive())
+    {
+        _instancedCommand.init(0.0f, transform, flags);
+        _instancedCommand.func = CC_CALLBACK_0(ParticleSystemQuad::onDrawInstanced, this, transform, flags);
+        renderer->addCommand(&_instancedCommand);
+    }
+    else
+    {
+        //quad command
         _quadCommand.init(0.0f, _texture, getGLProgramState(), _blendFunc, _quads, _particleCount, transform, flags);
         renderer->addCommand(&_quadCommand);
     }
 }
 
+void ParticleSystemQuad::onDrawInstanced(const Mat4 &transform, uint32_t /*flags*/)
+{
+    auto glProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_PARTICLE_INSTANCED);
+    glProgram->use();
+    glProgram->setUniformsForBuiltins(transform);
+    glProgram->setUniformLocationWith4f(glProgram->getUniformLocation("u_texRect"), _texRect.x, _texRect.y, _texRect.z, _texRect.w);
+
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+    GL::bindTexture2D(_texture ? _texture->getName() : 0);
+    GL::bindVAO(0);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POSITION | GL::VERTEX_ATTRIB_FLAG_COLOR);
+
+    // a_particle is not one of the predefined attributes, so the state cache does not track it
+    GLint particleAttrib = glProgram->getAttribLocation("a_particle");
+    glEnableVertexAttribArray(particleAttrib);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instancedVBO[0]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instancedVBO[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(ParticleInstance) * _particleCount, _instances, GL_STREAM_DRAW);
+    glVertexAttribPointer(particleAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (GLvoid*)offsetof(ParticleInstance, x));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ParticleInstance), (GLvoid*)offsetof(ParticleInstance, color));
+
+    glVertexAttribDivisorARB(particleAttrib, 1);
+    glVertexAttribDivisorARB(GLProgram::VERTEX_ATTRIB_COLOR, 1);
+
+    glDrawArraysInstancedARB(GL_TRIANGLE_STRIP, 0, 4, _particleCount);
+
+    // Divisors are global vertex state, every other draw expects per vertex attributes
+    glVertexAttribDivisorARB(particleAttrib, 0);
+    glVertexAttribDivisorARB(GLProgram::VERTEX_ATTRIB_COLOR, 0);
+    glDisableVertexAttribArray(particleAttrib);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _particleCount * 4);
+    CHECK_GL_ERROR_DEBUG();
+}
+
 void ParticleSystemQuad::setTotalParticles(int tp)
 {
     // If we are setting the total number of particles to a number higher
@@ -492,6 +795,11 @@ void ParticleSystemQuad::setTotalParticles(int tp)
         {
             setupVBO();
         }
+
+        if (_instances)
+        {
+            setupInstancedRendering();
+        }
         
         // fixed http://www.cocos2d-x.org/issues/3990
         // Updates texture coords.
@@ -580,6 +888,12 @@ void ParticleSystemQuad::listenRendererRecreated(EventCustom* /*event*/)
     {
         setupVBO();
     }
+
+    if (_instances)
+    {
+        memset(_instancedVBO, 0, sizeof(_instancedVBO));
+        setupInstancedRendering();
+    }
 }
 
 bool ParticleSystemQuad::allocMemory()
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #define __CC_PARTICLE_SYSTEM_QUAD_H__
 
 #include "2d/CCParticleSystem.h"
+#include "renderer/CCCustomCommand.h"
 #include "renderer/CCQuadCommand.h"
 
 NS_CC_BEGIN
@@ -84,6 +85,24 @@ public:
      */
     static ParticleSystemQuad * create(ValueMap &dictionary);
 
+    /** Gets an idle pooled system created from a plist file, or creates one when every pooled system of that file is in use.
+     * A pooled system is idle once nothing but the pool references it, typically after it removed itself on finish.
+     * Reused systems get the properties of the plist back (emitter settings, texture, position, transform, color, auto remove and so on)
+     * from a template system the pool keeps per file, and are then restarted with resetSystem().
+     *
+     * @param filename Particle plist file name.
+     * @return A system the pool keeps a reference to. Like create(), the caller only needs to retain it or add it to a parent.
+     */
+    static ParticleSystemQuad * createPooled(const std::string& filename);
+    /** Parses a plist file and creates pooled systems from it until its pool holds count systems, so that later createPooled() calls do not allocate.
+     *
+     * @param filename Particle plist file name.
+     * @param count The number of systems to keep ready.
+     */
+    static void preloadPool(const std::string& filename, int count);
+    /** Releases every idle pooled system. */
+    static void purgePool();
+
     /** Sets a new texture with a rect. The rect is in Points.
      @since v0.99.4
      * @js NA
@@ -94,6 +113,19 @@ public:
      */
     void setTextureWithRect(Texture2D *texture, const CRect& rect);
 
+    /** Enables drawing with one compact record per particle (position, size, rotation and color) that the vertex shader expands into a quad.
+     * This uploads a fifth of the data of a full quad and skips the renderer's CPU vertex transform, but it draws with the built in
+     * GLProgram::SHADER_PARTICLE_INSTANCED program instead of the node's GLProgramState.
+     * It only takes effect when Configuration::supportsInstancedArrays() is true and the system is not batched, otherwise the quad path is used.
+     *
+     * @param enabled Whether instanced rendering should be used when available.
+     */
+    void setInstancedRenderingEnabled(bool enabled);
+    /** Whether instanced rendering was requested with setInstancedRenderingEnabled(). */
+    bool isInstancedRenderingEnabled() const { return _instancedRenderingEnabled; }
+    /** Whether the system currently draws with instanced rendering. */
+    bool isInstancedRenderingActive() const;
+
     /** Listen the event that renderer was recreated on Android/WP8.
      * @js NA
      * @lua NA
@@ -169,12 +201,36 @@ protected:
     void setupVBO();
     bool allocMemory();
 
+    /** Restores the emitter and node properties of a pooled system from the untouched system of the same plist */
+    void resetToTemplate(ParticleSystemQuad* templateSystem);
+
+    /** Allocates the particle records and creates the buffers of the instanced path */
+    bool setupInstancedRendering();
+    void releaseInstancedRendering();
+    void onDrawInstanced(const Mat4 &transform, uint32_t flags);
+
+    /** The per particle record of the instanced path, expanded by ccShader_PositionTextureColor_particleInstanced.vert */
+    struct ParticleInstance
+    {
+        GLfloat x;
+        GLfloat y;
+        GLfloat size;
+        GLfloat rotation;
+        Color4B color;
+    };
+
     V3F_C4B_T2F_Quad    *_quads;        // quads to be rendered
     GLushort            *_indices;      // indices
     GLuint              _VAOname;
     GLuint              _buffersVBO[2]; //0: vertex  1: indices
 
     QuadCommand _quadCommand;           // quad command
+
+    ParticleInstance    *_instances;        // one record per particle, only allocated while instanced rendering is enabled
+    GLuint              _instancedVBO[2];   //0: quad corners  1: particle records
+    Vec4                _texRect;           // left, bottom, right, top texture coordinates of the particle quads
+    bool                _instancedRenderingEnabled;
+    CustomCommand       _instancedCommand;
     
 
 
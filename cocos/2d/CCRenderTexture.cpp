@@ -28,12 +28,14 @@ THE SOFTWARE.
 #include "2d/CCRenderTexture.h"
 
 #include "2d/CCCamera.h"
+#include "base/CCAsyncTaskPool.h"
 #include "base/CCConsole.h"
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCScheduler.h"
 #include "base/ccUtils.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCRenderer.h"
@@ -451,6 +453,249 @@ Image* RenderTexture::newImage(bool flipImage)
     return image;
 }
 
+void RenderTexture::newImageAsync(const std::function<void(Image*)>& callback, bool flipImage)
+{
+    PendingReadback readback;
+    readback.flipImage = flipImage;
+    readback.isRGBA = true;
+    readback.imageCallback = callback;
+
+    queueReadback(std::move(readback));
+}
+
+void RenderTexture::saveToFileAsync(const std::string& fileName, bool isRGBA, const std::function<void(RenderTexture*, const std::string&)>& callback)
+{
+    FileUtils* fileUtils = FileUtils::getInstance();
+
+    PendingReadback readback;
+    readback.flipImage = true;
+    readback.isRGBA = isRGBA;
+    readback.fullPath = fileUtils->isAbsolutePath(fileName) ? fileName : fileUtils->getWritablePath() + fileName;
+    readback.saveCallback = callback;
+
+    queueReadback(std::move(readback));
+}
+
+void RenderTexture::queueReadback(PendingReadback&& readback)
+{
+    CCASSERT(_pixelFormat == Texture2D::PixelFormat::RGBA8888, "only RGBA8888 can be saved as image");
+
+    if (_texture == nullptr)
+    {
+        if (readback.imageCallback)
+        {
+            readback.imageCallback(nullptr);
+        }
+
+        if (readback.saveCallback)
+        {
+            readback.saveCallback(this, "");
+        }
+
+        return;
+    }
+
+    const CSize& s = _texture->getContentSizeInPixels();
+
+    readback.pixelBuffer = 0;
+    readback.width = (int)s.width;
+    readback.height = (int)s.height;
+    readback.frame = 0;
+
+    // The pixels are read by a render command, so that everything queued so far this frame (such as begin() / end()) has been drawn
+    if (_queuedReadbacks.empty())
+    {
+        _readPixelsCommand.init(0.0f);
+        _readPixelsCommand.func = CC_CALLBACK_0(RenderTexture::onReadPixelsAsync, this);
+        Director::getInstance()->getRenderer()->addCommand(&_readPixelsCommand);
+    }
+
+    // Stay alive until the callback has run
+    this->retain();
+    _queuedReadbacks.push_back(std::move(readback));
+}
+
+void RenderTexture::onReadPixelsAsync()
+{
+    Director* director = Director::getInstance();
+    bool usePixelBuffer = Configuration::getInstance()->supportsPixelBufferObject();
+    GLint oldFBO = 0;
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    for (auto& readback : _queuedReadbacks)
+    {
+        GLsizeiptr size = (GLsizeiptr)readback.width * readback.height * 4;
+
+        if (usePixelBuffer)
+        {
+            // The transfer is only queued here, glReadPixels() returns without waiting for the GPU
+            glGenBuffers(1, &readback.pixelBuffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            glReadPixels(0, 0, readback.width, readback.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        else
+        {
+            readback.pixels.resize(size);
+            glReadPixels(0, 0, readback.width, readback.height, GL_RGBA, GL_UNSIGNED_BYTE, readback.pixels.data());
+        }
+
+        readback.frame = director->getTotalFrames();
+    }
+
+    if (usePixelBuffer)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+    CHECK_GL_ERROR_DEBUG();
+
+    // The poll is keyed on the pending list rather than on this node, so that onExit() pausing or cleanup() unscheduling the node
+    // (as when a screenshot is removed right after saveToFileAsync()) cannot stop it. The readbacks keep this node alive meanwhile.
+    if (_pendingReadbacks.empty())
+    {
+        director->getScheduler()->schedule(CC_CALLBACK_1(RenderTexture::pollReadbacks, this), &_pendingReadbacks, "RenderTexture::pollReadbacks", 0.0f, CC_REPEAT_FOREVER, false);
+    }
+
+    for (auto& readback : _queuedReadbacks)
+    {
+        _pendingReadbacks.push_back(std::move(readback));
+    }
+
+    _queuedReadbacks.clear();
+}
+
+void RenderTexture::pollReadbacks(float /*dt*/)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::vector<PendingReadback> readyReadbacks;
+
+    for (auto it = _pendingReadbacks.begin(); it != _pendingReadbacks.end();)
+    {
+        if (frame - it->frame < READBACK_FRAME_LATENCY)
+        {
+            ++it;
+            continue;
+        }
+
+        if (it->pixelBuffer != 0)
+        {
+            GLsizeiptr size = (GLsizeiptr)it->width * it->height * 4;
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, it->pixelBuffer);
+            const GLubyte* mapped = (const GLubyte*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+
+            if (mapped != nullptr)
+            {
+                it->pixels.assign(mapped, mapped + size);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            else
+            {
+                CCLOG("cocos2d: RenderTexture: failed to map the pixel buffer of a readback");
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &it->pixelBuffer);
+            it->pixelBuffer = 0;
+        }
+
+        readyReadbacks.push_back(std::move(*it));
+        it = _pendingReadbacks.erase(it);
+    }
+
+    // Unschedule before processing, a callback may queue another readback and schedule the poll again
+    if (_pendingReadbacks.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule("RenderTexture::pollReadbacks", &_pendingReadbacks);
+    }
+
+    for (auto& readback : readyReadbacks)
+    {
+        processReadback(std::move(readback));
+    }
+}
+
+void RenderTexture::processReadback(PendingReadback&& readback)
+{
+    struct ReadbackResult
+    {
+        std::vector<GLubyte> pixels;
+        Image* image = nullptr;
+        bool saved = false;
+    };
+
+    auto result = std::make_shared<ReadbackResult>();
+    result->pixels = std::move(readback.pixels);
+
+    int width = readback.width;
+    int height = readback.height;
+    bool flipImage = readback.flipImage;
+    bool isRGBA = readback.isRGBA;
+    std::string fullPath = readback.fullPath;
+    auto imageCallback = readback.imageCallback;
+    auto saveCallback = readback.saveCallback;
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [this, result, fullPath, imageCallback, saveCallback](void*)
+    {
+        if (imageCallback)
+        {
+            imageCallback(result->image);
+        }
+
+        if (saveCallback)
+        {
+            saveCallback(this, result->saved ? fullPath : "");
+        }
+
+        CC_SAFE_RELEASE(result->image);
+        this->release();
+    }, nullptr, [result, width, height, flipImage, isRGBA, fullPath]()
+    {
+        size_t rowSize = (size_t)width * 4;
+
+        if (result->pixels.size() != rowSize * height)
+        {
+            return;
+        }
+
+        if (flipImage)
+        {
+            // #640 the image read from rendertexture is dirty
+            std::vector<GLubyte> row(rowSize);
+
+            for (int top = 0, bottom = height - 1; top < bottom; top++, bottom--)
+            {
+                GLubyte* topRow = &result->pixels[top * rowSize];
+                GLubyte* bottomRow = &result->pixels[bottom * rowSize];
+
+                memcpy(row.data(), topRow, rowSize);
+                memcpy(topRow, bottomRow, rowSize);
+                memcpy(bottomRow, row.data(), rowSize);
+            }
+        }
+
+        Image* image = new (std::nothrow) Image();
+
+        if (image == nullptr || !image->initWithRawData(result->pixels.data(), result->pixels.size(), width, height, 8))
+        {
+            CC_SAFE_RELEASE(image);
+            return;
+        }
+
+        if (!fullPath.empty())
+        {
+            result->saved = image->saveToFile(fullPath, !isRGBA);
+        }
+
+        result->image = image;
+    });
+}
+
 void RenderTexture::onBegin()
 {
     //
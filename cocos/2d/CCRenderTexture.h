@@ -27,6 +27,10 @@ THE SOFTWARE.
 #ifndef __CCRENDER_TEXTURE_H__
 #define __CCRENDER_TEXTURE_H__
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "2d/CCNode.h"
 #include "2d/CCSprite.h"
 #include "platform/CCImage.h"
@@ -149,6 +153,27 @@ public:
      */
     Image* newImage(bool flipImage = true);
 
+    /** Reads the texture's data back without stalling the frame.
+     * The pixels are read during rendering of the current frame into a pixel buffer object, which is mapped a few frames later.
+     * The flip and the Image construction happen on a worker thread, and the callback is invoked on the main thread.
+     * The render texture is retained until the callback has run.
+     *
+     * @param callback Receives the image, or nullptr on failure. The image is released after the callback returns, retain it to keep it.
+     * @param flipImage Whether or not to flip image.
+     * @js NA
+     */
+    void newImageAsync(const std::function<void(Image*)>& callback, bool flipImage = true);
+
+    /** Saves the texture's data into a PNG file without stalling the frame, in the same way as newImageAsync().
+     * The PNG encode also happens on the worker thread.
+     *
+     * @param fileName The file name. Relative names are saved into FileUtils::getWritablePath().
+     * @param isRGBA Whether the alpha channel is saved, or the image is saved as RGB.
+     * @param callback Invoked on the main thread with the full path of the written file, or an empty path on failure.
+     * @js NA
+     */
+    void saveToFileAsync(const std::string& fileName, bool isRGBA = true, const std::function<void(RenderTexture*, const std::string&)>& callback = nullptr);
+
     /** Listen "come to background" message, and save render texture.
      * It only has effect on Android.
      * 
@@ -332,7 +357,31 @@ protected:
     void onClear();
     void onClearDepth();
 
-    void onSaveToFile(const std::string& fileName, bool isRGBA = true);
+    struct PendingReadback
+    {
+        GLuint pixelBuffer;
+        std::vector<GLubyte> pixels;
+        int width;
+        int height;
+        unsigned int frame;
+        bool flipImage;
+        bool isRGBA;
+        std::string fullPath;
+        std::function<void(Image*)> imageCallback;
+        std::function<void(RenderTexture*, const std::string&)> saveCallback;
+    };
+
+    void queueReadback(PendingReadback&& readback);
+    void onReadPixelsAsync();
+    void pollReadbacks(float dt);
+    void processReadback(PendingReadback&& readback);
+
+    // Frames to wait before mapping a pixel buffer, so that the GPU has finished the transfer and mapping does not block
+    static const unsigned int READBACK_FRAME_LATENCY = 2;
+
+    std::vector<PendingReadback> _queuedReadbacks;
+    std::vector<PendingReadback> _pendingReadbacks;
+    CustomCommand _readPixelsCommand;
 
     void setupDepthAndStencil(int powW, int powH);
     
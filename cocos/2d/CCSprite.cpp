@@ -372,6 +372,7 @@ void Sprite::setTexture(Texture2D *texture)
         CC_SAFE_RELEASE(_texture);
         _texture = texture;
         updateBlendFunc();
+        invalidateCachedAncestors();
     }
 }
 
@@ -399,6 +400,8 @@ void Sprite::setTextureRect(const CRect& rect, bool rotated, const CSize& untrim
 
 void Sprite::updatePoly()
 {
+    invalidateCachedAncestors();
+
     // There are 3 cases:
     //
     // A) a non 9-sliced, non stretched
@@ -1101,6 +1104,7 @@ void Sprite::setOpacityModifyRGB(bool modify)
     {
         _opacityModifyRGB = modify;
         updateColor();
+        invalidateCachedAncestors();
     }
 }
 
@@ -0,0 +1,603 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCTMXMapCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "2d/CCTMXXMLParser.h"
+#include "base/CCFlatValue.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // 'CTMX', little endian
+    const uint32_t CACHE_MAGIC = 0x584D5443;
+    const uint16_t CACHE_VERSION = 1;
+
+    // Header layout, written field by field so the file does not depend on struct padding:
+    //  uint32 magic, uint16 version, uint16 reserved, uint64 source hash, uint32 total size,
+    //  uint32 meta offset, uint32 meta size, uint32 blob offset, uint32 blob size, uint32 reserved
+    const uint32_t HEADER_SIZE = 40;
+
+    bool s_cacheEnabled = false;
+
+    uint64_t fnv1a(const unsigned char* bytes, ssize_t size)
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for (ssize_t index = 0; index < size; index++)
+        {
+            hash ^= bytes[index];
+            hash *= 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+
+    std::string hashToString(uint64_t hash)
+    {
+        char buffer[17];
+        snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)hash);
+
+        return std::string(buffer);
+    }
+
+    std::string directoryOf(const std::string& path)
+    {
+        size_t slash = path.find_last_of('/');
+
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // Paths under the map directory are stored relative to it, so a compiled cache stays valid when the game is installed elsewhere
+    ValueMap encodePath(const std::string& path, const std::string& mapDirectory)
+    {
+        ValueMap entry;
+        bool relative = !mapDirectory.empty() && path.compare(0, mapDirectory.size(), mapDirectory) == 0;
+
+        entry["path"] = Value(relative ? path.substr(mapDirectory.size()) : path);
+        entry["relative"] = Value(relative);
+
+        return entry;
+    }
+
+    std::string decodePath(const FlatValueView& entry, const std::string& mapDirectory)
+    {
+        std::string path = entry["path"].asString();
+
+        return entry["relative"].asBool() ? mapDirectory + path : path;
+    }
+
+    void writeUInt32(unsigned char* out, uint32_t value)
+    {
+        memcpy(out, &value, sizeof(value));
+    }
+
+    uint32_t readUInt32(const unsigned char* in)
+    {
+        uint32_t value;
+        memcpy(&value, in, sizeof(value));
+
+        return value;
+    }
+
+    // Appends raw bytes to the blob section, keeping every array 4-byte aligned, and returns their offset
+    uint32_t appendBlob(std::vector<unsigned char>& blob, const void* bytes, size_t size)
+    {
+        uint32_t offset = (uint32_t)blob.size();
+
+        blob.insert(blob.end(), (const unsigned char*)bytes, (const unsigned char*)bytes + size);
+        blob.resize((blob.size() + 3) & ~(size_t)3, 0);
+
+        return offset;
+    }
+}
+
+void TMXMapCache::setEnabled(bool enabled)
+{
+    s_cacheEnabled = enabled;
+}
+
+bool TMXMapCache::isEnabled()
+{
+    return s_cacheEnabled;
+}
+
+bool TMXMapCache::hashFile(const std::string& fullPath, uint64_t& hash)
+{
+    MappedFile mappedFile;
+
+    if (mappedFile.open(fullPath))
+    {
+        hash = fnv1a(mappedFile.getBytes(), mappedFile.getSize());
+        return true;
+    }
+
+    Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
+
+    if (data.isNull())
+    {
+        return false;
+    }
+
+    hash = fnv1a(data.getBytes(), data.getSize());
+
+    return true;
+}
+
+std::string TMXMapCache::getCompiledPath(const std::string& tmxFullPath)
+{
+    return tmxFullPath + "c";
+}
+
+std::string TMXMapCache::getCachePath(uint64_t sourceHash)
+{
+    return FileUtils::getInstance()->getWritablePath() + "tmx_cache/" + hashToString(sourceHash) + ".tmxc";
+}
+
+bool TMXMapCache::load(TMXMapInfo* mapInfo, uint64_t sourceHash)
+{
+    const std::string& tmxFileName = mapInfo->getTMXFileName();
+
+    return loadFromFile(mapInfo, getCompiledPath(tmxFileName), sourceHash)
+        || loadFromFile(mapInfo, getCachePath(sourceHash), sourceHash);
+}
+
+bool TMXMapCache::loadFromFile(TMXMapInfo* mapInfo, const std::string& cachePath, uint64_t sourceHash)
+{
+    FileUtils* fileUtils = FileUtils::getInstance();
+    MappedFile mappedFile;
+    Data data;
+    const unsigned char* bytes = nullptr;
+    ssize_t size = 0;
+
+    if (mappedFile.open(cachePath))
+    {
+        bytes = mappedFile.getBytes();
+        size = mappedFile.getSize();
+    }
+    else
+    {
+        if (!fileUtils->isFileExist(cachePath))
+        {
+            return false;
+        }
+
+        data = fileUtils->getDataFromFile(cachePath);
+        bytes = data.getBytes();
+        size = data.getSize();
+    }
+
+    if (bytes == nullptr || size < (ssize_t)HEADER_SIZE)
+    {
+        return false;
+    }
+
+    uint16_t version;
+    uint64_t hash;
+    memcpy(&version, bytes + 4, sizeof(version));
+    memcpy(&hash, bytes + 8, sizeof(hash));
+
+    uint32_t totalSize = readUInt32(bytes + 16);
+    uint32_t metaOffset = readUInt32(bytes + 20);
+    uint32_t metaSize = readUInt32(bytes + 24);
+    uint32_t blobOffset = readUInt32(bytes + 28);
+    uint32_t blobSize = readUInt32(bytes + 32);
+
+    if (readUInt32(bytes) != CACHE_MAGIC || version != CACHE_VERSION || hash != sourceHash || totalSize != (uint64_t)size
+        || metaOffset < HEADER_SIZE || (uint64_t)metaOffset + metaSize > totalSize
+        || blobOffset < HEADER_SIZE || (uint64_t)blobOffset + blobSize > totalSize)
+    {
+        return false;
+    }
+
+    FlatValueView root = FlatValueDocument::getRootOfData(bytes + metaOffset, metaSize);
+
+    if (root.getType() != Value::Type::MAP)
+    {
+        return false;
+    }
+
+    const std::string mapDirectory = directoryOf(mapInfo->_TMXFileName);
+    const unsigned char* blob = bytes + blobOffset;
+
+    // A changed external tileset invalidates the cache even though the map itself is unchanged
+    FlatValueView dependencies = root["dependencies"];
+    std::vector<std::string> externalTilesetFiles;
+
+    for (uint32_t index = 0; index < dependencies.size(); index++)
+    {
+        FlatValueView dependency = dependencies.at(index);
+        std::string path = decodePath(dependency, mapDirectory);
+        uint64_t dependencyHash = 0;
+
+        if (!hashFile(path, dependencyHash) || hashToString(dependencyHash) != dependency["hash"].asString())
+        {
+            return false;
+        }
+
+        externalTilesetFiles.push_back(std::move(path));
+    }
+
+    // Validate every array before touching the map info, so a bad cache leaves it ready for the XML fallback
+    FlatValueView layers = root["layers"];
+    FlatValueView tilesets = root["tilesets"];
+    FlatValueView objectGroups = root["objectGroups"];
+
+    if (root["properties"].getType() != Value::Type::MAP)
+    {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < layers.size(); index++)
+    {
+        FlatValueView layer = layers.at(index);
+        uint64_t tileCount = layer["tileCount"].asUnsignedInt();
+
+        if (layer["properties"].getType() != Value::Type::MAP
+            || (uint64_t)layer["tiles"].asUnsignedInt() + tileCount * sizeof(uint32_t) > blobSize)
+        {
+            return false;
+        }
+
+        // TMXLayer indexes width * height tiles, so a shorter array would be read past its end
+        float width = layer["width"].asFloat();
+        float height = layer["height"].asFloat();
+
+        if (layer["hasTiles"].asBool() && (width < 0.0f || height < 0.0f || tileCount != (uint64_t)((double)width * height)))
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t groupIndex = 0; groupIndex < objectGroups.size(); groupIndex++)
+    {
+        FlatValueView objectGroup = objectGroups.at(groupIndex);
+        FlatValueView shapes = objectGroup["shapes"];
+
+        if (objectGroup["properties"].getType() != Value::Type::MAP || objectGroup["objects"].getType() != Value::Type::VECTOR)
+        {
+            return false;
+        }
+
+        for (uint32_t index = 0; index < shapes.size(); index++)
+        {
+            FlatValueView shape = shapes.at(index);
+
+            if ((uint64_t)shape["points"].asUnsignedInt() + (uint64_t)shape["count"].asUnsignedInt() * 2 * sizeof(float) > blobSize)
+            {
+                return false;
+            }
+        }
+    }
+
+    mapInfo->_orientation = root["orientation"].asInt();
+    mapInfo->_staggerAxis = root["staggerAxis"].asInt();
+    mapInfo->_staggerIndex = root["staggerIndex"].asInt();
+    mapInfo->_hexSideLength = root["hexSideLength"].asInt();
+    mapInfo->_mapSize = CSize(root["mapWidth"].asFloat(), root["mapHeight"].asFloat());
+    mapInfo->_tileSize = CSize(root["tileWidth"].asFloat(), root["tileHeight"].asFloat());
+    mapInfo->_externalTilesetFilename = root["externalTileset"].asString();
+    mapInfo->_externalTilesetFiles = std::move(externalTilesetFiles);
+    mapInfo->_properties = root["properties"].materialize().asValueMap();
+
+    FlatValueView tileProperties = root["tileProperties"];
+
+    if (tileProperties.getType() == Value::Type::INT_KEY_MAP)
+    {
+        mapInfo->_tileProperties = tileProperties.materialize().asIntKeyMap();
+    }
+
+    for (uint32_t index = 0; index < layers.size(); index++)
+    {
+        FlatValueView layerView = layers.at(index);
+        TMXLayerInfo* layer = new (std::nothrow) TMXLayerInfo(layerView["index"].asInt());
+
+        layer->_name = layerView["name"].asString();
+        layer->_layerSize = CSize(layerView["width"].asFloat(), layerView["height"].asFloat());
+        layer->_visible = layerView["visible"].asBool();
+        layer->_opacity = layerView["opacity"].asByte();
+        layer->_offset = Vec2(layerView["offsetX"].asFloat(), layerView["offsetY"].asFloat());
+        layer->_properties = layerView["properties"].materialize().asValueMap();
+
+        uint32_t tileCount = layerView["tileCount"].asUnsignedInt();
+
+        // The layer takes ownership of (and later edits) its tiles, so they are copied out of the mapping
+        if (layerView["hasTiles"].asBool())
+        {
+            layer->_tiles = (uint32_t*)malloc(std::max(tileCount, 1u) * sizeof(uint32_t));
+
+            if (layer->_tiles != nullptr && tileCount > 0)
+            {
+                memcpy(layer->_tiles, blob + layerView["tiles"].asUnsignedInt(), tileCount * sizeof(uint32_t));
+            }
+        }
+
+        mapInfo->_layers.pushBack(layer);
+        layer->release();
+    }
+
+    for (uint32_t index = 0; index < tilesets.size(); index++)
+    {
+        FlatValueView tilesetView = tilesets.at(index);
+        TMXTilesetInfo* tileset = new (std::nothrow) TMXTilesetInfo();
+
+        tileset->_name = tilesetView["name"].asString();
+        tileset->_firstGid = tilesetView["firstGid"].asInt();
+        tileset->_tileSize = CSize(tilesetView["tileWidth"].asFloat(), tilesetView["tileHeight"].asFloat());
+        tileset->_spacing = tilesetView["spacing"].asInt();
+        tileset->_margin = tilesetView["margin"].asInt();
+        tileset->_tileOffset = Vec2(tilesetView["tileOffsetX"].asFloat(), tilesetView["tileOffsetY"].asFloat());
+        tileset->_sourceImage = decodePath(tilesetView["sourceImage"], mapDirectory);
+        tileset->_imageSize = CSize(tilesetView["imageWidth"].asFloat(), tilesetView["imageHeight"].asFloat());
+        tileset->_originSourceImage = tilesetView["originSourceImage"].asString();
+
+        mapInfo->_tilesets.pushBack(tileset);
+        tileset->release();
+    }
+
+    for (uint32_t groupIndex = 0; groupIndex < objectGroups.size(); groupIndex++)
+    {
+        FlatValueView groupView = objectGroups.at(groupIndex);
+        TMXObjectGroup* objectGroup = new (std::nothrow) TMXObjectGroup(groupView["layerIndex"].asInt());
+
+        objectGroup->setGroupName(groupView["name"].asString());
+        objectGroup->setPositionOffset(Vec2(groupView["offsetX"].asFloat(), groupView["offsetY"].asFloat()));
+        objectGroup->setProperties(groupView["properties"].materialize().asValueMap());
+        objectGroup->getRawObjects() = groupView["objects"].materialize().asValueVector();
+
+        FlatValueView shapes = groupView["shapes"];
+
+        for (uint32_t index = 0; index < shapes.size(); index++)
+        {
+            FlatValueView shapeView = shapes.at(index);
+            const unsigned char* points = blob + shapeView["points"].asUnsignedInt();
+            uint32_t count = shapeView["count"].asUnsignedInt();
+
+            TMXObjectShape shape;
+            shape.objectIndex = shapeView["object"].asInt();
+            shape.polyline = shapeView["polyline"].asBool();
+            shape.points.resize(count);
+
+            for (uint32_t pointIndex = 0; pointIndex < count; pointIndex++)
+            {
+                memcpy(&shape.points[pointIndex].x, points + pointIndex * 8, sizeof(float));
+                memcpy(&shape.points[pointIndex].y, points + pointIndex * 8 + 4, sizeof(float));
+            }
+
+            objectGroup->addObjectShape(std::move(shape));
+        }
+
+        mapInfo->_objectGroups.pushBack(objectGroup);
+        objectGroup->release();
+    }
+
+    return true;
+}
+
+bool TMXMapCache::save(const TMXMapInfo* mapInfo, const std::string& cachePath, uint64_t sourceHash)
+{
+    const std::string mapDirectory = directoryOf(mapInfo->_TMXFileName);
+    std::vector<unsigned char> blob;
+    ValueMap root;
+
+    root["orientation"] = Value(mapInfo->_orientation);
+    root["staggerAxis"] = Value(mapInfo->_staggerAxis);
+    root["staggerIndex"] = Value(mapInfo->_staggerIndex);
+    root["hexSideLength"] = Value(mapInfo->_hexSideLength);
+    root["mapWidth"] = Value(mapInfo->_mapSize.width);
+    root["mapHeight"] = Value(mapInfo->_mapSize.height);
+    root["tileWidth"] = Value(mapInfo->_tileSize.width);
+    root["tileHeight"] = Value(mapInfo->_tileSize.height);
+    root["externalTileset"] = Value(mapInfo->_externalTilesetFilename);
+    root["properties"] = Value(mapInfo->_properties);
+    root["tileProperties"] = Value(mapInfo->_tileProperties);
+
+    ValueVector dependencies;
+
+    for (const auto& path : mapInfo->_externalTilesetFiles)
+    {
+        uint64_t hash = 0;
+
+        if (!hashFile(path, hash))
+        {
+            return false;
+        }
+
+        ValueMap dependency = encodePath(path, mapDirectory);
+        dependency["hash"] = Value(hashToString(hash));
+        dependencies.push_back(Value(std::move(dependency)));
+    }
+
+    root["dependencies"] = Value(std::move(dependencies));
+
+    ValueVector layers;
+
+    for (const auto& layer : mapInfo->_layers)
+    {
+        uint32_t tileCount = (uint32_t)(layer->_layerSize.width * layer->_layerSize.height);
+        ValueMap layerDict;
+
+        layerDict["index"] = Value(layer->_layerIndex);
+        layerDict["name"] = Value(layer->_name);
+        layerDict["width"] = Value(layer->_layerSize.width);
+        layerDict["height"] = Value(layer->_layerSize.height);
+        layerDict["visible"] = Value(layer->_visible);
+        layerDict["opacity"] = Value(layer->_opacity);
+        layerDict["offsetX"] = Value(layer->_offset.x);
+        layerDict["offsetY"] = Value(layer->_offset.y);
+        layerDict["properties"] = Value(layer->_properties);
+        layerDict["hasTiles"] = Value(layer->_tiles != nullptr);
+        layerDict["tileCount"] = Value(layer->_tiles != nullptr ? tileCount : 0u);
+        layerDict["tiles"] = Value(layer->_tiles != nullptr ? appendBlob(blob, layer->_tiles, tileCount * sizeof(uint32_t)) : 0u);
+
+        layers.push_back(Value(std::move(layerDict)));
+    }
+
+    root["layers"] = Value(std::move(layers));
+
+    ValueVector tilesets;
+
+    for (const auto& tileset : mapInfo->_tilesets)
+    {
+        ValueMap tilesetDict;
+
+        tilesetDict["name"] = Value(tileset->_name);
+        tilesetDict["firstGid"] = Value(tileset->_firstGid);
+        tilesetDict["tileWidth"] = Value(tileset->_tileSize.width);
+        tilesetDict["tileHeight"] = Value(tileset->_tileSize.height);
+        tilesetDict["spacing"] = Value(tileset->_spacing);
+        tilesetDict["margin"] = Value(tileset->_margin);
+        tilesetDict["tileOffsetX"] = Value(tileset->_tileOffset.x);
+        tilesetDict["tileOffsetY"] = Value(tileset->_tileOffset.y);
+        tilesetDict["sourceImage"] = Value(encodePath(tileset->_sourceImage, mapDirectory));
+        tilesetDict["imageWidth"] = Value(tileset->_imageSize.width);
+        tilesetDict["imageHeight"] = Value(tileset->_imageSize.height);
+        tilesetDict["originSourceImage"] = Value(tileset->_originSourceImage);
+
+        tilesets.push_back(Value(std::move(tilesetDict)));
+    }
+
+    root["tilesets"] = Value(std::move(tilesets));
+
+    ValueVector objectGroups;
+
+    for (const auto& objectGroup : mapInfo->_objectGroups)
+    {
+        ValueMap groupDict;
+
+        groupDict["layerIndex"] = Value(objectGroup->layerIndex);
+        groupDict["name"] = Value(objectGroup->getGroupName());
+        groupDict["offsetX"] = Value(objectGroup->getPositionOffset().x);
+        groupDict["offsetY"] = Value(objectGroup->getPositionOffset().y);
+        groupDict["properties"] = Value(objectGroup->getProperties());
+        groupDict["objects"] = Value(objectGroup->getRawObjects());
+
+        ValueVector shapes;
+
+        for (const auto& shape : objectGroup->getObjectShapes())
+        {
+            ValueMap shapeDict;
+            std::vector<float> points;
+            points.reserve(shape.points.size() * 2);
+
+            for (const auto& point : shape.points)
+            {
+                points.push_back(point.x);
+                points.push_back(point.y);
+            }
+
+            shapeDict["object"] = Value(shape.objectIndex);
+            shapeDict["polyline"] = Value(shape.polyline);
+            shapeDict["count"] = Value((unsigned int)shape.points.size());
+            shapeDict["points"] = Value(appendBlob(blob, points.data(), points.size() * sizeof(float)));
+
+            shapes.push_back(Value(std::move(shapeDict)));
+        }
+
+        groupDict["shapes"] = Value(std::move(shapes));
+        objectGroups.push_back(Value(std::move(groupDict)));
+    }
+
+    root["objectGroups"] = Value(std::move(objectGroups));
+
+    Data meta = FlatValueDocument::serialize(root, false);
+    uint32_t metaOffset = HEADER_SIZE;
+    uint32_t metaSize = (uint32_t)meta.getSize();
+    uint32_t blobOffset = (metaOffset + metaSize + 7) & ~7u;
+    uint32_t blobSize = (uint32_t)blob.size();
+    uint32_t totalSize = blobOffset + blobSize;
+
+    unsigned char* bytes = (unsigned char*)calloc(totalSize, 1);
+
+    if (bytes == nullptr)
+    {
+        return false;
+    }
+
+    uint16_t version = CACHE_VERSION;
+    writeUInt32(bytes, CACHE_MAGIC);
+    memcpy(bytes + 4, &version, sizeof(version));
+    memcpy(bytes + 8, &sourceHash, sizeof(sourceHash));
+    writeUInt32(bytes + 16, totalSize);
+    writeUInt32(bytes + 20, metaOffset);
+    writeUInt32(bytes + 24, metaSize);
+    writeUInt32(bytes + 28, blobOffset);
+    writeUInt32(bytes + 32, blobSize);
+    memcpy(bytes + metaOffset, meta.getBytes(), metaSize);
+
+    if (blobSize > 0)
+    {
+        memcpy(bytes + blobOffset, blob.data(), blobSize);
+    }
+
+    Data data;
+    data.fastSet(bytes, totalSize);
+
+    FileUtils* fileUtils = FileUtils::getInstance();
+    std::string directory = directoryOf(cachePath);
+
+    if (!directory.empty() && !fileUtils->isDirectoryExist(directory))
+    {
+        fileUtils->createDirectory(directory);
+    }
+
+    if (!fileUtils->writeDataToFile(data, cachePath))
+    {
+        CCLOG("cocos2d: TMXMapCache: could not write %s", cachePath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool TMXMapCache::compile(const std::string& tmxFile, const std::string& cachePath)
+{
+    TMXMapInfo* mapInfo = new (std::nothrow) TMXMapInfo();
+
+    if (mapInfo == nullptr)
+    {
+        return false;
+    }
+
+    mapInfo->autorelease();
+    mapInfo->internalInit(tmxFile, "");
+
+    uint64_t sourceHash = 0;
+
+    if (!hashFile(mapInfo->_TMXFileName, sourceHash) || !mapInfo->parseXMLFile(mapInfo->_TMXFileName))
+    {
+        return false;
+    }
+
+    return save(mapInfo, cachePath.empty() ? getCompiledPath(mapInfo->_TMXFileName) : cachePath, sourceHash);
+}
+
+NS_CC_END
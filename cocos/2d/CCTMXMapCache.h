@@ -0,0 +1,98 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_TMX_MAP_CACHE_H__
+#define __CC_TMX_MAP_CACHE_H__
+
+/// @cond DO_NOT_SHOW
+
+#include <stdint.h>
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class TMXMapInfo;
+
+/**
+ * Precompiled binary form of a parsed TMX map, so that level loads skip the XML parse and tile decoding.
+ *
+ * A cache file holds the map, layer, tileset and object group fields as flat binary values (see FlatValueDocument),
+ * followed by the raw tile arrays and object shape points. It is keyed by a hash of the TMX source, and records the hashes of
+ * any external tilesets, so a stale cache is simply ignored and the map is parsed from XML again.
+ *
+ * When enabled with setEnabled(), TMXMapInfo::initWithTMXFile() looks for "<map>.tmxc" next to the map first (produced offline with compile()), then for a
+ * cache in the writable path, which it writes itself after the first XML parse.
+ *
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL TMXMapCache
+{
+public:
+    /**
+     * Enables or disables reading and writing map caches. Disabled by default.
+     * The first-run caches are never evicted: every edit of a map source adds a file to "<writable path>/tmx_cache/",
+     * so games that enable this while maps still change should clear that directory themselves.
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * Hashes the contents of a file with 64-bit FNV-1a.
+     * @return False if the file could not be read.
+     */
+    static bool hashFile(const std::string& fullPath, uint64_t& hash);
+
+    /** Gets the path of the precompiled cache shipped next to a map, "<map>.tmxc". */
+    static std::string getCompiledPath(const std::string& tmxFullPath);
+
+    /** Gets the path of the first-run cache for a map source hash, inside the writable path. */
+    static std::string getCachePath(uint64_t sourceHash);
+
+    /**
+     * Fills a map info from the precompiled cache or the first-run cache, whichever is valid for the given source hash.
+     * The map info must have been set up with its TMX file name but not parsed.
+     */
+    static bool load(TMXMapInfo* mapInfo, uint64_t sourceHash);
+
+    /** Fills a map info from a specific cache file. Fails if the file is missing, corrupt, or was built from another source. */
+    static bool loadFromFile(TMXMapInfo* mapInfo, const std::string& cachePath, uint64_t sourceHash);
+
+    /** Writes a parsed map info to a cache file. */
+    static bool save(const TMXMapInfo* mapInfo, const std::string& cachePath, uint64_t sourceHash);
+
+    /**
+     * Parses a TMX file from XML and writes its cache, for use as an offline build step.
+     * @param tmxFile The map to compile.
+     * @param cachePath The output file. Defaults to getCompiledPath() of the map.
+     */
+    static bool compile(const std::string& tmxFile, const std::string& cachePath = "");
+};
+
+NS_CC_END
+
+/// @endcond
+#endif // __CC_TMX_MAP_CACHE_H__
@@ -27,6 +27,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 #include "2d/CCTMXObjectGroup.h"
+
+#include <algorithm>
+
 #include "base/ccMacros.h"
 
 NS_CC_BEGIN
@@ -35,6 +38,7 @@ NS_CC_BEGIN
 
 TMXObjectGroup::TMXObjectGroup(int index)
     : _groupName("")
+    , _shapesMaterialized(true)
 {
     this->layerIndex = index;
 }
@@ -46,9 +50,11 @@ TMXObjectGroup::~TMXObjectGroup()
 
 ValueMap TMXObjectGroup::getObject(const std::string& objectName) const
 {
-    if (!_objects.empty())
+    const ValueVector& objects = getObjects();
+
+    if (!objects.empty())
     {
-        for (const auto& v : _objects)
+        for (const auto& v : objects)
         {
             const ValueMap& dict = v.asValueMap();
             if (dict.find("name") != dict.end())
@@ -63,6 +69,89 @@ ValueMap TMXObjectGroup::getObject(const std::string& objectName) const
     return ValueMap();
 }
 
+const ValueVector& TMXObjectGroup::getObjects() const
+{
+    materializeShapes();
+    return _objects;
+}
+
+ValueVector& TMXObjectGroup::getObjects()
+{
+    materializeShapes();
+    return _objects;
+}
+
+void TMXObjectGroup::setObjects(const ValueVector& objects)
+{
+    _objects = objects;
+    _shapes.clear();
+    _shapesMaterialized = true;
+}
+
+const TMXObjectShape* TMXObjectGroup::getObjectShape(int objectIndex) const
+{
+    auto it = std::lower_bound(_shapes.begin(), _shapes.end(), objectIndex, [](const TMXObjectShape& shape, int index)
+    {
+        return shape.objectIndex < index;
+    });
+
+    return (it != _shapes.end() && it->objectIndex == objectIndex) ? &(*it) : nullptr;
+}
+
+void TMXObjectGroup::addObjectShape(TMXObjectShape&& shape)
+{
+    CCASSERT(_shapes.empty() || _shapes.back().objectIndex < shape.objectIndex, "Shapes must be added in object order");
+
+    _shapes.push_back(std::move(shape));
+    _shapesMaterialized = false;
+}
+
+void TMXObjectGroup::materializeShapes() const
+{
+    if (_shapesMaterialized)
+    {
+        return;
+    }
+
+    // The ValueMap form is part of the public API, so build it on demand for callers that still read it
+    TMXObjectGroup* self = const_cast<TMXObjectGroup*>(this);
+
+    for (const auto& shape : _shapes)
+    {
+        if (shape.objectIndex < 0 || shape.objectIndex >= (int)_objects.size())
+        {
+            continue;
+        }
+
+        ValueVector pointsArray;
+        pointsArray.reserve(shape.points.size());
+
+        for (const auto& point : shape.points)
+        {
+            ValueMap pointDict;
+
+            // Polylines have always been exposed as integer points
+            if (shape.polyline)
+            {
+                pointDict["x"] = Value((int)point.x);
+                pointDict["y"] = Value((int)point.y);
+            }
+            else
+            {
+                pointDict["x"] = Value(point.x);
+                pointDict["y"] = Value(point.y);
+            }
+
+            pointsArray.push_back(Value(std::move(pointDict)));
+        }
+
+        ValueMap& dict = self->_objects[shape.objectIndex].asValueMap();
+        dict[shape.polyline ? "polylinePoints" : "points"] = Value(std::move(pointsArray));
+    }
+
+    self->_shapesMaterialized = true;
+}
+
 Value TMXObjectGroup::getProperty(const std::string& propertyName) const
 {
     if (_properties.find(propertyName) != _properties.end())
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #ifndef __CCTMX_OBJECT_GROUP_H__
 #define __CCTMX_OBJECT_GROUP_H__
 
+#include <vector>
+
 #include "math/CCGeometry.h"
 #include "base/CCValue.h"
 #include "base/CCRef.h"
@@ -40,6 +42,18 @@ NS_CC_BEGIN
  * @{
  */
 
+/** @brief Points of a TMX polygon or polyline object, stored contiguously rather than as a ValueVector of "x"/"y" ValueMaps.
+ */
+struct CC_DLL TMXObjectShape
+{
+    /** Index of the object in TMXObjectGroup::getObjects(). */
+    int objectIndex;
+    /** True for a "polyline" object, false for a closed "polygon" object. */
+    bool polyline;
+    /** Points in pixels relative to the object, with the group position offset applied. */
+    std::vector<Vec2> points;
+};
+
 /** @brief TMXObjectGroup represents the TMX object group.
  * @since v0.99.0
  */
@@ -111,19 +125,39 @@ public:
     }
     
     /** Gets the array of the objects. 
+     * The first call expands polygon and polyline shapes into "points" / "polylinePoints" ValueVectors on each object.
+     * Use getRawObjects() together with getObjectShape() to avoid building them.
+     *
+     * @return The array of the objects.
+     */
+    const ValueVector& getObjects() const;
+    ValueVector& getObjects();
+
+    /** Gets the array of the objects, without "points" / "polylinePoints" entries unless getObjects() was already called.
      *
      * @return The array of the objects.
      */
-    const ValueVector& getObjects() const { return _objects; }
-    ValueVector& getObjects() { return _objects; }
+    const ValueVector& getRawObjects() const { return _objects; }
+    ValueVector& getRawObjects() { return _objects; }
     
-    /** Sets the array of the objects.
+    /** Sets the array of the objects. Any stored shapes are discarded, the objects are expected to carry their own points.
      *
      * @param objects The array of the objects.
      */
-    void setObjects(const ValueVector& objects) {
-        _objects = objects;
-    }
+    void setObjects(const ValueVector& objects);
+
+    /** Gets the polygon or polyline points of an object.
+     *
+     * @param objectIndex The index of the object in getObjects().
+     * @return The shape of the object, or nullptr if it is not a polygon or polyline.
+     */
+    const TMXObjectShape* getObjectShape(int objectIndex) const;
+
+    /** Gets all polygon and polyline shapes of the group, sorted by object index. */
+    const std::vector<TMXObjectShape>& getObjectShapes() const { return _shapes; }
+
+    /** Adds the shape of an object. Shapes must be added in increasing object index order. */
+    void addObjectShape(TMXObjectShape&& shape);
 
     int layerIndex;
     
@@ -136,6 +170,13 @@ protected:
     ValueMap _properties;
     /** array of the objects */
     ValueVector _objects;
+    /** polygon and polyline points, sorted by object index */
+    std::vector<TMXObjectShape> _shapes;
+    /** whether _shapes have been copied into _objects as ValueVectors */
+    bool _shapesMaterialized;
+
+private:
+    void materializeShapes() const;
 };
 
 // end of tilemap_parallax_nodes group
@@ -29,18 +29,457 @@ THE SOFTWARE.
 
 #include "CCTMXXMLParser.h"
 
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <unordered_map>
+#include <vector>
 
+#include "2d/CCTMXMapCache.h"
 #include "base/CCConsole.h"
-#include "base/base64.h"
 #include "base/CCDirector.h"
+#include "base/ZipUtils.h"
 #include "platform/CCFileUtils.h"
 
+#if __GNUC__ || __clang__
+    // #include <execution>
+#else
+    #include <execution>
+#endif
+
 using namespace std;
 
 NS_CC_BEGIN
 
+namespace
+{
+    // Layers with at least this many tiles have their base64/CSV text decoded in pieces with TRY_PARALLELIZE
+    const int PARALLEL_DECODE_TILE_THRESHOLD = 256 * 1024;
+
+    // Number of pieces the text of such a layer is split into
+    const int PARALLEL_DECODE_PIECE_COUNT = 8;
+
+    const unsigned char BASE64_INVALID = 0xFF;
+    const unsigned char BASE64_PADDING = 0xFE;
+
+    struct Base64Table
+    {
+        unsigned char values[256];
+
+        Base64Table()
+        {
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+            memset(values, BASE64_INVALID, sizeof(values));
+
+            for (unsigned char index = 0; index < 64; index++)
+            {
+                values[(unsigned char)alphabet[index]] = index;
+            }
+
+            values[(unsigned char)'='] = BASE64_PADDING;
+        }
+    };
+
+    const Base64Table s_base64Table;
+
+    bool isWhitespace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    // Gets the value of an attribute straight from the parser's name/value list, without copying it
+    const char* findAttribute(const char** atts, const char* key)
+    {
+        for (int i = 0; atts != nullptr && atts[i] != nullptr; i += 2)
+        {
+            if (strcmp(atts[i], key) == 0)
+            {
+                return atts[i + 1];
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Reads a decimal number such as "-12.5" or "1e3" and advances the cursor past it. Returns false if no digits were found.
+    bool scanNumber(const char*& cursor, float& result)
+    {
+        const char* it = cursor;
+        bool negative = false;
+
+        if (*it == '-' || *it == '+')
+        {
+            negative = (*it == '-');
+            it++;
+        }
+
+        double value = 0.0;
+        bool hasDigits = false;
+
+        for (; *it >= '0' && *it <= '9'; it++)
+        {
+            value = value * 10.0 + (*it - '0');
+            hasDigits = true;
+        }
+
+        if (*it == '.')
+        {
+            double scale = 0.1;
+
+            for (it++; *it >= '0' && *it <= '9'; it++)
+            {
+                value += (*it - '0') * scale;
+                scale *= 0.1;
+                hasDigits = true;
+            }
+        }
+
+        if (!hasDigits)
+        {
+            return false;
+        }
+
+        if (*it == 'e' || *it == 'E')
+        {
+            const char* exponentStart = it++;
+            bool negativeExponent = false;
+            int exponent = 0;
+
+            if (*it == '-' || *it == '+')
+            {
+                negativeExponent = (*it == '-');
+                it++;
+            }
+
+            if (*it >= '0' && *it <= '9')
+            {
+                for (; *it >= '0' && *it <= '9'; it++)
+                {
+                    exponent = std::min(exponent * 10 + (*it - '0'), 400);
+                }
+
+                value *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+            }
+            else
+            {
+                it = exponentStart;
+            }
+        }
+
+        result = (float)(negative ? -value : value);
+        cursor = it;
+
+        return true;
+    }
+
+    // Parses a Tiled "x,y x,y ..." point list. Polyline coordinates are truncated to integers, as they have always been.
+    void scanPoints(const char* text, const Vec2& offset, bool truncate, std::vector<Vec2>& points)
+    {
+        size_t pairCount = 1;
+
+        for (const char* it = text; *it != '\0'; it++)
+        {
+            pairCount += (*it == ' ');
+        }
+
+        points.reserve(pairCount);
+
+        const char* cursor = text;
+
+        while (*cursor != '\0')
+        {
+            while (*cursor == ',' || isWhitespace(*cursor))
+            {
+                cursor++;
+            }
+
+            float x = 0.0f;
+            float y = 0.0f;
+
+            if (!scanNumber(cursor, x))
+            {
+                // Skip anything that is not part of a number
+                if (*cursor != '\0')
+                {
+                    cursor++;
+                }
+
+                continue;
+            }
+
+            if (*cursor == ',')
+            {
+                cursor++;
+                scanNumber(cursor, y);
+            }
+
+            if (truncate)
+            {
+                points.emplace_back((float)((int)x + (int)offset.x), (float)((int)y + (int)offset.y));
+            }
+            else
+            {
+                points.emplace_back(x + offset.x, y + offset.y);
+            }
+        }
+    }
+
+    // Splits [0, count) into roughly equal ranges, one per decode piece, and runs task(first, last) on each with TRY_PARALLELIZE
+    template <typename Task>
+    void forEachRange(int count, const Task& task)
+    {
+        int pieceCount = std::max(1, std::min(PARALLEL_DECODE_PIECE_COUNT, count));
+        int rangeSize = (count + pieceCount - 1) / pieceCount;
+        std::vector<int> firsts;
+
+        for (int first = 0; first < count; first += rangeSize)
+        {
+            firsts.push_back(first);
+        }
+
+        TRY_PARALLELIZE(
+            firsts.begin(),
+            firsts.end(),
+            [&](int first)
+            {
+                task(first, std::min(first + rangeSize, count));
+            }
+        );
+    }
+
+    // Decodes base64 text straight into the output buffer, skipping whitespace and stopping at padding or once the output is full.
+    // Returns the number of bytes written.
+    size_t decodeBase64(const char* text, size_t length, unsigned char* out, size_t outLength)
+    {
+        const unsigned char* table = s_base64Table.values;
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+        const unsigned char* end = in + length;
+        size_t written = 0;
+        uint32_t accumulator = 0;
+        int sextets = 0;
+
+        while (in < end)
+        {
+            // Fast path: four valid characters in a row produce three bytes
+            if (sextets == 0 && end - in >= 4 && outLength - written >= 3)
+            {
+                unsigned char a = table[in[0]];
+                unsigned char b = table[in[1]];
+                unsigned char c = table[in[2]];
+                unsigned char d = table[in[3]];
+
+                if ((a | b | c | d) < 64)
+                {
+                    uint32_t bits = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | d;
+                    out[written] = (unsigned char)(bits >> 16);
+                    out[written + 1] = (unsigned char)(bits >> 8);
+                    out[written + 2] = (unsigned char)bits;
+                    written += 3;
+                    in += 4;
+                    continue;
+                }
+            }
+
+            unsigned char value = table[*in++];
+
+            if (value == BASE64_PADDING)
+            {
+                break;
+            }
+
+            if (value == BASE64_INVALID)
+            {
+                continue;
+            }
+
+            accumulator = (accumulator << 6) | value;
+
+            if (++sextets == 4)
+            {
+                for (int shift = 16; shift >= 0 && written < outLength; shift -= 8)
+                {
+                    out[written++] = (unsigned char)(accumulator >> shift);
+                }
+
+                accumulator = 0;
+                sextets = 0;
+            }
+        }
+
+        // Trailing partial group left by padding
+        if (sextets == 2 && written < outLength)
+        {
+            out[written++] = (unsigned char)(accumulator >> 4);
+        }
+        else if (sextets == 3)
+        {
+            for (int shift = 10; shift >= 2 && written < outLength; shift -= 8)
+            {
+                out[written++] = (unsigned char)(accumulator >> shift);
+            }
+        }
+
+        return written;
+    }
+
+    // Decodes uncompressed base64 tile data directly into the tile buffer, splitting large unbroken runs of text into pieces
+    void decodeBase64Tiles(const char* text, size_t length, uint32_t* tiles, int tilesAmount)
+    {
+        unsigned char* out = reinterpret_cast<unsigned char*>(tiles);
+        size_t outLength = (size_t)tilesAmount * sizeof(uint32_t);
+
+        while (length > 0 && isWhitespace(text[0]))
+        {
+            text++;
+            length--;
+        }
+
+        while (length > 0 && isWhitespace(text[length - 1]))
+        {
+            length--;
+        }
+
+        bool canSplit = tilesAmount >= PARALLEL_DECODE_TILE_THRESHOLD
+            && std::find_if(text, text + length, isWhitespace) == text + length;
+
+        if (!canSplit)
+        {
+            decodeBase64(text, length, out, outLength);
+            return;
+        }
+
+        // Without interior whitespace every group of four characters maps to three bytes, so each piece can start at a group boundary
+        int groupCount = (int)((length + 3) / 4);
+
+        forEachRange(groupCount, [=](int firstGroup, int lastGroup)
+        {
+            size_t textBegin = (size_t)firstGroup * 4;
+            size_t textEnd = std::min((size_t)lastGroup * 4, length);
+            size_t outBegin = (size_t)firstGroup * 3;
+
+            if (outBegin < outLength)
+            {
+                decodeBase64(text + textBegin, textEnd - textBegin, out + outBegin, outLength - outBegin);
+            }
+        });
+    }
+
+    // Parses comma separated gids in [begin, end) into tiles, starting at the given tile index
+    void parseCsvRange(const char* begin, const char* end, uint32_t* tiles, int tilesAmount, int index)
+    {
+        uint32_t value = 0;
+        bool hasDigits = false;
+
+        for (const char* it = begin; it < end; it++)
+        {
+            unsigned int digit = (unsigned int)(*it - '0');
+
+            if (digit < 10)
+            {
+                value = value * 10 + digit;
+                hasDigits = true;
+            }
+            else if (*it == ',')
+            {
+                if (index < tilesAmount)
+                {
+                    tiles[index] = value;
+                }
+
+                index++;
+                value = 0;
+                hasDigits = false;
+            }
+        }
+
+        if (hasDigits && index < tilesAmount)
+        {
+            tiles[index] = value;
+        }
+    }
+
+    void decodeCsvTiles(const char* text, size_t length, uint32_t* tiles, int tilesAmount)
+    {
+        const char* end = text + length;
+
+        if (tilesAmount < PARALLEL_DECODE_TILE_THRESHOLD)
+        {
+            parseCsvRange(text, end, tiles, tilesAmount, 0);
+            return;
+        }
+
+        // Split the text just after commas, count the commas in each piece to find where its first gid goes, then parse the pieces in parallel
+        int pieceCount = PARALLEL_DECODE_PIECE_COUNT;
+        std::vector<const char*> splits(pieceCount + 1, end);
+        std::vector<int> firstIndices(pieceCount, 0);
+
+        splits[0] = text;
+
+        for (int piece = 1; piece < pieceCount; piece++)
+        {
+            const char* split = std::max(splits[piece - 1], text + length * piece / pieceCount);
+            const char* comma = (const char*)memchr(split, ',', end - split);
+            splits[piece] = comma ? comma + 1 : end;
+        }
+
+        forEachRange(pieceCount, [&](int first, int last)
+        {
+            for (int piece = first; piece < last; piece++)
+            {
+                firstIndices[piece] = (int)std::count(splits[piece], splits[piece + 1], ',');
+            }
+        });
+
+        for (int piece = 0, index = 0; piece < pieceCount; piece++)
+        {
+            int commas = firstIndices[piece];
+            firstIndices[piece] = index;
+            index += commas;
+        }
+
+        forEachRange(pieceCount, [&](int first, int last)
+        {
+            for (int piece = first; piece < last; piece++)
+            {
+                parseCsvRange(splits[piece], splits[piece + 1], tiles, tilesAmount, firstIndices[piece]);
+            }
+        });
+    }
+
+    // Decodes base64 text that wraps a compressed stream, then decompresses it straight into the tile buffer
+    bool decodeCompressedTiles(const std::string& text, int layerAttribs, uint32_t* tiles, int tilesAmount)
+    {
+        std::vector<unsigned char> compressed(text.size() / 4 * 3 + 3);
+        size_t compressedLength = decodeBase64(text.data(), text.size(), compressed.data(), compressed.size());
+        ssize_t tilesLength = (ssize_t)tilesAmount * sizeof(uint32_t);
+        ssize_t written = -1;
+
+        if (layerAttribs & (TMXLayerAttribZlib | TMXLayerAttribGzip))
+        {
+            written = ZipUtils::inflateMemoryInto(compressed.data(), (ssize_t)compressedLength, reinterpret_cast<unsigned char*>(tiles), tilesLength);
+        }
+        else if (layerAttribs & TMXLayerAttribZstd)
+        {
+            written = ZipUtils::decompressZstdInto(compressed.data(), (ssize_t)compressedLength, reinterpret_cast<unsigned char*>(tiles), tilesLength);
+        }
+
+        if (written < 0)
+        {
+            return false;
+        }
+
+        // A layer of the wrong size is corrupt or truncated, and fails like any other undecodable layer rather than loading partly empty
+        if (written != tilesLength)
+        {
+            CCLOG("cocos2d: TiledMap: decompressed layer is %d bytes, expected %d", (int)written, (int)tilesLength);
+            return false;
+        }
+
+        return true;
+    }
+}
+
 // implementation TMXLayerInfo
 TMXLayerInfo::TMXLayerInfo(int index)
 : _name("")
@@ -146,6 +585,7 @@ void TMXMapInfo::internalInit(const std::string& tmxFileName, const std::string&
     // tmp vars
     _currentString = "";
     _storingCharacters = false;
+    _parseFailed = false;
     _layerAttribs = TMXLayerAttribNone;
     _parentElement = TMXPropertyNone;
     _currentFirstGID = -1;
@@ -160,7 +600,26 @@ bool TMXMapInfo::initWithXML(const std::string& tmxString, const std::string& re
 bool TMXMapInfo::initWithTMXFile(const std::string& tmxFile)
 {
     internalInit(tmxFile, "");
-    return parseXMLFile(_TMXFileName);
+
+    uint64_t sourceHash = 0;
+    bool useCache = TMXMapCache::isEnabled() && TMXMapCache::hashFile(_TMXFileName, sourceHash);
+
+    if (useCache && TMXMapCache::load(this, sourceHash))
+    {
+        return true;
+    }
+
+    if (!parseXMLFile(_TMXFileName))
+    {
+        return false;
+    }
+
+    if (useCache)
+    {
+        TMXMapCache::save(this, TMXMapCache::getCachePath(sourceHash), sourceHash);
+    }
+
+    return true;
 }
 
 TMXMapInfo::TMXMapInfo()
@@ -175,6 +634,7 @@ TMXMapInfo::TMXMapInfo()
 , _tileSize(CSize::ZERO)
 , _layerAttribs(0)
 , _storingCharacters(false)
+, _parseFailed(false)
 , _xmlTileIndex(0)
 , _currentFirstGID(-1)
 , _recordFirstGID(true)
@@ -201,7 +661,7 @@ bool TMXMapInfo::parseXMLString(const std::string& xmlString)
 
     parser.setDelegator(this);
 
-    return parser.parse(xmlString.c_str(), len);
+    return parser.parse(xmlString.c_str(), len) && !_parseFailed;
 }
 
 bool TMXMapInfo::parseXMLFile(const std::string& xmlFilename)
@@ -215,7 +675,7 @@ bool TMXMapInfo::parseXMLFile(const std::string& xmlFilename)
     
     parser.setDelegator(this);
 
-    return parser.parse(FileUtils::getInstance()->fullPathForFilename(xmlFilename));
+    return parser.parse(FileUtils::getInstance()->fullPathForFilename(xmlFilename)) && !_parseFailed;
 }
 
 // the XML parser calls here with all the elements
@@ -317,6 +777,7 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char *name, const char **atts
                 _currentFirstGID = 0;
             }
             _recordFirstGID = false;
+            _externalTilesetFiles.push_back(externalTilesetFilename);
             
             tmxMapInfo->parseXMLFile(externalTilesetFilename);
         }
@@ -452,7 +913,7 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char *name, const char **atts
 
         if (encoding == "")
         {
-            tmxMapInfo->setLayerAttribs(tmxMapInfo->getLayerAttribs() | TMXLayerAttribNone);
+            tmxMapInfo->setLayerAttribs(TMXLayerAttribNone);
             
             TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
             CSize layerSize = layer->_layerSize;
@@ -466,16 +927,37 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char *name, const char **atts
         }
         else if (encoding == "base64")
         {
-            int layerAttribs = tmxMapInfo->getLayerAttribs();
-            tmxMapInfo->setLayerAttribs(layerAttribs | TMXLayerAttribBase64);
-            tmxMapInfo->setStoringCharacters(true);
+            int layerAttribs = TMXLayerAttribBase64;
+
+            if (compression == "zlib")
+            {
+                layerAttribs |= TMXLayerAttribZlib;
+            }
+            else if (compression == "gzip")
+            {
+                layerAttribs |= TMXLayerAttribGzip;
+            }
+            else if (compression == "zstd")
+            {
+                layerAttribs |= TMXLayerAttribZstd;
+            }
+            else if (compression != "")
+            {
+                // Decoding the data as plain base64 would produce garbage gids, so the layer is left without tiles and the map fails to load
+                CCLOG("cocos2d: TMXFormat: Unsupported compression method: %s", compression.c_str());
+                tmxMapInfo->setLayerAttribs(0);
+                tmxMapInfo->setStoringCharacters(false);
+                _parseFailed = true;
+                return;
+            }
 
-            CCASSERT(compression == "", "TMX: unsupported compression method");
+            // Attribs describe the data element being parsed, so reset them rather than accumulating across layers
+            tmxMapInfo->setLayerAttribs(layerAttribs);
+            tmxMapInfo->setStoringCharacters(true);
         }
         else if (encoding == "csv")
         {
-            int layerAttribs = tmxMapInfo->getLayerAttribs();
-            tmxMapInfo->setLayerAttribs(layerAttribs | TMXLayerAttribCSV);
+            tmxMapInfo->setLayerAttribs(TMXLayerAttribCSV);
             tmxMapInfo->setStoringCharacters(true);
         }
     }
@@ -516,7 +998,7 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char *name, const char **atts
         dict["rotation"] = attributeDict["rotation"].asDouble();
 
         // Add the object to the objectGroup
-        objectGroup->getObjects().push_back(Value(dict));
+        objectGroup->getRawObjects().push_back(Value(dict));
 
         // The parent element is now "object"
         tmxMapInfo->setParentElement(TMXPropertyObject);
@@ -576,7 +1058,7 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char *name, const char **atts
         {
             // The parent element is the last object
             TMXObjectGroup* objectGroup = tmxMapInfo->getObjectGroups().back();
-            ValueMap& dict = objectGroup->getObjects().rbegin()->asValueMap();
+            ValueMap& dict = objectGroup->getRawObjects().rbegin()->asValueMap();
 
             std::string propertyName = attributeDict["name"].asString();
             dict[propertyName] = attributeDict["value"];
@@ -589,94 +1071,21 @@ void TMXMapInfo::startElement(void* /*ctx*/, const char *name, const char **atts
             dict[propertyName] = attributeDict["value"];
         }
     }
-    else if (elementName == "polygon") 
+    else if (elementName == "polygon" || elementName == "polyline")
     {
-        // find parent object's dict and add polygon-points to it
+        // The points are kept as a typed shape on the group, and only expanded into ValueMaps if getObjects() is called
         TMXObjectGroup* objectGroup = _objectGroups.back();
-        ValueMap& dict = objectGroup->getObjects().rbegin()->asValueMap();
+        const char* points = findAttribute(atts, "points");
 
-        // get points value string
-        std::string value = attributeDict["points"].asString();
-        if (!value.empty())
+        if (points != nullptr && *points != '\0' && !objectGroup->getRawObjects().empty())
         {
-            ValueVector pointsArray;
-            pointsArray.reserve(10);
-
-            // parse points string into a space-separated set of points
-            stringstream pointsStream(value);
-            string pointPair;
-            while (std::getline(pointsStream, pointPair, ' '))
-            {
-                // parse each point combo into a comma-separated x,y point
-                stringstream pointStream(pointPair);
-                string xStr, yStr;
-                
-                ValueMap pointDict;
+            TMXObjectShape shape;
+            shape.objectIndex = (int)objectGroup->getRawObjects().size() - 1;
+            shape.polyline = (elementName == "polyline");
 
-                // set x
-                if (std::getline(pointStream, xStr, ','))
-                {
-                    float x = atof(xStr.c_str()) + objectGroup->getPositionOffset().x;
-                    pointDict["x"] = Value(x);
-                }
+            scanPoints(points, objectGroup->getPositionOffset(), shape.polyline, shape.points);
 
-                // set y
-                if (std::getline(pointStream, yStr, ','))
-                {
-                    float y = atof(yStr.c_str()) + objectGroup->getPositionOffset().y;
-                    pointDict["y"] = Value(y);
-                }
-                
-                // add to points array
-                pointsArray.push_back(Value(pointDict));
-            }
-            
-            dict["points"] = Value(pointsArray);
-        }
-    } 
-    else if (elementName == "polyline")
-    {
-        // find parent object's dict and add polyline-points to it
-        TMXObjectGroup* objectGroup = _objectGroups.back();
-        ValueMap& dict = objectGroup->getObjects().rbegin()->asValueMap();
-        
-        // get points value string
-        std::string value = attributeDict["points"].asString();
-        if (!value.empty())
-        {
-            ValueVector pointsArray;
-            pointsArray.reserve(10);
-            
-            // parse points string into a space-separated set of points
-            stringstream pointsStream(value);
-            string pointPair;
-            while (std::getline(pointsStream, pointPair, ' '))
-            {
-                // parse each point combo into a comma-separated x,y point
-                stringstream pointStream(pointPair);
-                string xStr, yStr;
-                
-                ValueMap pointDict;
-                
-                // set x
-                if (std::getline(pointStream, xStr, ','))
-                {
-                    int x = atoi(xStr.c_str()) + (int)objectGroup->getPositionOffset().x;
-                    pointDict["x"] = Value(x);
-                }
-                
-                // set y
-                if (std::getline(pointStream, yStr, ','))
-                {
-                    int y = atoi(yStr.c_str()) + (int)objectGroup->getPositionOffset().y;
-                    pointDict["y"] = Value(y);
-                }
-                
-                // add to points array
-                pointsArray.push_back(Value(pointDict));
-            }
-            
-            dict["polylinePoints"] = Value(pointsArray);
+            objectGroup->addObjectShape(std::move(shape));
         }
     }
 }
@@ -688,64 +1097,52 @@ void TMXMapInfo::endElement(void* /*ctx*/, const char *name)
 
     if (elementName == "data")
     {
-        if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribBase64)
+        int layerAttribs = tmxMapInfo->getLayerAttribs();
+
+        if (layerAttribs & (TMXLayerAttribBase64 | TMXLayerAttribCSV))
         {
             tmxMapInfo->setStoringCharacters(false);
-            
+
             TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
-            
-            std::string currentString = tmxMapInfo->getCurrentString();
-            unsigned char *buffer;
-            base64Decode((unsigned char*)currentString.c_str(), (unsigned int)currentString.length(), &buffer);
-            
-            if (!buffer)
+            int tilesAmount = layer->_layerSize.width * layer->_layerSize.height;
+
+            // Decoders write straight into the final tile buffer; tiles missing from the data stay 0
+            uint32_t* tiles = (uint32_t*)calloc(tilesAmount, sizeof(uint32_t));
+
+            if (!tiles)
             {
-                CCLOG("cocos2d: TiledMap: decode data error");
+                CCLOG("cocos2d: TiledMap: tile buffer not allocated.");
                 return;
             }
-            
-            layer->_tiles = reinterpret_cast<uint32_t*>(buffer);
-            
-            tmxMapInfo->setCurrentString("");
-        }
-        else if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribCSV)
-        {
-            unsigned char *buffer;
 
-            TMXLayerInfo* layer = tmxMapInfo->getLayers().back();
+            bool decoded = true;
 
-            tmxMapInfo->setStoringCharacters(false);
-            std::string currentString = tmxMapInfo->getCurrentString();
-
-            vector<string> gidTokens;
-            istringstream filestr(currentString);
-            string sRow;
-            while(getline(filestr, sRow, '\n')) {
-                string sGID;
-                istringstream rowstr(sRow);
-                while (getline(rowstr, sGID, ',')) {
-                    gidTokens.push_back(sGID);
-                }
+            if (layerAttribs & TMXLayerAttribCSV)
+            {
+                decodeCsvTiles(_currentString.data(), _currentString.size(), tiles, tilesAmount);
             }
-
-            // 32-bits per gid
-            buffer = (unsigned char*)malloc(gidTokens.size() * 4);
-            if (!buffer)
+            else if (layerAttribs & (TMXLayerAttribZlib | TMXLayerAttribGzip | TMXLayerAttribZstd))
             {
-                CCLOG("cocos2d: TiledMap: CSV buffer not allocated.");
-                return;
+                decoded = decodeCompressedTiles(_currentString, layerAttribs, tiles, tilesAmount);
             }
-
-            uint32_t* bufferPtr = reinterpret_cast<uint32_t*>(buffer);
-            for(auto gidToken : gidTokens) {
-                auto tileGid = (uint32_t)strtoul(gidToken.c_str(), nullptr, 10);
-                *bufferPtr = tileGid;
-                bufferPtr++;
+            else
+            {
+                decodeBase64Tiles(_currentString.data(), _currentString.size(), tiles, tilesAmount);
             }
 
-            layer->_tiles = reinterpret_cast<uint32_t*>(buffer);
+            // Release the text of large layers right away instead of keeping it for the lifetime of the map info
+            _currentString.clear();
+            _currentString.shrink_to_fit();
 
-            tmxMapInfo->setCurrentString("");
+            if (!decoded)
+            {
+                CCLOG("cocos2d: TiledMap: decode data error");
+                free(tiles);
+                _parseFailed = true;
+                return;
+            }
+
+            layer->_tiles = tiles;
         }
         else if (tmxMapInfo->getLayerAttribs() & TMXLayerAttribNone)
         {
@@ -780,14 +1177,9 @@ void TMXMapInfo::endElement(void* /*ctx*/, const char *name)
 
 void TMXMapInfo::textHandler(void* /*ctx*/, const char *ch, size_t len)
 {
-    TMXMapInfo *tmxMapInfo = this;
-    std::string text(ch, 0, len);
-
-    if (tmxMapInfo->isStoringCharacters())
+    if (isStoringCharacters())
     {
-        std::string currentString = tmxMapInfo->getCurrentString();
-        currentString += text;
-        tmxMapInfo->setCurrentString(currentString);
+        _currentString.append(ch, len);
     }
 }
 
@@ -39,11 +39,13 @@ THE SOFTWARE.
 #include "2d/CCTMXObjectGroup.h" // needed for Vector<TMXObjectGroup*> for binding
 
 #include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
 class TMXLayerInfo;
 class TMXTilesetInfo;
+class TMXMapCache;
 
 /** @file
 * Internal TMX parser
@@ -105,6 +107,7 @@ enum {
     TMXLayerAttribGzip = 1 << 2,
     TMXLayerAttribZlib = 1 << 3,
     TMXLayerAttribCSV = 1 << 4,
+    TMXLayerAttribZstd = 1 << 5,
 };
 
 enum {
@@ -305,6 +308,9 @@ public:
     bool isStoringCharacters() const { return _storingCharacters; }
     void setStoringCharacters(bool storingCharacters) { _storingCharacters = storingCharacters; }
 
+    /// did a layer use data that could not be decoded?
+    bool isParseFailed() const { return _parseFailed; }
+
     /// properties
     const ValueMap& getProperties() const { return _properties; }
     ValueMap& getProperties() { return _properties; }
@@ -335,8 +341,12 @@ public:
     const std::string& getTMXFileName() const { return _TMXFileName; }
     void setTMXFileName(const std::string& fileName){ _TMXFileName = fileName; }
     const std::string& getExternalTilesetFileName() const { return _externalTilesetFilename; }
+    /// full paths of every external tileset (tsx) read while parsing
+    const std::vector<std::string>& getExternalTilesetFiles() const { return _externalTilesetFiles; }
 
 protected:
+    friend class TMXMapCache;
+
     void internalInit(const std::string& tmxFileName, const std::string& resourcePath);
 
     int    _currentLayerIndex;
@@ -366,6 +376,8 @@ protected:
     int _layerAttribs;
     /// is storing characters?
     bool _storingCharacters;
+    /// did a layer use data that could not be decoded?
+    bool _parseFailed;
     /// properties
     ValueMap _properties;
     //! xml format tile index
@@ -382,6 +394,7 @@ protected:
     int _currentFirstGID;
     bool _recordFirstGID;
     std::string _externalTilesetFilename;
+    std::vector<std::string> _externalTilesetFiles;
 };
 
 // end of tilemap_parallax_nodes group
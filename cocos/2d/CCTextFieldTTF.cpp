@@ -62,7 +62,8 @@ static std::size_t _cursorPositionToCharPosition(const char* textPtr, int cursor
 
     while (char nextChar = *textPtr)
     {
-        if (charCount >= cursorPos)
+        // Stop on a character boundary, never between a lead byte and its continuation bytes
+        if (charCount >= cursorPos && 0x80 != (0xC0 & nextChar))
         {
             break;
         }
@@ -79,6 +80,28 @@ static std::size_t _cursorPositionToCharPosition(const char* textPtr, int cursor
     return byteCount;
 }
 
+static std::size_t _charByteLength(const char* textPtr)
+{
+    if (*textPtr == '\0')
+    {
+        return 0;
+    }
+
+    std::size_t byteCount = 1;
+
+    while (textPtr[byteCount] != '\0' && 0x80 == (0xC0 & textPtr[byteCount]))
+    {
+        byteCount++;
+    }
+
+    return byteCount;
+}
+
+static bool _isCharBoundary(const std::string& text, std::size_t bytePos)
+{
+    return bytePos >= text.size() || 0x80 != (0xC0 & text[bytePos]);
+}
+
 static std::size_t _charPositionToCursorPosition(const char* textPtr, int bytePos)
 {
     int byteCount = 0;
@@ -144,6 +167,7 @@ TextFieldTTF::TextFieldTTF()
 , _cursorPosition(0)
 , _cursorChar(CURSOR_DEFAULT_CHAR)
 , _cursorShowingTime(0.0f)
+, _cursorLabel(nullptr)
 , _isAttachWithIME(false)
 {
     _colorSpaceHolder.r = _colorSpaceHolder.g = _colorSpaceHolder.b = 127;
@@ -152,6 +176,7 @@ TextFieldTTF::TextFieldTTF()
 
 TextFieldTTF::~TextFieldTTF()
 {
+    CC_SAFE_RELEASE(_cursorLabel);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -316,14 +341,14 @@ void TextFieldTTF::insertText(const char * text, size_t len)
 
         if (_cursorEnabled)
         {
-            StringUtils::StringUTF8 stringUTF8;
-
-            stringUTF8.replace(_inputText);
-            stringUTF8.insert(_cursorPosition, insert);
+            std::string sText(_inputText);
+            std::size_t bytePosition = _cursorPositionToCharPosition(_inputText.c_str(), (int)_cursorPosition);
+            CCASSERT(_isCharBoundary(sText, bytePosition), "TextFieldTTF: insert position splits a UTF-8 character");
+            sText.insert(bytePosition, insert);
 
             setCursorPosition(_cursorPosition + countInsertChar);
 
-            setString(stringUTF8.getAsCharSequence());
+            setString(sText);
         }
         else
         {
@@ -387,13 +412,13 @@ void TextFieldTTF::deleteBackward()
         {
             setCursorPosition(_cursorPosition - 1);
 
-            StringUtils::StringUTF8 stringUTF8;
-
-            stringUTF8.replace(_inputText);
-            stringUTF8.deleteChar(_cursorPosition);
+            std::string text(_inputText);
+            std::size_t bytePosition = _cursorPositionToCharPosition(text.c_str(), (int)_cursorPosition);
+            CCASSERT(_isCharBoundary(text, bytePosition), "TextFieldTTF: erase position splits a UTF-8 character");
+            text.erase(bytePosition, _charByteLength(text.c_str() + bytePosition));
 
-            _charCount = stringUTF8.length();
-            setString(stringUTF8.getAsCharSequence());
+            _charCount--;
+            setString(text);
         }
     }
     else
@@ -421,38 +446,47 @@ void TextFieldTTF::setCursorFromPoint(const Vec2 &point, const Camera* camera)
 {
     if (_cursorEnabled)
     {
-        // Reset Label, no cursor
-        bool oldIsAttachWithIME = _isAttachWithIME;
-        _isAttachWithIME = false;
-        updateCursorDisplayText();
-
         CRect rect;
         rect.size = getContentSize();
-        if (isScreenPointInRect(point, camera, getWorldToNodeTransform(), rect, nullptr))
+        Vec3 hitPoint;
+
+        if (isScreenPointInRect(point, camera, getWorldToNodeTransform(), rect, &hitPoint))
         {
-            int latterPosition = 0;
-            for (; latterPosition < _lengthOfString; ++latterPosition)
+            // Pick the line under the point, then the first letter on it whose center is right of the point
+            auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+            float lineStep = (_lineHeight + _lineSpacing * contentScaleFactor) / contentScaleFactor;
+            int lineIndex = lineStep > 0.f ? (int)std::floor((_letterOffsetY - hitPoint.y) / lineStep) : 0;
+            lineIndex = std::max(0, std::min(lineIndex, _numberOfLines - 1));
+
+            FontLetterDefinition letterDef;
+            int letterPosition = 0;
+
+            for (; letterPosition < _lengthOfString; ++letterPosition)
             {
-                if (_lettersInfo[latterPosition].valid)
+                const auto& letterInfo = _lettersInfo[letterPosition];
+
+                if (letterInfo.utf32Char == StringUtils::UnicodeCharacters::NewLine)
                 {
-                    auto sprite = getLetter(latterPosition);
-                        rect.size = sprite->getContentSize();
-                        if (isScreenPointInRect(point, camera, sprite->getWorldToNodeTransform(), rect, nullptr))
-                        {
-                            setCursorPosition(latterPosition);
-                            break;
-                        }
+                    if (letterInfo.lineIndex >= lineIndex)
+                    {
+                        break;
+                    }
+
+                    continue;
+                }
+
+                if (letterInfo.valid && letterInfo.lineIndex >= lineIndex && _fontAtlas->getLetterDefinitionForChar(letterInfo.utf32Char, letterDef))
+                {
+                    if (letterInfo.lineIndex > lineIndex
+                        || hitPoint.x < letterInfo.positionX + letterDef.width * _fontScale / 2 + _linesOffsetX[lineIndex])
+                    {
+                        break;
                     }
                 }
-            if (latterPosition == _lengthOfString)
-            {
-                setCursorPosition(latterPosition);
             }
-        }
 
-        // Set cursor
-        _isAttachWithIME = oldIsAttachWithIME;
-        updateCursorDisplayText();
+            setCursorPosition(std::min((std::size_t)letterPosition, _charCount));
+        }
     }
 }
 
@@ -473,6 +507,10 @@ void TextFieldTTF::setAttachWithIME(bool isAttachWithIME)
 void TextFieldTTF::setTextColor(const Color4B &color)
 {
     _colorText = color;
+    if (_cursorLabel)
+    {
+        _cursorLabel->setTextColor(_colorText);
+    }
     if (!_inputText.empty())
     {
         Label::setTextColor(_colorText);
@@ -485,6 +523,10 @@ void TextFieldTTF::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     {
         return;
     }
+    if (_cursorLabel)
+    {
+        updateCursorLabel();
+    }
     Label::visit(renderer,parentTransform,parentFlags);
 }
 
@@ -497,22 +539,93 @@ void TextFieldTTF::update(float delta)
         {
             _cursorShowingTime = CURSOR_TIME_SHOW_HIDE;
         }
-        // before cursor inserted '\b', need next letter
-        auto sprite = getLetter((int)_cursorPosition + 1, true);
+    }
+}
+
+void TextFieldTTF::updateCursorLabel()
+{
+    // The children may have been cleared since the cursor was added
+    if (_cursorLabel->getParent() != this)
+    {
+        _cursorLabel->removeFromParent();
+        addChild(_cursorLabel);
+    }
+
+    bool showCursor = _cursorEnabled && _isAttachWithIME && _cursorShowingTime >= 0.0f;
+    _cursorLabel->setVisible(showCursor);
 
-        if (sprite)
+    if (!showCursor)
+    {
+        return;
+    }
+
+    if (_currentLabelType == LabelType::TTF)
+    {
+        const TTFConfig& ttfConfig = getTTFConfig();
+        const TTFConfig& cursorConfig = _cursorLabel->getTTFConfig();
+
+        if (cursorConfig.fontFilePath != ttfConfig.fontFilePath || cursorConfig.fontSize != ttfConfig.fontSize)
         {
-            if (_cursorShowingTime >= 0.0f)
+            _cursorLabel->setTTFConfig(ttfConfig);
+        }
+    }
+    else if (_cursorLabel->getSystemFontName() != getSystemFontName() || _cursorLabel->getSystemFontSize() != getSystemFontSize())
+    {
+        _cursorLabel->setSystemFontName(getSystemFontName());
+        _cursorLabel->setSystemFontSize(getSystemFontSize());
+    }
+
+    // Lays the text out if it changed
+    const CSize& contentSize = getContentSize();
+
+    // Text rendered by the system has no per letter layout, so the cursor can only follow the end of the text
+    if (_currentLabelType != LabelType::TTF || _fontAtlas == nullptr)
+    {
+        _cursorLabel->setPosition(contentSize.width, 0.0f);
+        return;
+    }
+
+    // The cursor sits at the pen position of the letter after it, or after the letters before it
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    int letterIndex = std::min((int)_cursorPosition, _lengthOfString);
+    int lineIndex = 0;
+    float penX = 0.f;
+    FontLetterDefinition letterDef;
+
+    if (letterIndex < _lengthOfString && _lettersInfo[letterIndex].valid
+        && _fontAtlas->getLetterDefinitionForChar(_lettersInfo[letterIndex].utf32Char, letterDef))
+    {
+        penX = _lettersInfo[letterIndex].positionX - letterDef.offsetX * _fontScale / contentScaleFactor;
+        lineIndex = _lettersInfo[letterIndex].lineIndex;
+    }
+    else
+    {
+        for (int index = letterIndex - 1; index >= 0; --index)
+        {
+            const auto& letterInfo = _lettersInfo[index];
+
+            if (letterInfo.utf32Char == StringUtils::UnicodeCharacters::NewLine)
             {
-                sprite->setOpacity(255);
+                lineIndex = letterInfo.lineIndex + 1;
+                break;
             }
-            else
+
+            if (letterInfo.valid && _fontAtlas->getLetterDefinitionForChar(letterInfo.utf32Char, letterDef))
             {
-                sprite->setOpacity(0);
+                penX = letterInfo.positionX + ((letterDef.xAdvance - letterDef.offsetX) * _fontScale + _additionalKerning) / contentScaleFactor;
+                lineIndex = letterInfo.lineIndex;
+                break;
             }
-            sprite->setDirty(true);
         }
     }
+
+    if (lineIndex < (int)_linesOffsetX.size())
+    {
+        penX += _linesOffsetX[lineIndex];
+    }
+
+    float lineTop = _letterOffsetY - lineIndex * (_lineHeight + _lineSpacing * contentScaleFactor) / contentScaleFactor;
+    _cursorLabel->setPosition(penX, lineTop - _cursorLabel->getContentSize().height);
 }
 
 const Color4B& TextFieldTTF::getColorSpaceHolder()
@@ -580,10 +693,9 @@ void TextFieldTTF::setString(const std::string &text)
         _cursorPosition = charCount;
     }
 
-    if (_cursorEnabled)
+    if (_cursorPosition > charCount)
     {
-        // Need for recreate all letters in Label
-		Label::removeLetters();
+        _cursorPosition = charCount;
     }
 
     // if there is no input text, display placeholder instead
@@ -594,7 +706,11 @@ void TextFieldTTF::setString(const std::string &text)
     }
     else
     {
-        makeStringSupportCursor(displayText);
+        if (displayText.empty())
+        {
+            // An empty field still lays out one line for the cursor to sit on
+            displayText.push_back(StringUtils::AsciiCharacters::Space);
+        }
 
         Label::setTextColor(_colorText);
         Label::setString(displayText);
@@ -609,38 +725,6 @@ void TextFieldTTF::appendString(const std::string& text)
     insertText(text.c_str(), text.length());
 }
 
-void TextFieldTTF::makeStringSupportCursor(std::string& displayText)
-{
-    if (_cursorEnabled && _isAttachWithIME)
-    {
-        if (displayText.empty())
-        {
-            // \b - Next char not change x position
-            displayText.push_back((char)StringUtils::AsciiCharacters::NextCharNoChangeX);
-            displayText.push_back(_cursorChar);
-        }
-        else
-        {
-            StringUtils::StringUTF8 stringUTF8;
-            std::string cursorChar;
-
-            stringUTF8.replace(displayText);
-
-            if (_cursorPosition > stringUTF8.length())
-            {
-                _cursorPosition = stringUTF8.length();
-            }
-
-            // \b - Next char not change x position
-            cursorChar.push_back((char)StringUtils::AsciiCharacters::NextCharNoChangeX);
-            cursorChar.push_back(_cursorChar);
-            stringUTF8.insert(_cursorPosition, cursorChar);
-
-            displayText = stringUTF8.getAsCharSequence();
-        }
-    }
-}
-
 void TextFieldTTF::updateCursorDisplayText()
 {
     // Update Label content
@@ -652,7 +736,10 @@ void TextFieldTTF::setCursorChar(char cursor)
     if (_cursorChar != cursor)
     {
         _cursorChar = cursor;
-        updateCursorDisplayText();
+        if (_cursorLabel)
+        {
+            _cursorLabel->setString(std::string(1, _cursorChar));
+        }
     }
 }
 
@@ -666,13 +753,14 @@ void TextFieldTTF::controlKey(InputEvents::KeyCode keyCode)
         case InputEvents::KeyCode::KEY_KP_DELETE:
             if (_cursorPosition < (std::size_t)_charCount)
             {
-                StringUtils::StringUTF8 stringUTF8;
+                std::string text(_inputText);
+                std::size_t bytePosition = _cursorPositionToCharPosition(text.c_str(), (int)_cursorPosition);
+                CCASSERT(_isCharBoundary(text, bytePosition), "TextFieldTTF: erase position splits a UTF-8 character");
+                text.erase(bytePosition, _charByteLength(text.c_str() + bytePosition));
 
-                stringUTF8.replace(_inputText);
-                stringUTF8.deleteChar(_cursorPosition);
                 setCursorPosition(_cursorPosition);
-                _charCount = stringUTF8.length();
-                setString(stringUTF8.getAsCharSequence());
+                _charCount--;
+                setString(text);
             }
             break;
         case InputEvents::KeyCode::KEY_LEFT_ARROW:
@@ -806,26 +894,43 @@ const std::string& TextFieldTTF::getPlaceHolder() const
 
 void TextFieldTTF::setCursorEnabled(bool enabled)
 {
-    if (_currentLabelType == LabelType::TTF)
+    if (_cursorEnabled != enabled)
     {
-        if (_cursorEnabled != enabled)
+        _cursorEnabled = enabled;
+        if (_cursorEnabled)
         {
-            _cursorEnabled = enabled;
-            if (_cursorEnabled)
+            _cursorPosition = _charCount;
+
+            if (_currentLabelType == LabelType::TTF)
             {
-                _cursorPosition = _charCount;
-                scheduleUpdate();
+                _cursorLabel = Label::createWithTTF(getTTFConfig(), std::string(1, _cursorChar));
             }
             else
             {
-                _cursorPosition = 0;
-                unscheduleUpdate();
+                _cursorLabel = Label::createWithSystemFont(std::string(1, _cursorChar), getSystemFontName(), getSystemFontSize());
             }
+
+            // Retained, since Label::reset() and removeAllChildren() may drop it from the children
+            if (_cursorLabel)
+            {
+                _cursorLabel->retain();
+                _cursorLabel->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
+                _cursorLabel->setTextColor(_colorText);
+                _cursorLabel->setVisible(false);
+                addChild(_cursorLabel);
+            }
+            scheduleUpdate();
+        }
+        else
+        {
+            _cursorPosition = 0;
+            if (_cursorLabel)
+            {
+                _cursorLabel->removeFromParent();
+                CC_SAFE_RELEASE_NULL(_cursorLabel);
+            }
+            unscheduleUpdate();
         }
-    }
-    else
-    {
-        CCLOG("TextFieldTTF cursor worked only LabelType::TTF");
     }
 }
 
@@ -274,11 +274,13 @@ protected:
     char _cursorChar;
     // >0 - show, <0 - hide
     float _cursorShowingTime;
+    // Draws the cursor over the text, so moving or blinking it never lays the text out again
+    Label* _cursorLabel;
 
     bool _isAttachWithIME;
 
-    void makeStringSupportCursor(std::string& displayText);
     void updateCursorDisplayText();
+    void updateCursorLabel();
     void setAttachWithIME(bool isAttachWithIME);
 
 private:
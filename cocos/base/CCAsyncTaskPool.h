@@ -61,6 +61,7 @@ public:
         TASK_IO,
         TASK_NETWORK,
         TASK_OTHER,
+        TASK_GLYPH,
         TASK_MAX_TYPE,
     };
 
@@ -42,6 +42,8 @@ const char* Configuration::CONFIG_FILE_LOADED = "config_file_loaded";
 
 Configuration::Configuration()
 : _maxTextureSize(0) 
+, _supportsInstancedArrays(false)
+, _supportsPixelBufferObject(false)
 , _maxSamplesAllowed(0)
 , _glExtensions(nullptr)
 , _maxDirLightInShader(1)
@@ -104,6 +106,12 @@ void Configuration::gatherGPUInfo()
     
     _valueDict["gl.supports_vertex_array_object"] = Value(_supportsShareableVAO);
 
+    _supportsInstancedArrays = checkForGLExtension("GL_ARB_instanced_arrays") && checkForGLExtension("GL_ARB_draw_instanced");
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancedArrays);
+
+    _supportsPixelBufferObject = checkForGLExtension("GL_ARB_pixel_buffer_object");
+    _valueDict["gl.supports_pixel_buffer_object"] = Value(_supportsPixelBufferObject);
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -151,6 +159,16 @@ bool Configuration::supportsShareableVAO() const
 #endif
 }
 
+bool Configuration::supportsInstancedArrays() const
+{
+    return _supportsInstancedArrays;
+}
+
+bool Configuration::supportsPixelBufferObject() const
+{
+    return _supportsPixelBufferObject;
+}
+
 bool Configuration::supportsMapBuffer() const
 {
     return true;
@@ -89,6 +89,22 @@ public:
      */
 	bool supportsShareableVAO() const;
 
+    /** Whether or not instanced drawing with per instance vertex attributes is supported.
+     *
+     * Requires both `GL_ARB_instanced_arrays` and `GL_ARB_draw_instanced`.
+     *
+     * @return Is true if glVertexAttribDivisorARB() and glDrawArraysInstancedARB() can be used.
+     */
+    bool supportsInstancedArrays() const;
+
+    /** Whether or not pixel buffer objects are supported.
+     *
+     * Requires `GL_ARB_pixel_buffer_object`.
+     *
+     * @return Is true if glReadPixels() can write into a buffer bound to `GL_PIXEL_PACK_BUFFER`.
+     */
+    bool supportsPixelBufferObject() const;
+
     /** Whether or not glMapBuffer() is supported.
      *
      * On Desktop it returns `true`.
@@ -175,6 +191,8 @@ protected:
     GLint           _maxTextureSize;
     bool            _supportsNPOT;
     bool            _supportsShareableVAO;
+    bool            _supportsInstancedArrays;
+    bool            _supportsPixelBufferObject;
     
     GLint           _maxSamplesAllowed;
     char *          _glExtensions;
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCCamera.h"
 #include "2d/CCFontAtlasCache.h"
 #include "2d/CCFontFreeType.h"
+#include "2d/CCParticleSystemQuad.h"
 #include "base/CCAsyncTaskPool.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
@@ -935,6 +936,9 @@ void Director::reset()
     FontAtlasCache::purgeCachedData();
     
     FontFreeType::shutdownFreeType();
+
+    // the scene is gone, so every pooled particle system is idle
+    ParticleSystemQuad::purgePool();
     
     // purge all managed caches
     
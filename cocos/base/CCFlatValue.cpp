@@ -0,0 +1,826 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCFlatValue.h"
+
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    const uint32_t FLAT_VALUE_MAGIC = 0x56464343; // 'CCFV'
+    const uint16_t FLAT_VALUE_VERSION = 1;
+    const uint16_t FLAG_CIPHERED_STRINGS = 0x1;
+
+    const uint32_t HEADER_SIZE = 16;
+    const uint32_t SLOT_SIZE = 8;
+    const uint32_t MAP_ENTRY_SIZE = 4 + SLOT_SIZE;
+
+    // Bounds the recursion of FlatValueView::materialize() on deeply nested (or hostile) data
+    const int MAX_MATERIALIZE_DEPTH = 256;
+
+    inline uint32_t readU32(const unsigned char* bytes)
+    {
+        uint32_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    inline uint16_t readU16(const unsigned char* bytes)
+    {
+        uint16_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    inline bool isInRange(uint32_t offset, uint32_t length, uint32_t bufferSize)
+    {
+        return offset <= bufferSize && length <= bufferSize - offset;
+    }
+
+    class FlatValueWriter
+    {
+    public:
+        explicit FlatValueWriter(bool cipherStrings) : _cipherStrings(cipherStrings)
+        {
+            _buffer.reserve(4096);
+        }
+
+        Data write(const Value& root)
+        {
+            writeHeader();
+            writeSlot(HEADER_SIZE, root);
+
+            return finish();
+        }
+
+        Data write(const ValueMap& root)
+        {
+            // Avoids copying the whole map into a temporary Value just to describe the root
+            writeHeader();
+            uint32_t payload = writeMap(root);
+            writeU32(HEADER_SIZE, (uint32_t)Value::Type::MAP);
+            writeU32(HEADER_SIZE + 4, payload);
+
+            return finish();
+        }
+
+    private:
+        void writeHeader()
+        {
+            _buffer.assign(HEADER_SIZE + SLOT_SIZE, 0);
+            _strings.clear();
+
+            uint16_t version = FLAT_VALUE_VERSION;
+            uint16_t flags = _cipherStrings ? FLAG_CIPHERED_STRINGS : 0;
+            writeU32(0, FLAT_VALUE_MAGIC);
+            memcpy(&_buffer[4], &version, sizeof(version));
+            memcpy(&_buffer[6], &flags, sizeof(flags));
+        }
+
+        Data finish()
+        {
+            writeU32(8, (uint32_t)_buffer.size());
+
+            Data data;
+            data.copy(_buffer.data(), (ssize_t)_buffer.size());
+            return data;
+        }
+
+        uint32_t allocate(uint32_t length, uint32_t alignment = 4)
+        {
+            size_t offset = (_buffer.size() + alignment - 1) & ~((size_t)alignment - 1);
+            _buffer.resize(offset + length, 0);
+            return (uint32_t)offset;
+        }
+
+        void writeU32(uint32_t offset, uint32_t value)
+        {
+            memcpy(&_buffer[offset], &value, sizeof(value));
+        }
+
+        uint32_t writeString(const std::string& str)
+        {
+            auto it = _strings.find(str);
+
+            if (it != _strings.end())
+            {
+                return it->second;
+            }
+
+            uint32_t offset = allocate(4 + (uint32_t)str.size() + 1);
+            writeU32(offset, (uint32_t)str.size());
+            memcpy(&_buffer[offset + 4], str.data(), str.size());
+            _strings.emplace(str, offset);
+
+            return offset;
+        }
+
+        void writeSlot(uint32_t slotOffset, const Value& value)
+        {
+            Value::Type type = value.getType();
+            uint32_t payload = 0;
+
+            switch (type)
+            {
+                case Value::Type::BYTE:
+                    payload = value.asByte();
+                    break;
+                case Value::Type::INTEGER:
+                {
+                    int intVal = value.asInt();
+                    memcpy(&payload, &intVal, sizeof(payload));
+                    break;
+                }
+                case Value::Type::UNSIGNED:
+                    payload = value.asUnsignedInt();
+                    break;
+                case Value::Type::FLOAT:
+                {
+                    float floatVal = value.asFloat();
+                    memcpy(&payload, &floatVal, sizeof(payload));
+                    break;
+                }
+                case Value::Type::BOOLEAN:
+                    payload = value.asBool() ? 1 : 0;
+                    break;
+                case Value::Type::DOUBLE:
+                {
+                    double doubleVal = value.asDouble();
+                    payload = allocate(sizeof(doubleVal), 8);
+                    memcpy(&_buffer[payload], &doubleVal, sizeof(doubleVal));
+                    break;
+                }
+                case Value::Type::STRING:
+                    payload = writeString(_cipherStrings ? Value::xorCipher(value.asString()) : value.asString());
+                    break;
+                case Value::Type::VECTOR:
+                    payload = writeVector(value.asValueVector());
+                    break;
+                case Value::Type::MAP:
+                    payload = writeMap(value.asValueMap());
+                    break;
+                case Value::Type::INT_KEY_MAP:
+                    payload = writeIntKeyMap(value.asIntKeyMap());
+                    break;
+                case Value::Type::POINTER:
+                case Value::Type::NONE:
+                default:
+                    type = Value::Type::NONE;
+                    break;
+            }
+
+            writeU32(slotOffset, (uint32_t)type);
+            writeU32(slotOffset + 4, payload);
+        }
+
+        uint32_t writeVector(const ValueVector& vector)
+        {
+            uint32_t count = (uint32_t)vector.size();
+            uint32_t offset = allocate(4 + count * SLOT_SIZE);
+            writeU32(offset, count);
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                writeSlot(offset + 4 + index * SLOT_SIZE, vector[index]);
+            }
+
+            return offset;
+        }
+
+        uint32_t writeMap(const ValueMap& map)
+        {
+            // std::map iterates in key order, which is the order the binary search expects
+            uint32_t count = (uint32_t)map.size();
+            uint32_t offset = allocate(4 + count * MAP_ENTRY_SIZE);
+            uint32_t entry = offset + 4;
+            writeU32(offset, count);
+
+            for (const auto& pair : map)
+            {
+                writeU32(entry, writeString(pair.first));
+                writeSlot(entry + 4, pair.second);
+                entry += MAP_ENTRY_SIZE;
+            }
+
+            return offset;
+        }
+
+        uint32_t writeIntKeyMap(const ValueMapIntKey& map)
+        {
+            uint32_t count = (uint32_t)map.size();
+            uint32_t offset = allocate(4 + count * MAP_ENTRY_SIZE);
+            uint32_t entry = offset + 4;
+            writeU32(offset, count);
+
+            for (const auto& pair : map)
+            {
+                uint32_t key;
+                memcpy(&key, &pair.first, sizeof(key));
+                writeU32(entry, key);
+                writeSlot(entry + 4, pair.second);
+                entry += MAP_ENTRY_SIZE;
+            }
+
+            return offset;
+        }
+
+        bool _cipherStrings;
+        std::vector<unsigned char> _buffer;
+        std::unordered_map<std::string, uint32_t> _strings;
+    };
+}
+
+// Implement FlatValueView
+
+FlatValueView::FlatValueView()
+: _buffer(nullptr)
+, _bufferSize(0)
+, _cipheredStrings(false)
+, _type(Value::Type::NONE)
+, _payload(0)
+{
+}
+
+FlatValueView::FlatValueView(const unsigned char* buffer, uint32_t bufferSize, bool cipheredStrings, uint32_t slotOffset)
+: _buffer(buffer)
+, _bufferSize(bufferSize)
+, _cipheredStrings(cipheredStrings)
+, _type(Value::Type::NONE)
+, _payload(0)
+{
+    if (!isInRange(slotOffset, SLOT_SIZE, bufferSize))
+    {
+        return;
+    }
+
+    uint32_t type = readU32(buffer + slotOffset);
+
+    if (type > (uint32_t)Value::Type::INT_KEY_MAP || type == (uint32_t)Value::Type::POINTER)
+    {
+        return;
+    }
+
+    uint32_t payload = readU32(buffer + slotOffset + 4);
+
+    // The writer allocates every container before its children, so an offset that does not move forward can only come from corrupt data
+    bool isContainer = type == (uint32_t)Value::Type::VECTOR || type == (uint32_t)Value::Type::MAP || type == (uint32_t)Value::Type::INT_KEY_MAP;
+
+    if (isContainer && payload <= slotOffset)
+    {
+        return;
+    }
+
+    _type = (Value::Type)type;
+    _payload = payload;
+}
+
+FlatValueView FlatValueView::viewSlot(uint32_t slotOffset) const
+{
+    return FlatValueView(_buffer, _bufferSize, _cipheredStrings, slotOffset);
+}
+
+bool FlatValueView::readString(uint32_t offset, const char*& chars, uint32_t& length) const
+{
+    if (!isInRange(offset, 4, _bufferSize))
+    {
+        return false;
+    }
+
+    length = readU32(_buffer + offset);
+
+    if (!isInRange(offset + 4, length, _bufferSize))
+    {
+        return false;
+    }
+
+    chars = reinterpret_cast<const char*>(_buffer + offset + 4);
+    return true;
+}
+
+bool FlatValueView::readContainer(uint32_t entrySize, uint32_t& count, uint32_t& firstEntry) const
+{
+    if (!isInRange(_payload, 4, _bufferSize))
+    {
+        return false;
+    }
+
+    count = readU32(_buffer + _payload);
+    firstEntry = _payload + 4;
+
+    return count <= (_bufferSize - firstEntry) / entrySize;
+}
+
+Value FlatValueView::toScalarValue() const
+{
+    switch (_type)
+    {
+        case Value::Type::BYTE:
+            return Value((unsigned char)_payload);
+        case Value::Type::INTEGER:
+        {
+            int intVal;
+            memcpy(&intVal, &_payload, sizeof(intVal));
+            return Value(intVal);
+        }
+        case Value::Type::UNSIGNED:
+            return Value(_payload);
+        case Value::Type::FLOAT:
+        {
+            float floatVal;
+            memcpy(&floatVal, &_payload, sizeof(floatVal));
+            return Value(floatVal);
+        }
+        case Value::Type::DOUBLE:
+        {
+            double doubleVal = 0.0;
+
+            if (isInRange(_payload, sizeof(doubleVal), _bufferSize))
+            {
+                memcpy(&doubleVal, _buffer + _payload, sizeof(doubleVal));
+            }
+
+            return Value(doubleVal);
+        }
+        case Value::Type::BOOLEAN:
+            return Value(_payload != 0);
+        case Value::Type::STRING:
+            return Value(asString());
+        default:
+            return Value::Null;
+    }
+}
+
+unsigned char FlatValueView::asByte() const
+{
+    return _type == Value::Type::BYTE ? (unsigned char)_payload : toScalarValue().asByte();
+}
+
+int FlatValueView::asInt() const
+{
+    if (_type == Value::Type::INTEGER)
+    {
+        int intVal;
+        memcpy(&intVal, &_payload, sizeof(intVal));
+        return intVal;
+    }
+
+    return toScalarValue().asInt();
+}
+
+unsigned int FlatValueView::asUnsignedInt() const
+{
+    return _type == Value::Type::UNSIGNED ? _payload : toScalarValue().asUnsignedInt();
+}
+
+float FlatValueView::asFloat() const
+{
+    if (_type == Value::Type::FLOAT)
+    {
+        float floatVal;
+        memcpy(&floatVal, &_payload, sizeof(floatVal));
+        return floatVal;
+    }
+
+    return toScalarValue().asFloat();
+}
+
+double FlatValueView::asDouble() const
+{
+    return toScalarValue().asDouble();
+}
+
+bool FlatValueView::asBool() const
+{
+    return _type == Value::Type::BOOLEAN ? _payload != 0 : toScalarValue().asBool();
+}
+
+std::string FlatValueView::asString() const
+{
+    if (_type != Value::Type::STRING)
+    {
+        return toScalarValue().asString();
+    }
+
+    const char* chars = nullptr;
+    uint32_t length = 0;
+
+    if (!readString(_payload, chars, length))
+    {
+        return "";
+    }
+
+    std::string str(chars, length);
+    return _cipheredStrings ? Value::xorCipher(str) : str;
+}
+
+uint32_t FlatValueView::size() const
+{
+    if (_type != Value::Type::VECTOR && _type != Value::Type::MAP && _type != Value::Type::INT_KEY_MAP)
+    {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+
+    return readContainer(_type == Value::Type::VECTOR ? SLOT_SIZE : MAP_ENTRY_SIZE, count, firstEntry) ? count : 0;
+}
+
+FlatValueView FlatValueView::at(uint32_t index) const
+{
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+
+    if (_type != Value::Type::VECTOR || !readContainer(SLOT_SIZE, count, firstEntry) || index >= count)
+    {
+        return FlatValueView();
+    }
+
+    return viewSlot(firstEntry + index * SLOT_SIZE);
+}
+
+bool FlatValueView::findEntry(const char* key, size_t keyLength, uint32_t& entry) const
+{
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+
+    if (_type != Value::Type::MAP || !readContainer(MAP_ENTRY_SIZE, count, firstEntry))
+    {
+        return false;
+    }
+
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        const char* chars = nullptr;
+        uint32_t length = 0;
+
+        entry = firstEntry + mid * MAP_ENTRY_SIZE;
+
+        if (!readString(readU32(_buffer + entry), chars, length))
+        {
+            return false;
+        }
+
+        // Same ordering as std::string::compare, so it matches the std::map order the data was written in
+        int result = memcmp(chars, key, std::min((size_t)length, keyLength));
+
+        if (result == 0)
+        {
+            result = (length < keyLength) ? -1 : (length > keyLength ? 1 : 0);
+        }
+
+        if (result == 0)
+        {
+            return true;
+        }
+        else if (result < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return false;
+}
+
+FlatValueView FlatValueView::find(const char* key, size_t keyLength) const
+{
+    uint32_t entry = 0;
+
+    return findEntry(key, keyLength, entry) ? viewSlot(entry + 4) : FlatValueView();
+}
+
+FlatValueView FlatValueView::find(int key) const
+{
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+
+    if (_type != Value::Type::INT_KEY_MAP || !readContainer(MAP_ENTRY_SIZE, count, firstEntry))
+    {
+        return FlatValueView();
+    }
+
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t entry = firstEntry + mid * MAP_ENTRY_SIZE;
+        uint32_t rawKey = readU32(_buffer + entry);
+        int entryKey;
+        memcpy(&entryKey, &rawKey, sizeof(entryKey));
+
+        if (entryKey == key)
+        {
+            return viewSlot(entry + 4);
+        }
+        else if (entryKey < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return FlatValueView();
+}
+
+bool FlatValueView::hasKey(const std::string& key) const
+{
+    // A stored null value still counts as present, which find() alone cannot tell apart
+    uint32_t entry = 0;
+
+    return findEntry(key.data(), key.size(), entry);
+}
+
+std::string FlatValueView::getKeyAt(uint32_t index) const
+{
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+    const char* chars = nullptr;
+    uint32_t length = 0;
+
+    if (_type != Value::Type::MAP || !readContainer(MAP_ENTRY_SIZE, count, firstEntry) || index >= count
+        || !readString(readU32(_buffer + firstEntry + index * MAP_ENTRY_SIZE), chars, length))
+    {
+        return "";
+    }
+
+    return std::string(chars, length);
+}
+
+int FlatValueView::getIntKeyAt(uint32_t index) const
+{
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+
+    if (_type != Value::Type::INT_KEY_MAP || !readContainer(MAP_ENTRY_SIZE, count, firstEntry) || index >= count)
+    {
+        return 0;
+    }
+
+    uint32_t rawKey = readU32(_buffer + firstEntry + index * MAP_ENTRY_SIZE);
+    int key;
+    memcpy(&key, &rawKey, sizeof(key));
+
+    return key;
+}
+
+FlatValueView FlatValueView::getValueAt(uint32_t index) const
+{
+    uint32_t count = 0;
+    uint32_t firstEntry = 0;
+
+    if ((_type != Value::Type::MAP && _type != Value::Type::INT_KEY_MAP) || !readContainer(MAP_ENTRY_SIZE, count, firstEntry) || index >= count)
+    {
+        return FlatValueView();
+    }
+
+    return viewSlot(firstEntry + index * MAP_ENTRY_SIZE + 4);
+}
+
+Value FlatValueView::materialize() const
+{
+    return materialize(0);
+}
+
+Value FlatValueView::materialize(int depth) const
+{
+    if (depth > MAX_MATERIALIZE_DEPTH)
+    {
+        CCLOG("FlatValueView: value nested more than %d levels deep, ignoring it", MAX_MATERIALIZE_DEPTH);
+        return Value::Null;
+    }
+
+    switch (_type)
+    {
+        case Value::Type::VECTOR:
+        {
+            uint32_t count = size();
+            ValueVector vector;
+            vector.reserve(count);
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                vector.push_back(at(index).materialize(depth + 1));
+            }
+
+            return Value(std::move(vector));
+        }
+        case Value::Type::MAP:
+        {
+            uint32_t count = size();
+            ValueMap map;
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                // Entries are already sorted, so hinting at the end makes every insertion constant time
+                map.emplace_hint(map.end(), getKeyAt(index), getValueAt(index).materialize(depth + 1));
+            }
+
+            return Value(std::move(map));
+        }
+        case Value::Type::INT_KEY_MAP:
+        {
+            uint32_t count = size();
+            ValueMapIntKey map;
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                map.emplace_hint(map.end(), getIntKeyAt(index), getValueAt(index).materialize(depth + 1));
+            }
+
+            return Value(std::move(map));
+        }
+        default:
+            return toScalarValue();
+    }
+}
+
+// Implement FlatValueDocument
+
+FlatValueDocument::FlatValueDocument()
+: _bytes(nullptr)
+, _size(0)
+{
+}
+
+FlatValueDocument::FlatValueDocument(FlatValueDocument&& other)
+: _mappedFile(std::move(other._mappedFile))
+, _data(std::move(other._data))
+, _bytes(other._bytes)
+, _size(other._size)
+{
+    other._bytes = nullptr;
+    other._size = 0;
+}
+
+FlatValueDocument::~FlatValueDocument()
+{
+}
+
+FlatValueDocument& FlatValueDocument::operator= (FlatValueDocument&& other)
+{
+    if (this != &other)
+    {
+        _mappedFile = std::move(other._mappedFile);
+        _data = std::move(other._data);
+        _bytes = other._bytes;
+        _size = other._size;
+        other._bytes = nullptr;
+        other._size = 0;
+    }
+
+    return *this;
+}
+
+bool FlatValueDocument::initWithFile(const std::string& fullPath)
+{
+    clear();
+
+    if (_mappedFile.open(fullPath))
+    {
+        _bytes = _mappedFile.getBytes();
+        _size = (uint32_t)_mappedFile.getSize();
+    }
+    else
+    {
+        // Files inside archives or packages cannot be mapped, read them instead
+        _data = FileUtils::getInstance()->getDataFromFile(fullPath);
+        _bytes = _data.getBytes();
+        _size = (uint32_t)_data.getSize();
+    }
+
+    return validate();
+}
+
+bool FlatValueDocument::initWithData(Data&& data)
+{
+    clear();
+
+    _data = std::move(data);
+    _bytes = _data.getBytes();
+    _size = (uint32_t)_data.getSize();
+
+    return validate();
+}
+
+void FlatValueDocument::clear()
+{
+    _mappedFile.close();
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+}
+
+bool FlatValueDocument::validate()
+{
+    if (!isFlatValueData(_bytes, _size))
+    {
+        clear();
+        return false;
+    }
+
+    // Never read past the size recorded by the writer, even if the file has trailing bytes
+    _size = readU32(_bytes + 8);
+
+    return true;
+}
+
+FlatValueView FlatValueDocument::getRoot() const
+{
+    return getRootOfData(_bytes, _size);
+}
+
+FlatValueView FlatValueDocument::getRootOfData(const unsigned char* bytes, ssize_t size)
+{
+    if (!isFlatValueData(bytes, size))
+    {
+        return FlatValueView();
+    }
+
+    bool cipheredStrings = (readU16(bytes + 6) & FLAG_CIPHERED_STRINGS) != 0;
+
+    return FlatValueView(bytes, readU32(bytes + 8), cipheredStrings, HEADER_SIZE);
+}
+
+ValueMap FlatValueDocument::materializeValueMap() const
+{
+    FlatValueView root = getRoot();
+
+    if (root.getType() != Value::Type::MAP)
+    {
+        return ValueMap();
+    }
+
+    return std::move(root.materialize().asValueMap());
+}
+
+bool FlatValueDocument::isFlatValueData(const unsigned char* bytes, ssize_t size)
+{
+    if (bytes == nullptr || size < (ssize_t)(HEADER_SIZE + SLOT_SIZE))
+    {
+        return false;
+    }
+
+    uint32_t totalSize = readU32(bytes + 8);
+
+    return readU32(bytes) == FLAT_VALUE_MAGIC
+        && readU16(bytes + 4) == FLAT_VALUE_VERSION
+        && totalSize >= HEADER_SIZE + SLOT_SIZE
+        && (ssize_t)totalSize <= size;
+}
+
+Data FlatValueDocument::serialize(const Value& value, bool cipherStrings)
+{
+    FlatValueWriter writer(cipherStrings);
+
+    return writer.write(value);
+}
+
+Data FlatValueDocument::serialize(const ValueMap& valueMap, bool cipherStrings)
+{
+    FlatValueWriter writer(cipherStrings);
+
+    return writer.write(valueMap);
+}
+
+NS_CC_END
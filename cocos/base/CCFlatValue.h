@@ -0,0 +1,218 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __cocos2d_libs__CCFlatValue__
+#define __cocos2d_libs__CCFlatValue__
+
+#include <stdint.h>
+#include <string>
+
+#include "base/CCData.h"
+#include "base/CCValue.h"
+#include "platform/CCMappedFile.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/*
+ * Flat binary layout used by FlatValueView (all integers little endian, every record 4-byte aligned):
+ *
+ *  Header      : uint32 magic ('CCFV'), uint16 version, uint16 flags, uint32 total size, uint32 reserved
+ *  Root slot   : directly after the header
+ *  Slot        : uint32 type (Value::Type), uint32 payload
+ *                  BYTE, INTEGER, UNSIGNED, FLOAT, BOOLEAN -> the raw 32 bits of the value
+ *                  DOUBLE                                  -> offset of 8 raw bytes
+ *                  STRING                                  -> offset of a string record
+ *                  VECTOR                                  -> offset of { uint32 count, Slot[count] }
+ *                  MAP                                     -> offset of { uint32 count, { uint32 key string offset, Slot }[count] }, sorted by key
+ *                  INT_KEY_MAP                             -> offset of { uint32 count, { int32 key, Slot }[count] }, sorted by key
+ *  String      : uint32 length, chars[length], '\0'. Identical strings are stored once.
+ *
+ * A container record always starts after the slot that refers to it, so offsets strictly increase on the way down and cannot form cycles.
+ *
+ * String values are scrambled with Value::xorCipher() when FLAG_CIPHERED_STRINGS is set, to match the cereal save format. Keys are never scrambled.
+ * Pointers are not serializable and are written as null values.
+ */
+
+/**
+ * A read-only handle to a single value inside a flat binary buffer. Views are cheap to copy and never allocate,
+ * except when a string is returned or the value is materialized. A view is only valid while the buffer it points into is alive.
+ * Any malformed offset, including a container that does not lie after the slot referring to it, produces a null view rather than
+ * reading out of bounds or looping.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL FlatValueView
+{
+public:
+    /** Creates a null view. */
+    FlatValueView();
+
+    /** Gets the type of the viewed value. */
+    Value::Type getType() const { return _type; }
+
+    /** Checks if the view is null, either because the value is null or because it does not exist. */
+    bool isNull() const { return _type == Value::Type::NONE; }
+
+    /** Gets as a byte value, using the same conversion rules as Value::asByte(). */
+    unsigned char asByte() const;
+    /** Gets as an integer value, using the same conversion rules as Value::asInt(). */
+    int asInt() const;
+    /** Gets as an unsigned value, using the same conversion rules as Value::asUnsignedInt(). */
+    unsigned int asUnsignedInt() const;
+    /** Gets as a float value, using the same conversion rules as Value::asFloat(). */
+    float asFloat() const;
+    /** Gets as a double value, using the same conversion rules as Value::asDouble(). */
+    double asDouble() const;
+    /** Gets as a bool value, using the same conversion rules as Value::asBool(). */
+    bool asBool() const;
+    /** Gets as a string value, using the same conversion rules as Value::asString(). */
+    std::string asString() const;
+
+    /**
+     * Gets the number of elements of a VECTOR, MAP or INT_KEY_MAP value.
+     * @return The element count, or 0 for any other type.
+     */
+    uint32_t size() const;
+
+    /** Gets the element at the given index of a VECTOR value, or a null view if out of range. */
+    FlatValueView at(uint32_t index) const;
+
+    /** Looks up a key of a MAP value with a binary search. Returns a null view if the key is missing. */
+    FlatValueView find(const char* key, size_t keyLength) const;
+    FlatValueView find(const std::string& key) const { return find(key.data(), key.size()); }
+    FlatValueView operator[](const std::string& key) const { return find(key.data(), key.size()); }
+
+    /** Looks up a key of an INT_KEY_MAP value with a binary search. Returns a null view if the key is missing. */
+    FlatValueView find(int key) const;
+
+    /** Checks if a MAP value contains the given key. */
+    bool hasKey(const std::string& key) const;
+
+    /** Gets the key of the entry at the given index of a MAP value, in sorted order. */
+    std::string getKeyAt(uint32_t index) const;
+
+    /** Gets the key of the entry at the given index of an INT_KEY_MAP value, in sorted order. */
+    int getIntKeyAt(uint32_t index) const;
+
+    /** Gets the value of the entry at the given index of a MAP or INT_KEY_MAP value, in sorted order. */
+    FlatValueView getValueAt(uint32_t index) const;
+
+    /** Deep copies the viewed value (and everything below it) into a regular Value. Containers nested too deeply become null values. */
+    Value materialize() const;
+
+private:
+    friend class FlatValueDocument;
+
+    FlatValueView(const unsigned char* buffer, uint32_t bufferSize, bool cipheredStrings, uint32_t slotOffset);
+
+    bool findEntry(const char* key, size_t keyLength, uint32_t& entry) const;
+    bool readString(uint32_t offset, const char*& chars, uint32_t& length) const;
+    bool readContainer(uint32_t entrySize, uint32_t& count, uint32_t& firstEntry) const;
+    FlatValueView viewSlot(uint32_t slotOffset) const;
+    Value toScalarValue() const;
+    Value materialize(int depth) const;
+
+    const unsigned char* _buffer;
+    uint32_t _bufferSize;
+    bool _cipheredStrings;
+    Value::Type _type;
+    uint32_t _payload;
+};
+
+/**
+ * Owns a buffer in the flat binary ValueMap format, either memory mapped from disk or held in memory.
+ * Use getRoot() to query the data in place, or materializeValueMap() to build a regular ValueMap.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL FlatValueDocument
+{
+public:
+    FlatValueDocument();
+    FlatValueDocument(FlatValueDocument&& other);
+    ~FlatValueDocument();
+
+    FlatValueDocument& operator= (FlatValueDocument&& other);
+
+    /**
+     * Opens a flat binary file. The file is memory mapped when possible and read into memory otherwise.
+     * @param fullPath The absolute path of the file.
+     * @return True if the file exists and has a valid header.
+     */
+    bool initWithFile(const std::string& fullPath);
+
+    /**
+     * Takes ownership of a buffer holding flat binary data.
+     * @return True if the buffer has a valid header.
+     */
+    bool initWithData(Data&& data);
+
+    /** Releases the buffer. Views created from this document become invalid. */
+    void clear();
+
+    /** Gets a view of the root value, or a null view if the document is empty. */
+    FlatValueView getRoot() const;
+
+    /** Materializes the root value as a ValueMap. Returns an empty map if the root is not a map. */
+    ValueMap materializeValueMap() const;
+
+    /**
+     * Gets a view of the root value of a buffer owned by the caller, without copying it.
+     * @return A null view if the buffer is not valid flat binary data.
+     */
+    static FlatValueView getRootOfData(const unsigned char* bytes, ssize_t size);
+
+    /** Checks whether a buffer starts with a valid flat binary header. */
+    static bool isFlatValueData(const unsigned char* bytes, ssize_t size);
+
+    /**
+     * Encodes a value into the flat binary format.
+     * @param value The value to encode. Any Value type is accepted as root.
+     * @param cipherStrings Whether string values are scrambled with Value::xorCipher().
+     */
+    static Data serialize(const Value& value, bool cipherStrings = true);
+    static Data serialize(const ValueMap& valueMap, bool cipherStrings = true);
+
+private:
+    FlatValueDocument(const FlatValueDocument&) = delete;
+    FlatValueDocument& operator= (const FlatValueDocument&) = delete;
+
+    bool validate();
+
+    MappedFile _mappedFile;
+    Data _data;
+    const unsigned char* _bytes;
+    uint32_t _size;
+};
+
+NS_CC_END
+
+/** @} */
+
+#endif /* defined(__cocos2d_libs__CCFlatValue__) */
@@ -67,7 +67,7 @@ public:
      * Used when serializing strings to scramble the string on disk so it is not human readable.
      * Mathematically this is a self-inverse function, so xorCipher(xorCipher("swag")) returns "swag". 
      */
-    std::string xorCipher(std::string str) const
+    static std::string xorCipher(std::string str)
     {
         // Using multiple different chars to xor the string to make it harder to figure out what is going on
         char key[7] = {'S', 'q', 'u', 'a', 'l', 'l', 'y'};
@@ -0,0 +1,99 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/ZipUtils.h"
+
+#include <zlib.h>
+
+#if CC_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+ssize_t ZipUtils::inflateMemoryInto(const unsigned char* in, ssize_t inLength, unsigned char* out, ssize_t outLength)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = const_cast<Bytef*>(in);
+    stream.avail_in = (uInt)inLength;
+    stream.next_out = out;
+    stream.avail_out = (uInt)outLength;
+
+    // 15 window bits, +32 to accept both zlib and gzip headers
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        return -1;
+    }
+
+    int result = inflate(&stream, Z_FINISH);
+    ssize_t written = (ssize_t)stream.total_out;
+
+    inflateEnd(&stream);
+
+    // Z_BUF_ERROR with room left in the output means the input ended early, so the stream is truncated.
+    // With the output full it means the stream holds more data than the caller expects, which is left to the caller to reject.
+    bool outputFull = stream.avail_out == 0;
+
+    if (result != Z_STREAM_END && !(result == Z_BUF_ERROR && outputFull))
+    {
+        CCLOG("cocos2d: ZipUtils: inflate failed with error %d", result);
+        return -1;
+    }
+
+    return written;
+}
+
+ssize_t ZipUtils::decompressZstdInto(const unsigned char* in, ssize_t inLength, unsigned char* out, ssize_t outLength)
+{
+#if CC_USE_ZSTD
+    size_t result = ZSTD_decompress(out, (size_t)outLength, in, (size_t)inLength);
+
+    if (ZSTD_isError(result))
+    {
+        CCLOG("cocos2d: ZipUtils: zstd decompression failed: %s", ZSTD_getErrorName(result));
+        return -1;
+    }
+
+    return (ssize_t)result;
+#else
+    CCLOG("cocos2d: ZipUtils: zstd support is not compiled in, rebuild with BUILD_ZSTD_SUPPORT");
+    return -1;
+#endif
+}
+
+bool ZipUtils::isZstdSupported()
+{
+#if CC_USE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+NS_CC_END
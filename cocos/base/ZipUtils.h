@@ -0,0 +1,76 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __SUPPORT_ZIPUTILS_H__
+#define __SUPPORT_ZIPUTILS_H__
+/// @cond DO_NOT_SHOW
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCStdC.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ * Helpers for decompressing memory buffers.
+ * @js NA
+ * @lua NA
+ */
+struct CC_DLL ZipUtils
+{
+    /**
+     * Inflates a zlib or gzip stream (detected from its header) into a buffer owned by the caller.
+     * Use this when the decompressed size is known up front, such as TMX tile layers, to avoid any intermediate allocation.
+     *
+     * @param in The compressed data.
+     * @param inLength The length of the compressed data.
+     * @param out The destination buffer.
+     * @param outLength The capacity of the destination buffer.
+     * @return The number of bytes written, or -1 if the stream is corrupt or truncated. If the stream is larger than the buffer,
+     *         outLength is returned and the rest of the stream is ignored.
+     */
+    static ssize_t inflateMemoryInto(const unsigned char* in, ssize_t inLength, unsigned char* out, ssize_t outLength);
+
+    /**
+     * Decompresses a zstd frame into a buffer owned by the caller.
+     * Only available when the engine is built with BUILD_ZSTD_SUPPORT, otherwise it always fails.
+     *
+     * @return The number of bytes written, or -1 on failure.
+     */
+    static ssize_t decompressZstdInto(const unsigned char* in, ssize_t inLength, unsigned char* out, ssize_t outLength);
+
+    /** Checks whether decompressZstdInto() is available in this build. */
+    static bool isZstdSupported();
+};
+
+NS_CC_END
+
+/** @} */
+
+/// @endcond
+#endif // __SUPPORT_ZIPUTILS_H__
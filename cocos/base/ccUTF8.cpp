@@ -24,14 +24,24 @@
  THE SOFTWARE.
  ****************************************************************************/
 
+#include <cstring>
 #include <limits>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "ConvertUTF.h"
 #include "base/CCConsole.h"
 #include "base/ccUTF8.h"
 #include "platform/CCCommon.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_UTF8_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define CC_UTF8_NEON 1
+#include <arm_neon.h>
+#endif
+
 NS_CC_BEGIN
 
 namespace StringUtils {
@@ -304,14 +314,325 @@ bool utfConvert(
 };
 
 
+/*
+ * @bytes:    the UTF8 bytes to scan.
+ * @length:    the number of bytes.
+ *
+ * Return value: the length of the run of ASCII bytes the string starts with, checked 16 bytes at a time.
+ * */
+static std::size_t getASCIIRunLength(const unsigned char* bytes, std::size_t length)
+{
+    std::size_t index = 0;
+
+#if defined(CC_UTF8_SSE2)
+    for (; index + 16 <= length; index += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + index))) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(CC_UTF8_NEON)
+    for (; index + 16 <= length; index += 16)
+    {
+        uint64x2_t highBits = vreinterpretq_u64_u8(vandq_u8(vld1q_u8(bytes + index), vdupq_n_u8(0x80)));
+
+        if ((vgetq_lane_u64(highBits, 0) | vgetq_lane_u64(highBits, 1)) != 0)
+        {
+            break;
+        }
+    }
+#endif
+
+    for (; index + 8 <= length; index += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + index, sizeof(word));
+
+        if ((word & 0x8080808080808080ULL) != 0)
+        {
+            break;
+        }
+    }
+
+    while (index < length && bytes[index] < 0x80)
+    {
+        index++;
+    }
+
+    return index;
+}
+
+/*
+ * Widens a run of ASCII bytes into UTF16 or UTF32 code units.
+ * */
+static void widenASCII(const unsigned char* bytes, std::size_t length, char16_t* out)
+{
+    std::size_t index = 0;
+
+#if defined(CC_UTF8_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; index + 16 <= length; index += 16)
+    {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + index));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index), _mm_unpacklo_epi8(chars, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index + 8), _mm_unpackhi_epi8(chars, zero));
+    }
+#elif defined(CC_UTF8_NEON)
+    for (; index + 16 <= length; index += 16)
+    {
+        uint8x16_t chars = vld1q_u8(bytes + index);
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + index), vmovl_u8(vget_low_u8(chars)));
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + index + 8), vmovl_u8(vget_high_u8(chars)));
+    }
+#endif
+
+    for (; index < length; ++index)
+    {
+        out[index] = bytes[index];
+    }
+}
+
+static void widenASCII(const unsigned char* bytes, std::size_t length, char32_t* out)
+{
+    std::size_t index = 0;
+
+#if defined(CC_UTF8_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; index + 16 <= length; index += 16)
+    {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + index));
+        __m128i low = _mm_unpacklo_epi8(chars, zero);
+        __m128i high = _mm_unpackhi_epi8(chars, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index + 12), _mm_unpackhi_epi16(high, zero));
+    }
+#elif defined(CC_UTF8_NEON)
+    for (; index + 16 <= length; index += 16)
+    {
+        uint8x16_t chars = vld1q_u8(bytes + index);
+        uint16x8_t low = vmovl_u8(vget_low_u8(chars));
+        uint16x8_t high = vmovl_u8(vget_high_u8(chars));
+        vst1q_u32(reinterpret_cast<uint32_t*>(out + index), vmovl_u16(vget_low_u16(low)));
+        vst1q_u32(reinterpret_cast<uint32_t*>(out + index + 4), vmovl_u16(vget_high_u16(low)));
+        vst1q_u32(reinterpret_cast<uint32_t*>(out + index + 8), vmovl_u16(vget_low_u16(high)));
+        vst1q_u32(reinterpret_cast<uint32_t*>(out + index + 12), vmovl_u16(vget_high_u16(high)));
+    }
+#endif
+
+    for (; index < length; ++index)
+    {
+        out[index] = bytes[index];
+    }
+}
+
+/*
+ * @bytes:    the start of a multi byte UTF8 sequence.
+ * @length:    the number of bytes left in the string.
+ *
+ * Validates the sequence with the same rules as ConvertUTF's strict conversion: no overlong forms, no surrogates, nothing above U+10FFFF.
+ *
+ * Return value: the length of the sequence, or 0 if it is not legal.
+ * */
+static std::size_t getLegalUTF8SequenceLength(const unsigned char* bytes, std::size_t length)
+{
+    unsigned char lead = bytes[0];
+    std::size_t sequenceLength;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+
+    if (lead < 0xC2)
+    {
+        return 0;
+    }
+    else if (lead < 0xE0)
+    {
+        sequenceLength = 2;
+    }
+    else if (lead < 0xF0)
+    {
+        sequenceLength = 3;
+        secondMin = lead == 0xE0 ? 0xA0 : 0x80;
+        secondMax = lead == 0xED ? 0x9F : 0xBF;
+    }
+    else if (lead < 0xF5)
+    {
+        sequenceLength = 4;
+        secondMin = lead == 0xF0 ? 0x90 : 0x80;
+        secondMax = lead == 0xF4 ? 0x8F : 0xBF;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (sequenceLength > length || bytes[1] < secondMin || bytes[1] > secondMax)
+    {
+        return 0;
+    }
+
+    for (std::size_t index = 2; index < sequenceLength; ++index)
+    {
+        if ((bytes[index] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+    }
+
+    return sequenceLength;
+}
+
+/*
+ * Return value: the number of UTF16 (unitsPerSupplementary == 2) or UTF32 (1) code units the UTF8 string converts to, or -1 if it is not legal.
+ * */
+static long countUTF8CodeUnits(const unsigned char* bytes, std::size_t length, long unitsPerSupplementary)
+{
+    long count = 0;
+    std::size_t index = 0;
+
+    while (index < length)
+    {
+        if (bytes[index] < 0x80)
+        {
+            std::size_t asciiLength = getASCIIRunLength(bytes + index, length - index);
+            index += asciiLength;
+            count += static_cast<long>(asciiLength);
+            continue;
+        }
+
+        std::size_t sequenceLength = getLegalUTF8SequenceLength(bytes + index, length - index);
+
+        if (sequenceLength == 0)
+        {
+            return -1;
+        }
+
+        index += sequenceLength;
+        count += sequenceLength == 4 ? unitsPerSupplementary : 1;
+    }
+
+    return count;
+}
+
+/*
+ * Decodes a UTF8 string that countUTF8CodeUnits() accepted.
+ * */
+template <typename T>
+static void decodeLegalUTF8(const unsigned char* bytes, std::size_t length, T* out)
+{
+    std::size_t index = 0;
+
+    while (index < length)
+    {
+        unsigned char lead = bytes[index];
+
+        if (lead < 0x80)
+        {
+            std::size_t asciiLength = getASCIIRunLength(bytes + index, length - index);
+            widenASCII(bytes + index, asciiLength, out);
+            index += asciiLength;
+            out += asciiLength;
+        }
+        else if (lead < 0xE0)
+        {
+            *out++ = static_cast<T>(((lead & 0x1F) << 6) | (bytes[index + 1] & 0x3F));
+            index += 2;
+        }
+        else if (lead < 0xF0)
+        {
+            *out++ = static_cast<T>(((lead & 0x0F) << 12) | ((bytes[index + 1] & 0x3F) << 6) | (bytes[index + 2] & 0x3F));
+            index += 3;
+        }
+        else
+        {
+            char32_t codePoint = ((lead & 0x07) << 18) | ((bytes[index + 1] & 0x3F) << 12) | ((bytes[index + 2] & 0x3F) << 6) | (bytes[index + 3] & 0x3F);
+            index += 4;
+
+            if (sizeof(T) == sizeof(char16_t))
+            {
+                codePoint -= 0x10000;
+                *out++ = static_cast<T>(0xD800 + (codePoint >> 10));
+                *out++ = static_cast<T>(0xDC00 + (codePoint & 0x3FF));
+            }
+            else
+            {
+                *out++ = static_cast<T>(codePoint);
+            }
+        }
+    }
+}
+
+template <typename T>
+static long utf8ConvertToBuffer(const char* utf8, std::size_t length, T* out, std::size_t outCapacity)
+{
+    auto bytes = reinterpret_cast<const unsigned char*>(utf8);
+    long count = countUTF8CodeUnits(bytes, length, sizeof(T) == sizeof(char16_t) ? 2 : 1);
+
+    if (count < 0 || static_cast<std::size_t>(count) > outCapacity)
+    {
+        return -1;
+    }
+
+    decodeLegalUTF8(bytes, length, out);
+
+    return count;
+}
+
+template <typename T>
+static bool utf8Convert(const std::string& utf8, std::basic_string<T>& out)
+{
+    auto bytes = reinterpret_cast<const unsigned char*>(utf8.data());
+    std::size_t length = utf8.length();
+    std::size_t asciiLength = getASCIIRunLength(bytes, length);
+
+    // Validate first, so that the output is untouched on failure and its capacity is reused on success
+    long count = static_cast<long>(asciiLength);
+
+    if (asciiLength < length)
+    {
+        long remaining = countUTF8CodeUnits(bytes + asciiLength, length - asciiLength, sizeof(T) == sizeof(char16_t) ? 2 : 1);
+
+        if (remaining < 0)
+        {
+            return false;
+        }
+
+        count += remaining;
+    }
+
+    out.resize(count);
+
+    if (count > 0)
+    {
+        widenASCII(bytes, asciiLength, &out[0]);
+        decodeLegalUTF8(bytes + asciiLength, length - asciiLength, &out[asciiLength]);
+    }
+
+    return true;
+}
+
 bool UTF8ToUTF16(const std::string& utf8, std::u16string& outUtf16)
 {
-    return utfConvert(utf8, outUtf16, ConvertUTF8toUTF16);
+    return utf8Convert(utf8, outUtf16);
 }
 
 bool UTF8ToUTF32(const std::string& utf8, std::u32string& outUtf32)
 {
-    return utfConvert(utf8, outUtf32, ConvertUTF8toUTF32);
+    return utf8Convert(utf8, outUtf32);
+}
+
+long UTF8ToUTF16(const char* utf8, std::size_t length, char16_t* outUtf16, std::size_t outCapacity)
+{
+    return utf8ConvertToBuffer(utf8, length, outUtf16, outCapacity);
+}
+
+long UTF8ToUTF32(const char* utf8, std::size_t length, char32_t* outUtf32, std::size_t outCapacity)
+{
+    return utf8ConvertToBuffer(utf8, length, outUtf32, outCapacity);
 }
 
 bool UTF16ToUTF8(const std::u16string& utf16, std::string& outUtf8)
@@ -341,7 +662,10 @@ std::vector<char16_t> getChar16VectorFromUTF16String(const std::u16string& utf16
 
 long getCharacterCountInUTF8String(const std::string& utf8)
 {
-    return getUTF8StringLength((const UTF8*)utf8.c_str());
+    // Counts up to the first null character and returns 0 for illegal strings, as getUTF8StringLength() did
+    long count = countUTF8CodeUnits(reinterpret_cast<const unsigned char*>(utf8.c_str()), strlen(utf8.c_str()), 1);
+
+    return count < 0 ? 0 : count;
 }
 
 
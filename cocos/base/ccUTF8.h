@@ -93,6 +93,24 @@ CC_DLL bool UTF8ToUTF16(const std::string& inUtf8, std::u16string& outUtf16);
  */
 CC_DLL bool UTF8ToUTF32(const std::string& inUtf8, std::u32string& outUtf32);
 
+/**
+ *  @brief Converts from UTF8 to UTF16 into a buffer owned by the caller, without allocating.
+ *
+ *  @param inUtf8 The source UTF8 characters, which do not need to be null terminated.
+ *  @param length The number of bytes in \p inUtf8.
+ *  @param outUtf16 The buffer to write the UTF16 code units to. It is not null terminated.
+ *  @param outCapacity The number of code units \p outUtf16 can hold. \p length code units are always enough.
+ *  @return The number of code units written, or -1 if \p inUtf8 is not valid UTF8 or does not fit, in which case nothing is written.
+ */
+CC_DLL long UTF8ToUTF16(const char* inUtf8, std::size_t length, char16_t* outUtf16, std::size_t outCapacity);
+
+/**
+ *  @brief Same as the buffer variant of \a UTF8ToUTF16 but converts form UTF8 to UTF32.
+ *
+ *  @see UTF8ToUTF16
+ */
+CC_DLL long UTF8ToUTF32(const char* inUtf8, std::size_t length, char32_t* outUtf32, std::size_t outCapacity);
+
 /**
  *  @brief Same as \a UTF8ToUTF16 but converts form UTF16 to UTF8.
  *
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
+#include "base/CCFlatValue.h"
 #include "platform/CCSAXParser.h"
 //#include "base/ccUtils.h"
 
@@ -304,12 +305,11 @@ public:
         }
 
         SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string text = std::string((char*)ch,len);
 
         switch(_state)
         {
         case SAX_KEY:
-            _curKey = text;
+            _curKey.assign(ch, len);
             break;
         case SAX_INT:
         case SAX_REAL:
@@ -320,7 +320,7 @@ public:
                     CCASSERT(!_curKey.empty(), "key not found : <integer/real>");
                 }
 
-                _curValue.append(text);
+                _curValue.append(ch, len);
             }
             break;
         default:
@@ -540,6 +540,20 @@ bool FileUtils::writeToFile(const ValueMap& /*dict*/, const std::string &/*fullP
 
 #endif /* (CC_TARGET_PLATFORM != CC_PLATFORM_MAC) */
 
+namespace
+{
+    // Lets cereal read straight out of a caller owned buffer instead of a std::string copy of it
+    class MemoryInputBuffer : public std::streambuf
+    {
+    public:
+        MemoryInputBuffer(const char* data, size_t size)
+        {
+            char* begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+}
+
 bool FileUtils::serializeValueMapToFile(const ValueMap& dict, const std::string& fullPath)
 {
 	std::ofstream outputStream(fullPath, std::ios::binary);
@@ -559,8 +573,22 @@ bool FileUtils::serializeValueMapToStream(const ValueMap& dict, std::ostream& ou
 	return true;
 }
 
+bool FileUtils::serializeValueMapToFlatFile(const ValueMap& dict, const std::string& fullPath)
+{
+	Data data = FlatValueDocument::serialize(dict);
+
+	return writeDataToFile(data, fullPath);
+}
+
 ValueMap FileUtils::deserializeValueMapFromFile(const std::string& fullPath)
 {
+	FlatValueDocument document;
+
+	if (document.initWithFile(fullPath))
+	{
+		return document.materializeValueMap();
+	}
+
 	std::ifstream inputStream(fullPath, std::ios::binary);
 	cereal::BinaryInputArchive iarchive(inputStream);
 	ValueMap valueMap;
@@ -571,7 +599,15 @@ ValueMap FileUtils::deserializeValueMapFromFile(const std::string& fullPath)
 
 ValueMap FileUtils::deserializeValueMapFromData(const char* filedata, int filesize)
 {
-	std::istringstream inputStream(std::string(filedata, filesize));
+	FlatValueView root = FlatValueDocument::getRootOfData((const unsigned char*)filedata, filesize);
+
+	if (root.getType() == Value::Type::MAP)
+	{
+		return std::move(root.materialize().asValueMap());
+	}
+
+	MemoryInputBuffer buffer(filedata, (size_t)filesize);
+	std::istream inputStream(&buffer);
 	cereal::BinaryInputArchive iarchive(inputStream);
 	ValueMap valueMap;
 	iarchive(valueMap);
@@ -579,6 +615,20 @@ ValueMap FileUtils::deserializeValueMapFromData(const char* filedata, int filesi
 	return valueMap;
 }
 
+bool FileUtils::convertSerializedValueMapToFlatFile(const std::string& sourcePath, const std::string& destinationPath)
+{
+	Data data = getDataFromFile(sourcePath);
+
+	if (data.isNull())
+	{
+		return false;
+	}
+
+	ValueMap valueMap = deserializeValueMapFromData((const char*)data.getBytes(), (int)data.getSize());
+
+	return serializeValueMapToFlatFile(valueMap, destinationPath);
+}
+
 // Implement FileUtils
 FileUtils* FileUtils::s_sharedFileUtils = nullptr;
 
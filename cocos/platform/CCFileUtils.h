@@ -484,6 +484,7 @@ public:
 
 	/**
 	*  Converts the contents of a file to a ValueMap.
+	*  Both the cereal and the flat binary formats are accepted.
 	*  @param filename The filename of the file to gets content.
 	*  @return ValueMap of the file contents.
 	*/
@@ -491,11 +492,20 @@ public:
 
 	/**
 	*  Converts the contents of a data array to a ValueMap.
+	*  Both the cereal and the flat binary formats are accepted.
 	*  @param filename The filename of the file to gets content.
 	*  @return ValueMap of the file contents.
 	*/
 	ValueMap deserializeValueMapFromData(const char* filedata, int filesize);
 
+	/**
+	*  Converts a file written by serializeValueMapToFile() or serializeValueMapToFlatFile() to the flat binary format.
+	*  @param sourcePath The full path of the file to convert.
+	*  @param destinationPath The full path of the flat binary file to write. May be the same as the source path.
+	*  @return True if the conversion succeeded.
+	*/
+	bool convertSerializedValueMapToFlatFile(const std::string& sourcePath, const std::string& destinationPath);
+
 
     /** Converts the contents of a file to a ValueMap.
      *  This method is used internally.
@@ -589,6 +599,16 @@ public:
 	*/
 	bool serializeValueMapToStream(const ValueMap& dict, std::ostream& stream);
 
+	/**
+	* write ValueMap into a flat binary file, which can be queried in place through FlatValueDocument
+	* or read back with deserializeValueMapFromFile()
+	*
+	*@param dict the ValueMap want to save
+	*@param fullPath The full path to the file you want to save a string
+	*@return bool
+	*/
+	bool serializeValueMapToFlatFile(const ValueMap& dict, const std::string& fullPath);
+
     /**
     * Write a ValueMap into a file, done async off the main cocos thread.
     *
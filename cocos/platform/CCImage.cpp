@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 
 #include <string>
+#include <vector>
 #include <ctype.h>
 
 #include "base/ccConfig.h"
@@ -424,6 +425,86 @@ bool Image::initWithRawData(const unsigned char * data, ssize_t /*dataLen*/, int
     return ret;
 }
 
+bool Image::saveToFile(const std::string& filename, bool isToRGB)
+{
+    if (isCompressed() || _renderFormat != Texture2D::PixelFormat::RGBA8888 || _data == nullptr)
+    {
+        CCLOG("cocos2d: Image: saveToFile is only supported for uncompressed RGBA8888 data");
+        return false;
+    }
+
+    std::string fileExtension = FileUtils::getInstance()->getFileExtension(filename);
+
+    if (fileExtension == ".png")
+    {
+        return saveImageToPNG(filename, isToRGB);
+    }
+
+    CCLOG("cocos2d: Image: saveToFile is only supported for png files, not %s", filename.c_str());
+    return false;
+}
+
+bool Image::saveImageToPNG(const std::string& filePath, bool isToRGB)
+{
+    bool ret = false;
+    FILE* fp = nullptr;
+    png_structp png_ptr = nullptr;
+    png_infop info_ptr = nullptr;
+    std::vector<png_bytep> rowPointers;
+
+    do
+    {
+        fp = fopen(FileUtils::getInstance()->getSuitableFOpen(filePath).c_str(), "wb");
+        CC_BREAK_IF(nullptr == fp);
+
+        png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        CC_BREAK_IF(nullptr == png_ptr);
+
+        info_ptr = png_create_info_struct(png_ptr);
+        CC_BREAK_IF(nullptr == info_ptr);
+
+        if (setjmp(png_jmpbuf(png_ptr)))
+        {
+            break;
+        }
+
+        png_init_io(png_ptr, fp);
+        png_set_IHDR(png_ptr, info_ptr, _width, _height, 8, isToRGB ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA,
+            PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+        png_write_info(png_ptr, info_ptr);
+
+        // The alpha byte of each RGBA pixel is stripped while writing, so no RGB copy of the data is needed
+        if (isToRGB)
+        {
+            png_set_filler(png_ptr, 0, PNG_FILLER_AFTER);
+        }
+
+        rowPointers.resize(_height);
+
+        for (int i = 0; i < _height; i++)
+        {
+            rowPointers[i] = (png_bytep)_data + i * _width * 4;
+        }
+
+        png_write_image(png_ptr, rowPointers.data());
+        png_write_end(png_ptr, info_ptr);
+
+        ret = true;
+    } while (0);
+
+    if (png_ptr != nullptr)
+    {
+        png_destroy_write_struct(&png_ptr, info_ptr != nullptr ? &info_ptr : nullptr);
+    }
+
+    if (fp != nullptr)
+    {
+        fclose(fp);
+    }
+
+    return ret;
+}
+
 void Image::premultipliedAlpha()
 {
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
@@ -108,6 +108,15 @@ public:
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
+    /**
+    @brief Save Image data to the specified file, with specified format. Only PNG files are supported.
+    This only touches the image data and the file, so it can be called from a worker thread.
+    @param filename the file's absolute path, including file suffix.
+    @param isToRGB whether the image is saved as RGB without alpha channel.
+    @return true if the file was written.
+    */
+    bool saveToFile(const std::string &filename, bool isToRGB = true);
+
     // Getters
     unsigned char *   getData()               { return _data; }
     ssize_t           getDataLen()            { return _dataLen; }
@@ -127,6 +136,7 @@ public:
 
 protected:
     bool initWithPngData(const unsigned char * data, ssize_t dataLen);
+    bool saveImageToPNG(const std::string& filePath, bool isToRGB = true);
     
     void premultipliedAlpha();
     
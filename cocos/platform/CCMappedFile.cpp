@@ -0,0 +1,204 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCMappedFile.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include "platform/win32/CCUtils-win32.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+NS_CC_BEGIN
+
+MappedFile::MappedFile()
+: _bytes(nullptr)
+, _size(0)
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+, _fileHandle(nullptr)
+, _mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+: MappedFile()
+{
+    move(other);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile& MappedFile::operator= (MappedFile&& other)
+{
+    if (this != &other)
+    {
+        close();
+        move(other);
+    }
+
+    return *this;
+}
+
+void MappedFile::move(MappedFile& other)
+{
+    _bytes = other._bytes;
+    _size = other._size;
+    other._bytes = nullptr;
+    other._size = 0;
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    _fileHandle = other._fileHandle;
+    _mappingHandle = other._mappingHandle;
+    other._fileHandle = nullptr;
+    other._mappingHandle = nullptr;
+#endif
+}
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+
+bool MappedFile::open(const std::string& fullPath)
+{
+    close();
+
+    HANDLE fileHandle = ::CreateFileW(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if (!::GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+    {
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = ::CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mappingHandle == nullptr)
+    {
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    void* view = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if (view == nullptr)
+    {
+        ::CloseHandle(mappingHandle);
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    _fileHandle = fileHandle;
+    _mappingHandle = mappingHandle;
+    _bytes = static_cast<const unsigned char*>(view);
+    _size = static_cast<ssize_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_bytes != nullptr)
+    {
+        ::UnmapViewOfFile(_bytes);
+    }
+
+    if (_mappingHandle != nullptr)
+    {
+        ::CloseHandle(_mappingHandle);
+    }
+
+    if (_fileHandle != nullptr)
+    {
+        ::CloseHandle(_fileHandle);
+    }
+
+    _bytes = nullptr;
+    _size = 0;
+    _fileHandle = nullptr;
+    _mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& fullPath)
+{
+    close();
+
+    int fd = ::open(fullPath.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = ::mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping holds its own reference to the file
+    ::close(fd);
+
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    _bytes = static_cast<const unsigned char*>(view);
+    _size = static_cast<ssize_t>(info.st_size);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_bytes != nullptr)
+    {
+        ::munmap(const_cast<unsigned char*>(_bytes), (size_t)_size);
+    }
+
+    _bytes = nullptr;
+    _size = 0;
+}
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+
+NS_CC_END
@@ -0,0 +1,93 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_MAPPED_FILE_H__
+#define __CC_MAPPED_FILE_H__
+
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCStdC.h"
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ * A read-only view of a file on disk, backed by the OS page cache.
+ * The mapping stays valid for the lifetime of the object; the object can be moved but not copied.
+ * If the platform cannot map the file, open() fails and callers are expected to fall back to FileUtils::getDataFromFile().
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL MappedFile
+{
+public:
+    MappedFile();
+    MappedFile(MappedFile&& other);
+    ~MappedFile();
+
+    MappedFile& operator= (MappedFile&& other);
+
+    /**
+     * Maps the file at the given full path.
+     * @param fullPath The absolute path of the file.
+     * @return True if the file was mapped, false if it does not exist, is empty or cannot be mapped.
+     */
+    bool open(const std::string& fullPath);
+
+    /** Unmaps the file, if any. */
+    void close();
+
+    /** Gets the start of the mapped bytes, or nullptr if nothing is mapped. */
+    const unsigned char* getBytes() const { return _bytes; }
+
+    /** Gets the size of the mapping in bytes. */
+    ssize_t getSize() const { return _size; }
+
+    /** Checks whether a file is currently mapped. */
+    bool isNull() const { return _bytes == nullptr; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    void move(MappedFile& other);
+
+    const unsigned char* _bytes;
+    ssize_t _size;
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    void* _fileHandle;
+    void* _mappingHandle;
+#endif
+};
+
+NS_CC_END
+
+/** @} */
+
+#endif // __CC_MAPPED_FILE_H__
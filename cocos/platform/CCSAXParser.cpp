@@ -25,68 +25,508 @@
 
 #include "platform/CCSAXParser.h"
 
-#include <vector> // because its based on windows 8 build :P
+#include <string.h>
+#include <vector>
 
 #include "base/CCConsole.h"
 #include "platform/CCFileUtils.h"
 
-#include <tinyxml2.h>
-
 NS_CC_BEGIN
 
-class XmlSaxHander : public tinyxml2::XMLVisitor
+namespace
 {
-public:
-    XmlSaxHander():_ccsaxParserImp(0){};
-    
-    virtual bool VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute );
-    virtual bool VisitExit( const tinyxml2::XMLElement& element );
-    virtual bool Visit( const tinyxml2::XMLText& text );
-    virtual bool Visit( const tinyxml2::XMLUnknown&){ return true; }
-
-    void setSAXParserImp(SAXParser* parser)
+    /*
+     * Single pass, non-validating XML tokenizer that reports straight to the SAXParser callbacks, without building a DOM.
+     * Text is reported as a slice of the input unless it contains entities or carriage returns. Element names and attributes
+     * need null termination, so they are copied into scratch buffers that are reused for the whole document. The extra memory
+     * is bounded by the nesting depth and the largest tag rather than by the size of the document.
+     *
+     * Whitespace only text between tags is dropped and CDATA sections are reported as text, which matches what the previous
+     * tinyxml2 based implementation reported. Comments, processing instructions and DOCTYPE declarations are skipped.
+     */
+    class XmlTokenizer
     {
-        _ccsaxParserImp = parser;
-    }
+    public:
+        XmlTokenizer(SAXParser* parser, const char* data, size_t length)
+        : _parser(parser)
+        , _begin(data)
+        , _cursor(data)
+        , _end(data + length)
+        {
+        }
 
-private:
-    SAXParser *_ccsaxParserImp;
-};
+        bool parse()
+        {
+            // Skip the UTF-8 byte order mark
+            if (_end - _cursor >= 3 && (unsigned char)_cursor[0] == 0xEF && (unsigned char)_cursor[1] == 0xBB && (unsigned char)_cursor[2] == 0xBF)
+            {
+                _cursor += 3;
+            }
 
+            while (_cursor < _end)
+            {
+                bool success = true;
 
-bool XmlSaxHander::VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute )
-{
-    //log(" VisitEnter %s",element.Value());
+                if (*_cursor != '<')
+                {
+                    success = parseText();
+                }
+                else if (startsWith("<!--"))
+                {
+                    success = skipPast("-->");
+                }
+                else if (startsWith("<![CDATA["))
+                {
+                    success = parseCData();
+                }
+                else if (startsWith("<?"))
+                {
+                    success = skipPast("?>");
+                }
+                else if (startsWith("<!"))
+                {
+                    success = skipDeclaration();
+                }
+                else if (startsWith("</"))
+                {
+                    success = parseEndElement();
+                }
+                else
+                {
+                    success = parseStartElement();
+                }
 
-    std::vector<const char*> attsVector;
-    for( const tinyxml2::XMLAttribute* attrib = firstAttribute; attrib; attrib = attrib->Next() )
-    {
-        //log("%s", attrib->Name());
-        attsVector.push_back(attrib->Name());
-        //log("%s",attrib->Value());
-        attsVector.push_back(attrib->Value());
-    }
-    
-    // nullptr is used in c++11
-    //attsVector.push_back(nullptr);
-    attsVector.push_back(nullptr);
+                if (!success)
+                {
+                    CCLOG("SAXParser: malformed XML at offset %d", (int)(_cursor - _begin));
+                    return false;
+                }
+            }
 
-    SAXParser::startElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value(), (const CC_XML_CHAR **)(&attsVector[0]));
-    return true;
-}
-bool XmlSaxHander::VisitExit( const tinyxml2::XMLElement& element )
-{
-    //log("VisitExit %s",element.Value());
+            if (!_nameOffsets.empty())
+            {
+                CCLOG("SAXParser: unexpected end of document, <%s> is not closed", &_nameStack[_nameOffsets.back()]);
+                return false;
+            }
 
-    SAXParser::endElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value());
-    return true;
-}
+            return true;
+        }
 
-bool XmlSaxHander::Visit( const tinyxml2::XMLText& text )
-{
-    //log("Visit %s",text.Value());
-    SAXParser::textHandler(_ccsaxParserImp, (const CC_XML_CHAR *)text.Value(), strlen(text.Value()));
-    return true;
+    private:
+        static bool isWhitespace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        static bool isNameEnd(char c)
+        {
+            return isWhitespace(c) || c == '>' || c == '/' || c == '=';
+        }
+
+        bool startsWith(const char* prefix) const
+        {
+            size_t length = strlen(prefix);
+            return (size_t)(_end - _cursor) >= length && memcmp(_cursor, prefix, length) == 0;
+        }
+
+        void skipWhitespace()
+        {
+            while (_cursor < _end && isWhitespace(*_cursor))
+            {
+                _cursor++;
+            }
+        }
+
+        const char* find(const char* token) const
+        {
+            size_t length = strlen(token);
+
+            for (const char* it = _cursor; (size_t)(_end - it) >= length; it++)
+            {
+                if (*it == token[0] && memcmp(it, token, length) == 0)
+                {
+                    return it;
+                }
+            }
+
+            return nullptr;
+        }
+
+        bool skipPast(const char* token)
+        {
+            const char* found = find(token);
+
+            if (found == nullptr)
+            {
+                return false;
+            }
+
+            _cursor = found + strlen(token);
+            return true;
+        }
+
+        bool skipDeclaration()
+        {
+            // <!DOCTYPE ...> may contain an internal subset in brackets, which can itself contain '>'
+            int bracketDepth = 0;
+
+            for (_cursor += 2; _cursor < _end; _cursor++)
+            {
+                if (*_cursor == '[')
+                {
+                    bracketDepth++;
+                }
+                else if (*_cursor == ']')
+                {
+                    bracketDepth--;
+                }
+                else if (*_cursor == '>' && bracketDepth <= 0)
+                {
+                    _cursor++;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool parseCData()
+        {
+            _cursor += 9;
+            const char* found = find("]]>");
+
+            if (found == nullptr)
+            {
+                return false;
+            }
+
+            if (found > _cursor)
+            {
+                SAXParser::textHandler(_parser, (const CC_XML_CHAR*)_cursor, found - _cursor);
+            }
+
+            _cursor = found + 3;
+            return true;
+        }
+
+        bool parseText()
+        {
+            const char* start = _cursor;
+            bool needsDecoding = false;
+            bool whitespaceOnly = true;
+
+            while (_cursor < _end && *_cursor != '<')
+            {
+                char c = *_cursor++;
+
+                if (c == '&' || c == '\r')
+                {
+                    needsDecoding = true;
+                }
+
+                if (!isWhitespace(c))
+                {
+                    whitespaceOnly = false;
+                }
+            }
+
+            if (whitespaceOnly)
+            {
+                return true;
+            }
+
+            if (!needsDecoding)
+            {
+                SAXParser::textHandler(_parser, (const CC_XML_CHAR*)start, _cursor - start);
+                return true;
+            }
+
+            _textScratch.clear();
+            decode(start, _cursor, _textScratch);
+            SAXParser::textHandler(_parser, (const CC_XML_CHAR*)_textScratch.data(), _textScratch.size());
+
+            return true;
+        }
+
+        bool parseStartElement()
+        {
+            _cursor++;
+
+            const char* nameStart = _cursor;
+
+            while (_cursor < _end && !isNameEnd(*_cursor))
+            {
+                _cursor++;
+            }
+
+            if (_cursor == nameStart || _cursor >= _end)
+            {
+                return false;
+            }
+
+            size_t nameOffset = _nameStack.size();
+            _nameStack.append(nameStart, _cursor - nameStart);
+            _nameStack.push_back('\0');
+            _nameOffsets.push_back(nameOffset);
+
+            // Attributes are laid out as name\0value\0 pairs, the pointers are fixed up once the scratch buffer stops growing
+            _tagScratch.clear();
+            _attributeOffsets.clear();
+
+            while (true)
+            {
+                skipWhitespace();
+
+                if (_cursor >= _end)
+                {
+                    return false;
+                }
+
+                if (*_cursor == '>' || *_cursor == '/')
+                {
+                    break;
+                }
+
+                const char* attributeStart = _cursor;
+
+                while (_cursor < _end && !isNameEnd(*_cursor))
+                {
+                    _cursor++;
+                }
+
+                if (_cursor == attributeStart)
+                {
+                    return false;
+                }
+
+                _attributeOffsets.push_back(_tagScratch.size());
+                _tagScratch.append(attributeStart, _cursor - attributeStart);
+                _tagScratch.push_back('\0');
+
+                skipWhitespace();
+
+                if (_cursor >= _end || *_cursor != '=')
+                {
+                    return false;
+                }
+
+                _cursor++;
+                skipWhitespace();
+
+                if (_cursor >= _end || (*_cursor != '"' && *_cursor != '\''))
+                {
+                    return false;
+                }
+
+                char quote = *_cursor++;
+                const char* valueStart = _cursor;
+                const char* valueEnd = (const char*)memchr(_cursor, quote, _end - _cursor);
+
+                if (valueEnd == nullptr)
+                {
+                    return false;
+                }
+
+                _attributeOffsets.push_back(_tagScratch.size());
+                decode(valueStart, valueEnd, _tagScratch);
+                _tagScratch.push_back('\0');
+                _cursor = valueEnd + 1;
+            }
+
+            bool selfClosing = (*_cursor == '/');
+
+            if (selfClosing)
+            {
+                _cursor++;
+
+                if (_cursor >= _end || *_cursor != '>')
+                {
+                    return false;
+                }
+            }
+
+            _cursor++;
+
+            _attributes.clear();
+
+            for (size_t offset : _attributeOffsets)
+            {
+                _attributes.push_back(&_tagScratch[offset]);
+            }
+
+            _attributes.push_back(nullptr);
+
+            SAXParser::startElement(_parser, (const CC_XML_CHAR*)&_nameStack[nameOffset], (const CC_XML_CHAR**)_attributes.data());
+
+            if (selfClosing)
+            {
+                popElement();
+            }
+
+            return true;
+        }
+
+        bool parseEndElement()
+        {
+            _cursor += 2;
+
+            const char* nameStart = _cursor;
+
+            while (_cursor < _end && !isNameEnd(*_cursor))
+            {
+                _cursor++;
+            }
+
+            size_t nameLength = _cursor - nameStart;
+
+            skipWhitespace();
+
+            if (_cursor >= _end || *_cursor != '>' || _nameOffsets.empty())
+            {
+                return false;
+            }
+
+            const char* openName = &_nameStack[_nameOffsets.back()];
+
+            if (strlen(openName) != nameLength || memcmp(openName, nameStart, nameLength) != 0)
+            {
+                CCLOG("SAXParser: </%.*s> does not match <%s>", (int)nameLength, nameStart, openName);
+                return false;
+            }
+
+            _cursor++;
+            popElement();
+
+            return true;
+        }
+
+        void popElement()
+        {
+            size_t nameOffset = _nameOffsets.back();
+
+            SAXParser::endElement(_parser, (const CC_XML_CHAR*)&_nameStack[nameOffset]);
+
+            _nameOffsets.pop_back();
+            _nameStack.resize(nameOffset);
+        }
+
+        static void appendUTF8(unsigned long codePoint, std::string& output)
+        {
+            if (codePoint < 0x80)
+            {
+                output.push_back((char)codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                output.push_back((char)(0xC0 | (codePoint >> 6)));
+                output.push_back((char)(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                output.push_back((char)(0xE0 | (codePoint >> 12)));
+                output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.push_back((char)(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x110000)
+            {
+                output.push_back((char)(0xF0 | (codePoint >> 18)));
+                output.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+                output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.push_back((char)(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        // Appends [start, end) to the output, resolving entities and normalizing line endings to '\n'
+        static void decode(const char* start, const char* end, std::string& output)
+        {
+            static const struct { const char* name; size_t length; char value; } entities[] =
+            {
+                { "&amp;", 5, '&' },
+                { "&lt;", 4, '<' },
+                { "&gt;", 4, '>' },
+                { "&quot;", 6, '"' },
+                { "&apos;", 6, '\'' },
+            };
+
+            const char* it = start;
+
+            while (it < end)
+            {
+                const char* special = it;
+
+                while (special < end && *special != '&' && *special != '\r')
+                {
+                    special++;
+                }
+
+                output.append(it, special - it);
+                it = special;
+
+                if (it >= end)
+                {
+                    break;
+                }
+
+                if (*it == '\r')
+                {
+                    output.push_back('\n');
+                    it += (it + 1 < end && it[1] == '\n') ? 2 : 1;
+                    continue;
+                }
+
+                const char* semicolon = (const char*)memchr(it, ';', end - it);
+                bool resolved = false;
+
+                if (semicolon != nullptr && it + 1 < semicolon && it[1] == '#')
+                {
+                    bool hex = (it + 2 < semicolon && (it[2] == 'x' || it[2] == 'X'));
+                    unsigned long codePoint = strtoul(it + (hex ? 3 : 2), nullptr, hex ? 16 : 10);
+
+                    if (codePoint != 0)
+                    {
+                        appendUTF8(codePoint, output);
+                        it = semicolon + 1;
+                        resolved = true;
+                    }
+                }
+                else if (semicolon != nullptr)
+                {
+                    size_t length = semicolon + 1 - it;
+
+                    for (const auto& entity : entities)
+                    {
+                        if (entity.length == length && memcmp(it, entity.name, length) == 0)
+                        {
+                            output.push_back(entity.value);
+                            it = semicolon + 1;
+                            resolved = true;
+                            break;
+                        }
+                    }
+                }
+
+                // Unknown entities are kept verbatim
+                if (!resolved)
+                {
+                    output.push_back(*it++);
+                }
+            }
+        }
+
+        SAXParser* _parser;
+        const char* _begin;
+        const char* _cursor;
+        const char* _end;
+
+        std::string _nameStack;
+        std::vector<size_t> _nameOffsets;
+
+        std::string _tagScratch;
+        std::vector<size_t> _attributeOffsets;
+        std::vector<const char*> _attributes;
+
+        std::string _textScratch;
+    };
 }
 
 SAXParser::SAXParser()
@@ -106,12 +546,9 @@ bool SAXParser::init(const char* /*encoding*/)
 
 bool SAXParser::parse(const char* xmlData, size_t dataLength)
 {
-    tinyxml2::XMLDocument tinyDoc;
-    tinyDoc.Parse(xmlData, dataLength);
-    XmlSaxHander printer;
-    printer.setSAXParserImp(this);
-    
-    return tinyDoc.Accept( &printer );  
+    XmlTokenizer tokenizer(this, xmlData, dataLength);
+
+    return tokenizer.parse();
 }
 
 bool SAXParser::parse(const std::string& filename)
@@ -83,6 +83,7 @@
 
 // 2d nodes
 #include "2d/CCAtlasNode.h"
+#include "2d/CCCachedNode.h"
 #include "2d/CCClippingNode.h"
 #include "2d/CCDrawNode.h"
 #include "2d/CCLabel.h"
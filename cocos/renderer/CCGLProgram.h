@@ -206,6 +206,8 @@ public:
     static const char* SHADER_NAME_POSITION_U_COLOR;
     /**Built in shader for draw a sector with 90 degrees with center at bottom left point.*/
     static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR;
+    /**Built in shader for batched DrawNode geometry. Same as SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, but without MVP and with premultiplied vertex colors instead of u_alpha.*/
+    static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP;
 
     /**Built in shader for ui effects */
     static const char* SHADER_NAME_POSITION_GRAYSCALE;
@@ -271,6 +273,11 @@ public:
      Built in shader for LayerRadialGradient
      */
     static const char* SHADER_LAYER_RADIAL_GRADIENT;
+
+    /**
+     Built in shader for instanced particle quads, see ParticleSystemQuad::setInstancedRenderingEnabled()
+     */
+    static const char* SHADER_PARTICLE_INSTANCED;
     
     /**
      Built in shader for camera clear
@@ -52,6 +52,7 @@ enum
     kShaderType_PositionTextureA8Color,
     kShaderType_Position_uColor,
     kShaderType_PositionLengthTextureColor,
+    kShaderType_PositionLengthTextureColor_noMVP,
     kShaderType_LabelDistanceFieldNormal,
     kShaderType_LabelDistanceFieldGlow,
     kShaderType_UIGrayScale,
@@ -77,6 +78,7 @@ enum
     kShaderType_ETC1ASPositionTextureGray,
     kShaderType_ETC1ASPositionTextureGray_noMVP,
     kShaderType_LayerRadialGradient,
+    kShaderType_ParticleInstanced,
     kShaderType_MAX,
 };
 
@@ -198,6 +200,10 @@ void GLProgramCache::loadDefaultGLPrograms()
     loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor);
     _programs.emplace(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, p);
 
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor_noMVP);
+    _programs.emplace(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP, p);
+
     p = new (std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
     _programs.emplace(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL, p);
@@ -291,6 +297,10 @@ void GLProgramCache::loadDefaultGLPrograms()
     p = new(std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_LayerRadialGradient);
     _programs.emplace(GLProgram::SHADER_LAYER_RADIAL_GRADIENT, p);
+
+    p = new(std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_ParticleInstanced);
+    _programs.emplace(GLProgram::SHADER_PARTICLE_INSTANCED, p);
 }
 
 void GLProgramCache::reloadDefaultGLPrograms()
@@ -369,6 +379,10 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p->reset();
     loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor);
 
+    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor_noMVP);
+
     p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL);
     p->reset();
     loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
@@ -462,6 +476,10 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p = getGLProgram(GLProgram::SHADER_LAYER_RADIAL_GRADIENT);
     loadDefaultGLProgram(p, kShaderType_LayerRadialGradient);
     _programs.emplace(GLProgram::SHADER_LAYER_RADIAL_GRADIENT, p);
+
+    p = getGLProgram(GLProgram::SHADER_PARTICLE_INSTANCED);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_ParticleInstanced);
 }
 
 void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
@@ -528,6 +546,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_PositionLengthTextureColor:
             p->initWithByteArrays(ccPositionColorLengthTexture_vert, ccPositionColorLengthTexture_frag);
             break;
+        case kShaderType_PositionLengthTextureColor_noMVP:
+            p->initWithByteArrays(ccPositionColorLengthTexture_noMVP_vert, ccPositionColorLengthTexture_frag);
+            break;
         case kShaderType_LabelDistanceFieldNormal:
             p->initWithByteArrays(ccLabel_vert, ccLabelDistanceFieldNormal_frag);
             break;
@@ -564,6 +585,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_LayerRadialGradient:
             p->initWithByteArrays(ccPosition_vert, ccShader_LayerRadialGradient_frag);
             break;
+        case kShaderType_ParticleInstanced:
+            p->initWithByteArrays(ccPositionTextureColor_particleInstanced_vert, ccPositionTextureColor_frag);
+            break;
         default:
             CCLOG("cocos2d: %s:%d, error shader type", __FUNCTION__, __LINE__);
             return;
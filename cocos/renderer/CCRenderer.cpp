@@ -173,13 +173,14 @@ void RenderQueue::restoreRenderState()
 //
 // constructors, destructor, init
 //
-Renderer::Renderer() : _filledVertex(0)
+Renderer::Renderer() : _offscreenVisitDepth(0)
+,_triBatchesToDrawCapacity(-1)
+,_triBatchesToDraw(nullptr)
+,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
-,_triBatchesToDraw(nullptr)
-,_triBatchesToDrawCapacity(-1)
 {
     _groupCommandManager = new (std::nothrow) GroupCommandManager();
     
@@ -650,6 +651,11 @@ void Renderer::flush()
 // helpers
 bool Renderer::checkVisibility(const Mat4 &transform, const CSize &size)
 {
+    if (_offscreenVisitDepth > 0)
+    {
+        return true;
+    }
+
     auto director = Director::getInstance();
     auto scene = director->getRunningScene();
     
@@ -684,6 +690,57 @@ bool Renderer::checkVisibility(const Mat4 &transform, const CSize &size)
 }
 
 
+void Renderer::pushScissorRect(const CRect& rect)
+{
+    CRect scissor = rect;
+
+    if (_scissorStack.empty())
+    {
+        glEnable(GL_SCISSOR_TEST);
+    }
+    else
+    {
+        const CRect& parent = _scissorStack.back();
+        float minX = std::max(scissor.getMinX(), parent.getMinX());
+        float minY = std::max(scissor.getMinY(), parent.getMinY());
+        float maxX = std::min(scissor.getMaxX(), parent.getMaxX());
+        float maxY = std::min(scissor.getMaxY(), parent.getMaxY());
+
+        scissor = CRect(minX, minY, std::max(maxX - minX, 0.0f), std::max(maxY - minY, 0.0f));
+    }
+
+    _scissorStack.push_back(scissor);
+
+    // Rounding the edges keeps the pixels whose centers are inside the rect, like the stencil path would
+    GLint x = (GLint)lroundf(scissor.getMinX());
+    GLint y = (GLint)lroundf(scissor.getMinY());
+    glScissor(x, y, (GLsizei)(lroundf(scissor.getMaxX()) - x), (GLsizei)(lroundf(scissor.getMaxY()) - y));
+}
+
+void Renderer::popScissorRect()
+{
+    CCASSERT(!_scissorStack.empty(), "popScissorRect() without a matching pushScissorRect()");
+
+    if (_scissorStack.empty())
+    {
+        return;
+    }
+
+    _scissorStack.pop_back();
+
+    if (_scissorStack.empty())
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    else
+    {
+        const CRect& scissor = _scissorStack.back();
+        GLint x = (GLint)lroundf(scissor.getMinX());
+        GLint y = (GLint)lroundf(scissor.getMinY());
+        glScissor(x, y, (GLsizei)(lroundf(scissor.getMaxX()) - x), (GLsizei)(lroundf(scissor.getMaxY()) - y));
+    }
+}
+
 void Renderer::setClearColor(const Color4F &clearColor)
 {
     _clearColor = clearColor;
@@ -192,6 +192,22 @@ public:
     /** returns whether or not a rectangle is visible or not */
     bool checkVisibility(const Mat4& transform, const CSize& size);
 
+    /** Disables checkVisibility() while nodes are visited into an offscreen target whose coordinates do not match the screen.
+     * Only call this while visiting, and balance it with popOffscreenVisit().
+     */
+    void pushOffscreenVisit() { _offscreenVisitDepth++; }
+
+    /** Ends a pushOffscreenVisit(). */
+    void popOffscreenVisit() { _offscreenVisitDepth--; }
+
+    /** Intersects a scissor rect, in window pixels, with the current one and enables the scissor test.
+     * Only call this while rendering, from a command, and balance it with popScissorRect().
+     */
+    void pushScissorRect(const CRect& rect);
+
+    /** Restores the scissor rect that was current before the matching pushScissorRect(), disabling the scissor test once none is left. */
+    void popScissorRect();
+
 protected:
 
     //Setup VBO or VAO based on OpenGL extensions
@@ -217,6 +233,12 @@ protected:
 
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
 
+    // nested scissor rects in window pixels, each one already intersected with its parent
+    std::vector<CRect> _scissorStack;
+
+    // number of nested offscreen visits, culling is disabled while it is not zero
+    int _offscreenVisitDepth;
+
     //for TrianglesCommand
     V3F_C4B_T2F _verts[VBO_SIZE];
     GLushort _indices[INDEX_VBO_SIZE];
@@ -59,6 +59,8 @@ NS_CC_BEGIN
 #include "renderer/shaders/ccShader_PositionTextureColor_noMVP.frag"
 #include "renderer/shaders/ccShader_PositionTextureColor_noMVP.vert"
 
+#include "renderer/shaders/ccShader_PositionTextureColor_particleInstanced.vert"
+
 //
 #include "renderer/shaders/ccShader_PositionTextureColorAlphaTest.frag"
 
@@ -68,6 +70,7 @@ NS_CC_BEGIN
 
 #include "renderer/shaders/ccShader_PositionColorLengthTexture.frag"
 #include "renderer/shaders/ccShader_PositionColorLengthTexture.vert"
+#include "renderer/shaders/ccShader_PositionColorLengthTexture_noMVP.vert"
 
 #include "renderer/shaders/ccShader_UI_Gray.frag"
 //
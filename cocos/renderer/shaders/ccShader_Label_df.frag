@@ -8,6 +8,7 @@ varying vec4 v_fragmentColor;
 varying vec2 v_texCoord;
 
 uniform vec4 u_textColor;
+uniform float u_smoothing;
 
 void main()
 {
@@ -16,10 +17,8 @@ void main()
     //float dist = color.b+color.g/256.0;
     // the texture use single channel 8-bit output for distance_map
     float dist = color.a;
-    //TODO: Implementation 'fwidth' for glsl 1.0
-    //float width = fwidth(dist);
-    //assign width for constant will lead to a little bit fuzzy,it's temporary measure.
-    float width = 0.04;
+    // fwidth() is not available in glsl 1.0, so the label passes the edge width for its font scale
+    float width = u_smoothing;
     float alpha = smoothstep(0.5-width, 0.5+width, dist) * u_textColor.a;
     gl_FragColor = v_fragmentColor * vec4(u_textColor.rgb,alpha);
 }
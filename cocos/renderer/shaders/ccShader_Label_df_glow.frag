@@ -9,14 +9,13 @@ varying vec2 v_texCoord;
 
 uniform vec4 u_effectColor;
 uniform vec4 u_textColor;
+uniform float u_smoothing;
 
 void main()
 {
     float dist = texture2D(CC_Texture0, v_texCoord).a;
-    //TODO: Implementation 'fwidth' for glsl 1.0
-    //float width = fwidth(dist);
-    //assign width for constant will lead to a little bit fuzzy,it's temporary measure.
-    float width = 0.04;
+    // fwidth() is not available in glsl 1.0, so the label passes the edge width for its font scale
+    float width = u_smoothing;
     float alpha = smoothstep(0.5-width, 0.5+width, dist);
     //glow
     float mu = smoothstep(0.5, 1.0, sqrt(dist));
@@ -13,7 +13,7 @@ uniform vec4 u_effectColor;
 uniform vec4 u_textColor;
 
 #ifdef GL_ES
-uniform lowp int u_effectType; // 0: None (Draw text), 1: Outline, 2: Shadow
+uniform lowp int u_effectType; // 0: None (Draw text), 1: Outline and text, 2: Shadow
 #else
 uniform int u_effectType;
 #endif
@@ -35,10 +35,16 @@ void main()
     {
         gl_FragColor = v_fragmentColor * vec4(u_textColor.rgb, u_textColor.a * fontAlpha);
     }
-    else if (u_effectType == 1) // draw outline
+    else if (u_effectType == 1) // draw outline and text
     {
         // multipy (1.0 - fontAlpha) to make the inner edge of outline smoother and make the text itself transparent.
-        gl_FragColor = v_fragmentColor * vec4(u_effectColor.rgb, u_effectColor.a * outlineAlpha * (1.0 - fontAlpha));
+        vec4 outline = v_fragmentColor * vec4(u_effectColor.rgb, u_effectColor.a * outlineAlpha * (1.0 - fontAlpha));
+        vec4 text = v_fragmentColor * vec4(u_textColor.rgb, u_textColor.a * fontAlpha);
+
+        // composite the text over its outline, which is what blending a text pass over an outline pass produced
+        float alpha = text.a + outline.a * (1.0 - text.a);
+        vec3 color = (text.rgb * text.a + outline.rgb * outline.a * (1.0 - text.a)) / max(alpha, 0.0001);
+        gl_FragColor = vec4(color, alpha);
     }
     else // draw shadow
     {
@@ -0,0 +1,59 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+// Batched DrawNode geometry. Vertices arrive in world space and colors arrive premultiplied by the node opacity,
+// so nothing in here differs between nodes and the renderer can merge them into one draw call.
+const char* ccPositionColorLengthTexture_noMVP_vert = R"(
+
+#ifdef GL_ES
+precision lowp float;
+#endif
+
+#ifdef GL_ES
+attribute mediump vec4 a_position;
+attribute mediump vec2 a_texCoord;
+attribute mediump vec4 a_color;
+
+varying mediump vec4 v_color;
+varying mediump vec2 v_texcoord;
+
+#else
+
+attribute vec4 a_position;
+attribute vec2 a_texCoord;
+attribute vec4 a_color;
+
+varying vec4 v_color;
+varying vec2 v_texcoord;
+
+#endif
+
+void main()
+{
+    v_color = a_color;
+    v_texcoord = a_texCoord;
+
+    gl_Position = CC_PMatrix * a_position;
+}
+)";
@@ -0,0 +1,54 @@
+/****************************************************************************
+ Copyright (c) 2019 Squalr
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+// Expands one particle record into a quad. a_position is the quad corner in [-0.5, 0.5] and advances per vertex,
+// a_particle (x, y, size, rotation in degrees) and a_color advance once per particle.
+const char* ccPositionTextureColor_particleInstanced_vert = R"(
+attribute vec2 a_position;
+attribute vec4 a_particle;
+attribute vec4 a_color;
+
+uniform vec4 u_texRect;
+
+#ifdef GL_ES
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+#else
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+#endif
+
+void main()
+{
+    float r = -radians(a_particle.w);
+    float cr = cos(r);
+    float sr = sin(r);
+    vec2 corner = a_position * a_particle.z;
+    vec2 position = vec2(corner.x * cr - corner.y * sr, corner.x * sr + corner.y * cr) + a_particle.xy;
+
+    gl_Position = CC_MVPMatrix * vec4(position, 0.0, 1.0);
+    v_fragmentColor = a_color;
+    v_texCoord = mix(u_texRect.xy, u_texRect.zw, a_position + vec2(0.5, 0.5));
+}
+)";